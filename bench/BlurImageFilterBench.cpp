@@ -8,11 +8,14 @@
 #include "bench/Benchmark.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkShader.h"
 #include "include/core/SkString.h"
 #include "include/effects/SkImageFilters.h"
 #include "include/utils/SkRandom.h"
+#include "src/core/SkBlurEngine.h"
+#include "tools/ToolUtils.h"
 
 #define FILTER_WIDTH_SMALL  32
 #define FILTER_HEIGHT_SMALL 32
@@ -161,3 +164,93 @@ DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, tr
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, false, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, true, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, false, true, true);)
+
+// The raster blur behind both the image filter and the mask filter, on its own: how it scales
+// with sigma, with threads striping each pass, and with large sigmas blurred at reduced
+// resolution (maxError > 0). Each loop blurs a w x h image with a border big enough to hold all
+// of the blur.
+class BlurEngineBench : public Benchmark {
+public:
+    BlurEngineBench(int w, int h, SkColorType ct, SkScalar sigma, int threads,
+                    float maxError = 0)
+        : fW(w), fH(h), fColorType(ct), fSigma(sigma), fThreads(threads), fMaxError(maxError) {
+        fName.printf("blur_engine_%dx%d_%s_%.2f",
+                     w, h, ToolUtils::colortype_name(ct), SkScalarToFloat(sigma));
+        if (threads > 0) {
+            fName.appendf("_%d_threads", threads);
+        }
+        if (maxError > 0) {
+            fName.appendf("_downsampled_%g", maxError);
+        }
+    }
+
+protected:
+    bool isSuitableFor(Backend backend) override {
+        return kNonRendering_Backend == backend;
+    }
+
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        int border = SkBlurEngine::BorderForWindow(SkBlurEngine::WindowForSigma(fSigma));
+        fOffset = {border, border};
+
+        fSrc.allocPixels(SkImageInfo::Make(fW, fH, fColorType, kPremul_SkAlphaType));
+        // Noise, so the sums take every path through the arithmetic.
+        SkRandom rand;
+        for (int y = 0; y < fH; ++y) {
+            auto row = static_cast<uint8_t*>(fSrc.getAddr(0, y));
+            for (size_t i = 0; i < fSrc.info().minRowBytes(); ++i) {
+                row[i] = rand.nextULessThan(256);
+            }
+        }
+        fDst.allocPixels(fSrc.info().makeWH(fW + 2 * border, fH + 2 * border));
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            SkBlurEngine::GaussianBlur(fSrc.pixmap(), fOffset, fSigma, fSigma, fDst.pixmap(),
+                                       fExecutor.get(), fMaxError);
+        }
+    }
+
+private:
+    SkString fName;
+    const int fW, fH;
+    const SkColorType fColorType;
+    const SkScalar fSigma;
+    const int fThreads;
+    const float fMaxError;
+    SkIPoint fOffset;
+    SkBitmap fSrc, fDst;
+    std::unique_ptr<SkExecutor> fExecutor;
+    using INHERITED = Benchmark;
+};
+
+#define BLUR_ENGINE_BENCHES(sigma)                                                              \
+    DEF_BENCH(return new BlurEngineBench(1024, 1024, kN32_SkColorType,     sigma, 0);)          \
+    DEF_BENCH(return new BlurEngineBench(1024, 1024, kN32_SkColorType,     sigma, 4);)          \
+    DEF_BENCH(return new BlurEngineBench(1024, 1024, kAlpha_8_SkColorType, sigma, 0);)          \
+    DEF_BENCH(return new BlurEngineBench(1024, 1024, kAlpha_8_SkColorType, sigma, 4);)
+
+BLUR_ENGINE_BENCHES(BLUR_SIGMA_SMALL)
+BLUR_ENGINE_BENCHES(3.0f)
+BLUR_ENGINE_BENCHES(BLUR_SIGMA_LARGE)
+BLUR_ENGINE_BENCHES(30.0f)
+BLUR_ENGINE_BENCHES(BLUR_SIGMA_HUGE)
+
+// Full resolution against reduced resolution, with the default error budget, from small to
+// huge sigmas.
+#define BLUR_ENGINE_SIGMA_SWEEP(sigma)                                                          \
+    DEF_BENCH(return new BlurEngineBench(1024, 1024, kN32_SkColorType, sigma, 0);)              \
+    DEF_BENCH(return new BlurEngineBench(1024, 1024, kN32_SkColorType, sigma, 0, 2);)
+
+BLUR_ENGINE_SIGMA_SWEEP(2.0f)
+BLUR_ENGINE_SIGMA_SWEEP(5.0f)
+BLUR_ENGINE_SIGMA_SWEEP(20.0f)
+BLUR_ENGINE_SIGMA_SWEEP(50.0f)
+BLUR_ENGINE_SIGMA_SWEEP(100.0f)
+BLUR_ENGINE_SIGMA_SWEEP(200.0f)
@@ -13,6 +13,8 @@
 #include "src/utils/SkCharToGlyphCache.h"
 #include "src/utils/SkUTF.h"
 
+#include <string>
+
 enum {
     NGLYPHS = 100
 };
@@ -122,3 +124,61 @@ DEF_BENCH( return new CMAPBench(textToGlyphs_proc, "font_charToGlyph", BIG); )
 DEF_BENCH( return new CMAPBench(charsToGlyphs_proc, "face_charToGlyph", BIG); )
 DEF_BENCH( return new CMAPBench(addcache_proc, "addcache_charToGlyph", BIG); )
 DEF_BENCH( return new CMAPBench(findcache_proc, "findcache_charToGlyph", BIG); )
+
+//////////////////////////////////////////////////////////////////////////////
+
+// UTF-8 text to glyphs through SkFont, for a paragraph of text in a few scripts. Each loop converts
+// kUTF8Bytes bytes, so (kUTF8Bytes / time per loop) is the throughput.
+class UTF8ToGlyphsBench : public Benchmark {
+    static constexpr int kUTF8Bytes = 4096;
+
+    SkString    fName;
+    std::string fText;
+    SkFont      fFont;
+    SkAutoTArray<SkGlyphID> fGlyphs;
+
+public:
+    // Repeats sample, which is UTF-8, to fill kUTF8Bytes (rounded down to whole code points).
+    UTF8ToGlyphsBench(const char name[], const char sample[]) {
+        fName.printf("utf8_textToGlyphs_%s", name);
+        while (fText.size() + strlen(sample) <= kUTF8Bytes) {
+            fText += sample;
+        }
+        fGlyphs.reset(SkUTF::CountUTF8(fText.data(), fText.size()));
+        fFont.setTypeface(SkTypeface::MakeDefault());
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        const int count = SkUTF::CountUTF8(fText.data(), fText.size());
+        for (int i = 0; i < loops; ++i) {
+            fFont.textToGlyphs(fText.data(), fText.size(), SkTextEncoding::kUTF8,
+                               fGlyphs.get(), count);
+        }
+    }
+
+private:
+    using INHERITED = Benchmark;
+};
+
+DEF_BENCH( return new UTF8ToGlyphsBench("ascii",
+        "The quick brown fox jumps over the lazy dog. "); )
+DEF_BENCH( return new UTF8ToGlyphsBench("cyrillic",
+        "\xD0\xA1\xD1\x8A\xD0\xB5\xD1\x88\xD1\x8C \xD0\xB6\xD0\xB5 \xD0\xB5\xD1\x89"
+        "\xD1\x91 \xD1\x8D\xD1\x82\xD0\xB8\xD1\x85 \xD0\xBC\xD1\x8F\xD0\xB3\xD0\xBA"
+        "\xD0\xB8\xD1\x85 \xD0\xB1\xD1\x83\xD0\xBB\xD0\xBE\xD0\xBA. "); )
+DEF_BENCH( return new UTF8ToGlyphsBench("cjk",
+        "\xE6\x88\x91\xE8\x83\xBD\xE5\x90\x9E\xE4\xB8\x8B\xE7\x8E\xBB\xE7\x92\x83"
+        "\xE8\x80\x8C\xE4\xB8\x8D\xE4\xBC\xA4\xE8\xBA\xAB\xE4\xBD\x93\xE3\x80\x82"); )
+DEF_BENCH( return new UTF8ToGlyphsBench("mixed",
+        "Settings \xE2\x80\x94 \xD0\x9D\xD0\xB0\xD1\x81\xD1\x82\xD1\x80\xD0\xBE\xD0\xB9"
+        "\xD0\xBA\xD0\xB8 (\xE8\xAE\xBE\xE7\xBD\xAE) \xF0\x9F\x94\xA7 version 2.1.0, "
+        "build 20210412; "); )
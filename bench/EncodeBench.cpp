@@ -7,6 +7,7 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
@@ -85,6 +86,14 @@ static bool encode_png(SkWStream* dst,
 #define PNG(FLAG, ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s) { \
            return encode_png(d, s, SkPngEncoder::FilterFlag::FLAG, ZLIBLEVEL); }
 
+template <int kThreads>
+static bool encode_png_parallel(SkWStream* dst, const SkPixmap& src) {
+    static SkExecutor* executor = SkExecutor::MakeFIFOThreadPool(kThreads).release();
+    SkPngEncoder::Options opts;
+    opts.fExecutor = executor;
+    return SkPngEncoder::Encode(dst, src, opts);
+}
+
 static const char* srcs[2] = {"images/mandrill_512.png", "images/color_wheel.jpg"};
 
 // The Android Photos app uses a quality of 90 on JPEG encodes
@@ -122,4 +131,14 @@ DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 6), "PNG_6n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 3), "PNG_3n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 1), "PNG_1n"));
 
+// Compare against "PNG" above to see how parallel deflate scales with threads.
+DEF_BENCH(return new EncodeBench(srcs[0], encode_png_parallel<1>, "PNG_mt1"));
+DEF_BENCH(return new EncodeBench(srcs[0], encode_png_parallel<2>, "PNG_mt2"));
+DEF_BENCH(return new EncodeBench(srcs[0], encode_png_parallel<4>, "PNG_mt4"));
+DEF_BENCH(return new EncodeBench(srcs[0], encode_png_parallel<8>, "PNG_mt8"));
+DEF_BENCH(return new EncodeBench(srcs[1], encode_png_parallel<1>, "PNG_mt1"));
+DEF_BENCH(return new EncodeBench(srcs[1], encode_png_parallel<2>, "PNG_mt2"));
+DEF_BENCH(return new EncodeBench(srcs[1], encode_png_parallel<4>, "PNG_mt4"));
+DEF_BENCH(return new EncodeBench(srcs[1], encode_png_parallel<8>, "PNG_mt8"));
+
 #undef PNG
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkFont.h"
+#include "include/core/SkGraphics.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkSurface.h"
+#include "src/core/SkStrikeCache.h"
+#include "src/core/SkStrikeSpec.h"
+#include "src/core/SkTaskGroup.h"
+#include "tools/ToolUtils.h"
+
+#include <vector>
+
+// The first frame of a text-heavy screen: every glyph starts out missing from the strike cache.
+// Cold draws make each glyph on the drawing thread as it's needed. Prewarmed makes them all
+// first, a strike per task on a thread pool, then draws from the warm cache. Each loop is one
+// whole frame, including the warm-up.
+class GlyphWarmupBench : public Benchmark {
+public:
+    explicit GlyphWarmupBench(bool prewarm) : fPrewarm(prewarm) {
+        fName.printf("glyph_warmup_first_frame_%s", prewarm ? "prewarmed" : "cold");
+    }
+
+private:
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        fSurface = SkSurface::MakeRaster(SkImageInfo::MakeN32Premul(kSize, kSize));
+        fExecutor = SkExecutor::MakeFIFOThreadPool();
+
+        const char* families[] = { "serif", "sans-serif", "monospace" };
+        for (const char* family : families) {
+            for (SkScalar size : { 11.f, 13.f, 16.f, 22.f }) {
+                SkFont font(ToolUtils::create_portable_typeface(family, SkFontStyle()), size);
+                font.setEdging(SkFont::Edging::kAntiAlias);
+                fFonts.push_back(font);
+            }
+        }
+
+        const char text[] = "The quick brown fox jumps over the lazy dog 0123456789";
+        for (const SkFont& font : fFonts) {
+            std::vector<SkGlyphID> glyphs(font.countText(text, strlen(text),
+                                                         SkTextEncoding::kUTF8));
+            font.textToGlyphs(text, strlen(text), SkTextEncoding::kUTF8,
+                              glyphs.data(), glyphs.size());
+            fGlyphs.push_back(std::move(glyphs));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkCanvas* canvas = fSurface->getCanvas();
+        SkPaint paint;
+        SkSurfaceProps props;
+        canvas->getProps(&props);
+
+        for (int i = 0; i < loops; i++) {
+            SkGraphics::PurgeFontCache();
+
+            if (fPrewarm) {
+                // Match the strikes a raster canvas without a color space will ask for.
+                SkTaskGroup group(*fExecutor);
+                for (size_t f = 0; f < fFonts.size(); f++) {
+                    SkStrikeCache::GlobalStrikeCache()->prewarm(
+                            SkStrikeSpec::MakeMask(fFonts[f], paint, props,
+                                                   SkScalerContextFlags::kFakeGammaAndBoostContrast,
+                                                   canvas->getTotalMatrix()),
+                            SkMakeSpan(fGlyphs[f]), &group);
+                }
+                group.wait();
+            }
+
+            SkScalar y = 0;
+            for (size_t f = 0; f < fFonts.size(); f++) {
+                y += fFonts[f].getSize() + 2;
+                canvas->drawSimpleText(fGlyphs[f].data(), fGlyphs[f].size() * sizeof(SkGlyphID),
+                                       SkTextEncoding::kGlyphID, 4, y, fFonts[f], paint);
+            }
+        }
+    }
+
+    static constexpr int kSize = 512;
+
+    const bool                          fPrewarm;
+    SkString                            fName;
+    sk_sp<SkSurface>                    fSurface;
+    std::unique_ptr<SkExecutor>         fExecutor;
+    std::vector<SkFont>                 fFonts;
+    std::vector<std::vector<SkGlyphID>> fGlyphs;  // The text's glyphs in each of fFonts.
+};
+
+DEF_BENCH(return new GlyphWarmupBench(false);)
+DEF_BENCH(return new GlyphWarmupBench( true);)
@@ -6,11 +6,18 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkPoint3.h"
 #include "include/effects/SkImageFilters.h"
 #include "include/gpu/GrDirectContext.h"
 #include "include/gpu/GrRecordingContext.h"
+#include "src/core/SkImageFilterCache.h"
+#include "src/core/SkImageFilter_Base.h"
+#include "src/core/SkSpecialImage.h"
 #include "tools/Resources.h"
 
 // Exercise a blur filter connected to 5 inputs of the same merge filter.
@@ -164,7 +171,154 @@ private:
     using INHERITED = Benchmark;
 };
 
+// Scroll a tall DAG that doesn't read its source (blurred and merged picture content) through a
+// viewport, a few pixels per frame. With the raster cache in kRegions mode, each frame reuses the
+// previous frame's output and only filters the newly exposed rows.
+class ImageFilterDAGScrollBench : public Benchmark {
+public:
+    ImageFilterDAGScrollBench(bool regions) : fRegions(regions) {}
+
+protected:
+    const char* onGetName() override {
+        return fRegions ? "image_filter_dag_scroll_regions" : "image_filter_dag_scroll";
+    }
+
+    void onDelayedSetup() override {
+        SkPictureRecorder recorder;
+        SkCanvas* content = recorder.beginRecording(SkRect::MakeWH(kWidth, kContentHeight));
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        for (int y = 0; y < kContentHeight; y += 50) {
+            paint.setColor(0xFF000000 | (y * 2654435761u >> 8));
+            content->drawCircle(25 + (y * 7) % (kWidth - 50), y + 25, 20, paint);
+            content->drawRect(SkRect::MakeXYWH(10, y + 40, kWidth - 20, 4), paint);
+        }
+        auto picture = SkImageFilters::Picture(recorder.finishRecordingAsPicture());
+
+        sk_sp<SkImageFilter> blur(SkImageFilters::Blur(8.0f, 8.0f, picture));
+        sk_sp<SkImageFilter> inputs[] = {blur, SkImageFilters::Offset(4, 4, blur), picture};
+        fFilter = SkImageFilters::Merge(inputs, SK_ARRAY_COUNT(inputs));
+    }
+
+    void onPerCanvasPreDraw(SkCanvas*) override {
+        // Only the raster backend uses the global cache across draws.
+        fPrevMode = SkImageFilterCache::Get()->mode();
+        SkImageFilterCache::Get()->setMode(fRegions ? SkImageFilterCache::Mode::kRegions
+                                                    : SkImageFilterCache::Mode::kExact);
+        SkImageFilterCache::Get()->purge();
+    }
+
+    void onPerCanvasPostDraw(SkCanvas*) override {
+        SkImageFilterCache::Get()->setMode(fPrevMode);
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        paint.setImageFilter(fFilter);
+
+        for (int j = 0; j < loops; j++) {
+            canvas->save();
+            canvas->clipRect(SkRect::MakeWH(kWidth, kViewportHeight));
+            canvas->translate(0, -fScroll);
+            canvas->drawRect(SkRect::MakeWH(kWidth, kContentHeight), paint);
+            canvas->restore();
+            fScroll = (fScroll + kScrollStep) % (kContentHeight - kViewportHeight);
+        }
+    }
+
+private:
+    static constexpr int kWidth = 400;
+    static constexpr int kViewportHeight = 400;
+    static constexpr int kContentHeight = 4000;
+    static constexpr int kScrollStep = 8;
+
+    bool fRegions;
+    int fScroll = 0;
+    sk_sp<SkImageFilter> fFilter;
+    SkImageFilterCache::Mode fPrevMode = SkImageFilterCache::Mode::kExact;
+
+    using INHERITED = Benchmark;
+};
+
+// Filter a large raster image with a chain of filters that read their inputs' neighbors (lighting
+// over morphology over matrix convolution), all at once or in tiles on a number of threads.
+class ImageFilterTilesBench : public Benchmark {
+public:
+    ImageFilterTilesBench(bool tiled, int threads) : fTiled(tiled), fThreads(threads) {
+        fName.printf("image_filter_tiles_%s", tiled ? "tiled" : "whole");
+        if (threads > 0) {
+            fName.appendf("_%d_threads", threads);
+        }
+    }
+
+protected:
+    bool isSuitableFor(Backend backend) override {
+        return kNonRendering_Backend == backend;
+    }
+
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        SkBitmap bm;
+        bm.allocN32Pixels(kSize, kSize);
+        SkCanvas canvas(bm);
+        canvas.clear(SK_ColorTRANSPARENT);
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        for (int i = 0; i < 200; ++i) {
+            paint.setColor(0xFF000000 | (i * 2654435761u >> 8));
+            canvas.drawCircle((i * 37) % kSize, (i * 71) % kSize, 10 + i % 40, paint);
+        }
+        fSrc = SkSpecialImage::MakeFromRaster(SkIRect::MakeWH(kSize, kSize), bm,
+                                              SkSurfaceProps());
+
+        const SkScalar kernel[9] = {
+            1, 1, 1,
+            1, -7, 1,
+            1, 1, 1,
+        };
+        fFilter = SkImageFilters::PointLitSpecular(
+                SkPoint3::Make(kSize / 2, kSize / 2, 200), SK_ColorWHITE, 1.5f, 1, 20,
+                SkImageFilters::Erode(2, 2, SkImageFilters::MatrixConvolution(
+                        SkISize::Make(3, 3), kernel, 1, 0, SkIPoint::Make(1, 1),
+                        SkTileMode::kClamp, true, nullptr)));
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        skif::Context ctx(SkMatrix::I(), SkIRect::MakeWH(kSize, kSize), nullptr,
+                          kN32_SkColorType, nullptr, fSrc.get());
+        for (int i = 0; i < loops; i++) {
+            if (fTiled) {
+                as_IFB(fFilter)->filterImageInTiles(ctx, fExecutor.get(), kTileSize);
+            } else {
+                as_IFB(fFilter)->filterImage(ctx);
+            }
+        }
+    }
+
+private:
+    static constexpr int kSize = 2048;
+    static constexpr int kTileSize = 512;
+
+    SkString fName;
+    const bool fTiled;
+    const int fThreads;
+    sk_sp<SkSpecialImage> fSrc;
+    sk_sp<SkImageFilter> fFilter;
+    std::unique_ptr<SkExecutor> fExecutor;
+
+    using INHERITED = Benchmark;
+};
+
 DEF_BENCH(return new ImageFilterDAGBench;)
 DEF_BENCH(return new ImageMakeWithFilterDAGBench;)
 DEF_BENCH(return new ImageFilterDisplacedBlur;)
 DEF_BENCH(return new ImageFilterXfermodeIn;)
+DEF_BENCH(return new ImageFilterDAGScrollBench(false);)
+DEF_BENCH(return new ImageFilterDAGScrollBench(true);)
+DEF_BENCH(return new ImageFilterTilesBench(false, 0);)
+DEF_BENCH(return new ImageFilterTilesBench(true, 0);)
+DEF_BENCH(return new ImageFilterTilesBench(true, 4);)
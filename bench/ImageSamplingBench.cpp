@@ -0,0 +1,115 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkColorPriv.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkString.h"
+#include "include/core/SkTileMode.h"
+#include "src/core/SkArenaAlloc.h"
+#include "src/core/SkRasterPipeline.h"
+
+// Bilinear sampling of an 8888 image through SkRasterPipeline, comparing lowp against highp
+// for a few typical transforms and tile modes.  The stages are the ones SkImageShader appends.
+class ImageSamplingBench : public Benchmark {
+public:
+    enum Transform { kUpscale, kDownscale, kRotate };
+
+    ImageSamplingBench(Transform xform, SkTileMode tile, bool lowp)
+        : fTransform(xform), fTile(tile), fLowp(lowp) {
+        static const char* kXformNames[] = { "upscale", "downscale", "rotate" };
+        static const char* kTileNames[]  = { "clamp", "repeat", "mirror", "decal" };
+        fName.printf("image_sampling_bilerp_%s_%s_%s", kXformNames[xform],
+                     kTileNames[(int)tile], lowp ? "lowp" : "highp");
+    }
+
+private:
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        for (int y = 0; y < kImageSize; y++) {
+            for (int x = 0; x < kImageSize; x++) {
+                fSrc[y*kImageSize + x] = SkPreMultiplyARGB(0xff, x, y, x^y);
+            }
+        }
+
+        SkMatrix m;
+        switch (fTransform) {
+            case kUpscale:   m.setScale(1.7f, 1.7f); break;
+            case kDownscale: m.setScale(0.6f, 0.6f); break;
+            case kRotate:    m.setRotate(30, kSize/2, kSize/2);
+                             m.preScale(1.1f, 1.1f, kSize/2, kSize/2); break;
+        }
+        SkAssertResult(m.invert(&fInverse));
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkRasterPipeline_GatherCtx gather;
+        gather.pixels = fSrc;
+        gather.stride = kImageSize;
+        gather.width  = kImageSize;
+        gather.height = kImageSize;
+
+        SkRasterPipeline_SamplerCtx2 sampler;
+        *(SkRasterPipeline_GatherCtx*)(&sampler) = gather;
+        sampler.ct        = kN32_SkColorType;
+        sampler.tileX     = fTile;
+        sampler.tileY     = fTile;
+        sampler.invWidth  = 1.0f / kImageSize;
+        sampler.invHeight = 1.0f / kImageSize;
+
+        SkRasterPipeline_MemoryCtx dst = { fDst, kSize };
+
+        SkSTArenaAlloc<256> alloc;
+        SkRasterPipeline p(&alloc);
+        p.append(SkRasterPipeline::seed_shader);
+        p.append_matrix(&alloc, fInverse);
+        if (fTile == SkTileMode::kClamp) {
+            p.append(SkRasterPipeline::bilerp_clamp_8888, &gather);
+        } else {
+            p.append(SkRasterPipeline::bilinear, &sampler);
+        }
+        p.append(SkRasterPipeline::store_8888, &dst);
+        if (!fLowp) {
+            p.forceHighp();
+        }
+
+        auto fn = p.compile();
+        for (int i = 0; i < loops; i++) {
+            fn(0,0,kSize,kSize);
+        }
+    }
+
+    static constexpr int kSize      = 512;
+    static constexpr int kImageSize = 256;
+
+    Transform  fTransform;
+    SkTileMode fTile;
+    bool       fLowp;
+    SkString   fName;
+    SkMatrix   fInverse;
+    uint32_t   fSrc[kImageSize*kImageSize];
+    uint32_t   fDst[kSize*kSize];
+};
+
+using Bench = ImageSamplingBench;
+
+DEF_BENCH(return new Bench(Bench::kUpscale,   SkTileMode::kClamp,   true);)
+DEF_BENCH(return new Bench(Bench::kUpscale,   SkTileMode::kClamp,  false);)
+DEF_BENCH(return new Bench(Bench::kUpscale,   SkTileMode::kRepeat,  true);)
+DEF_BENCH(return new Bench(Bench::kUpscale,   SkTileMode::kRepeat, false);)
+
+DEF_BENCH(return new Bench(Bench::kDownscale, SkTileMode::kClamp,   true);)
+DEF_BENCH(return new Bench(Bench::kDownscale, SkTileMode::kClamp,  false);)
+DEF_BENCH(return new Bench(Bench::kDownscale, SkTileMode::kRepeat,  true);)
+DEF_BENCH(return new Bench(Bench::kDownscale, SkTileMode::kRepeat, false);)
+
+DEF_BENCH(return new Bench(Bench::kRotate,    SkTileMode::kClamp,   true);)
+DEF_BENCH(return new Bench(Bench::kRotate,    SkTileMode::kClamp,  false);)
+DEF_BENCH(return new Bench(Bench::kRotate,    SkTileMode::kRepeat,  true);)
+DEF_BENCH(return new Bench(Bench::kRotate,    SkTileMode::kRepeat, false);)
@@ -7,24 +7,38 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "src/core/SkMipmap.h"
+#include "tools/ToolUtils.h"
 
 class MipmapBench: public Benchmark {
     SkBitmap fBitmap;
     SkString fName;
     const int fW, fH;
-    bool fHalfFoat;
+    const SkColorType fColorType;
+    const int fThreads;
+    std::unique_ptr<SkExecutor> fExecutor;
 
 public:
     MipmapBench(int w, int h, bool halfFloat = false)
-        : fW(w), fH(h), fHalfFoat(halfFloat)
-    {
+        : MipmapBench(w, h, halfFloat ? kRGBA_F16_SkColorType : kN32_SkColorType, 0) {
         fName.printf("mipmap_build_%dx%d", w, h);
         if (halfFloat) {
             fName.append("_f16");
         }
     }
 
+    // Each loop builds the mips of a w x h image 4 times, so the base level megapixels per
+    // second are 4 * w * h / (1e6 * seconds per loop).
+    MipmapBench(int w, int h, SkColorType ct, int threads)
+        : fW(w), fH(h), fColorType(ct), fThreads(threads)
+    {
+        fName.printf("mipmap_build_%dx%d_%s", w, h, ToolUtils::colortype_name(ct));
+        if (threads > 0) {
+            fName.appendf("_%d_threads", threads);
+        }
+    }
+
 protected:
     bool isSuitableFor(Backend backend) override {
         return kNonRendering_Backend == backend;
@@ -33,16 +47,18 @@ protected:
     const char* onGetName() override { return fName.c_str(); }
 
     void onDelayedSetup() override {
-        SkColorType ct = fHalfFoat ? kRGBA_F16_SkColorType : kN32_SkColorType;
-        SkImageInfo info = SkImageInfo::Make(fW, fH, ct, kPremul_SkAlphaType,
+        SkImageInfo info = SkImageInfo::Make(fW, fH, fColorType, kPremul_SkAlphaType,
                                              SkColorSpace::MakeSRGB());
         fBitmap.allocPixels(info);
         fBitmap.eraseColor(SK_ColorWHITE);  // so we don't read uninitialized memory
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
     }
 
     void onDraw(int loops, SkCanvas*) override {
         for (int i = 0; i < loops * 4; i++) {
-            SkMipmap::Build(fBitmap, nullptr)->unref();
+            SkMipmap::Build(fBitmap.pixmap(), nullptr, true, fExecutor.get())->unref();
         }
     }
 
@@ -65,3 +81,18 @@ DEF_BENCH( return new MipmapBench(2048, 2048); )
 DEF_BENCH( return new MipmapBench(2047, 2047); )
 DEF_BENCH( return new MipmapBench(2048, 2047); )
 DEF_BENCH( return new MipmapBench(2047, 2048); )
+
+// Throughput of each of the vectorized formats, for an even and an odd sized image, on the
+// calling thread and in stripes on a thread pool.
+DEF_BENCH( return new MipmapBench(4096, 4096, kRGBA_8888_SkColorType,    0); )
+DEF_BENCH( return new MipmapBench(4095, 4095, kRGBA_8888_SkColorType,    0); )
+DEF_BENCH( return new MipmapBench(4096, 4096, kAlpha_8_SkColorType,      0); )
+DEF_BENCH( return new MipmapBench(4095, 4095, kAlpha_8_SkColorType,      0); )
+DEF_BENCH( return new MipmapBench(4096, 4096, kRGBA_F16_SkColorType,     0); )
+DEF_BENCH( return new MipmapBench(4095, 4095, kRGBA_F16_SkColorType,     0); )
+DEF_BENCH( return new MipmapBench(4096, 4096, kRGBA_1010102_SkColorType, 0); )
+DEF_BENCH( return new MipmapBench(4095, 4095, kRGBA_1010102_SkColorType, 0); )
+
+DEF_BENCH( return new MipmapBench(4096, 4096, kRGBA_8888_SkColorType,    4); )
+DEF_BENCH( return new MipmapBench(4095, 4095, kRGBA_8888_SkColorType,    4); )
+DEF_BENCH( return new MipmapBench(4096, 4096, kRGBA_F16_SkColorType,     4); )
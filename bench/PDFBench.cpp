@@ -10,6 +10,7 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkData.h"
 #include "include/core/SkExecutor.h"
+#include "include/core/SkFont.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkPixmap.h"
 #include "include/core/SkStream.h"
@@ -311,6 +312,48 @@ DEF_BENCH(return new PDFShaderBench;)
 DEF_BENCH(return new WritePDFTextBenchmark;)
 DEF_BENCH(return new PDFClipPathBenchmark;)
 
+namespace {
+// Every page draws a new image and new text, so without streaming the document's
+// deduplication tables grow with the page count.  Run each alone (--match) to compare
+// the max RSS nanobench reports with and without Metadata::fStreamingMemoryBudget.
+struct PDFStreamingBench : public Benchmark {
+    int fPageCount;
+    bool fStreaming;
+    SkString fName;
+    SkBitmap fImage;
+    PDFStreamingBench(int pageCount, bool streaming)
+        : fPageCount(pageCount)
+        , fStreaming(streaming)
+        , fName(SkStringPrintf("PDFStreamingBench_%d_%s",
+                               pageCount, streaming ? "streaming" : "retained")) {}
+    void onDelayedSetup() override { fImage.allocN32Pixels(64, 64); }
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            SkNullWStream wStream;
+            SkPDF::Metadata metadata;
+            metadata.fStreamingMemoryBudget = fStreaming ? 4 * 1024 * 1024 : 0;
+            auto doc = SkPDF::MakeDocument(&wStream, metadata);
+            SkFont font;
+            for (int i = 0; i < fPageCount; ++i) {
+                SkCanvas* canvas = doc->beginPage(612, 792);
+                fImage.eraseColor(SkColorSetARGB(0xFF, 0x00, (uint8_t)i, 0x00));
+                canvas->drawImage(fImage.asImage(), 36, 72);
+                SkString text = SkStringPrintf("Page %d of %d", i + 1, fPageCount);
+                canvas->drawString(text, 36, 36, font, SkPaint());
+                doc->endPage();
+            }
+            doc->close();
+        }
+    }
+};
+}  // namespace
+DEF_BENCH(return new PDFStreamingBench(1000, false);)
+DEF_BENCH(return new PDFStreamingBench(1000, true);)
+DEF_BENCH(return new PDFStreamingBench(5000, false);)
+DEF_BENCH(return new PDFStreamingBench(5000, true);)
+
 #ifdef SK_PDF_ENABLE_SLOW_TESTS
 #include "include/core/SkExecutor.h"
 namespace {
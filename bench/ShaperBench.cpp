@@ -5,6 +5,8 @@
 
 #if !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(SK_BUILD_FOR_GOOGLE3)
 
+#include "include/core/SkString.h"
+#include "include/private/SkTArray.h"
 #include "modules/skshaper/include/SkShaper.h"
 #include "tools/Resources.h"
 
@@ -35,8 +37,55 @@ struct ShaperBench : public Benchmark {
         }
     }
 };
+
+// Shapes short UI labels, of which hitPercent are drawn from a small set shaped over and over
+// and the rest are never seen before, to measure how much the shaper's run cache saves.
+struct ShaperLabelBench : public Benchmark {
+    ShaperLabelBench(int hitPercent) : fHitPercent(hitPercent) {
+        fName.printf("shaper_ui_labels_hit_%d", hitPercent);
+    }
+    std::unique_ptr<SkShaper> fShaper;
+    SkTArray<SkString> fLabels;
+    int fHitPercent;
+    int fUnique = 0;
+    SkString fName;
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    void onDelayedSetup() override {
+        fShaper = SkShaper::Make();
+        for (const char* label : { "OK", "Cancel", "Settings", "Open", "Save as...", "Close",
+                                   "Help", "Back", "Next", "Done", "Search", "Sign in" }) {
+            fLabels.push_back(SkString(label));
+        }
+        for (int i = 0; i < 20; ++i) {
+            fLabels.push_back(SkStringPrintf("%d,%03d", i + 1, (i * 137) % 1000));
+        }
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        if (!fShaper) { return; }
+        SkFont font;
+        SkString unique;
+        while (loops-- > 0) {
+            for (int i = 0; i < 100; ++i) {
+                const SkString* label = &fLabels[i % fLabels.count()];
+                if (i >= fHitPercent) {
+                    unique.printf("Item %d", fUnique++);
+                    label = &unique;
+                }
+                SkTextBlobBuilderRunHandler rh(label->c_str(), {0, 0});
+                fShaper->shape(label->c_str(), label->size(), font, true, FLT_MAX, &rh);
+                (void)rh.makeBlob();
+            }
+        }
+    }
+};
 }  // namespace
 
+DEF_BENCH(return new ShaperLabelBench(0);)
+DEF_BENCH(return new ShaperLabelBench(50);)
+DEF_BENCH(return new ShaperLabelBench(90);)
+DEF_BENCH(return new ShaperLabelBench(100);)
+
 #define SHAPER_BENCH(X) DEF_BENCH(return new ShaperBench("text/" #X ".txt", "shaper_" #X);)
 SHAPER_BENCH(arabic)
 SHAPER_BENCH(armenian)
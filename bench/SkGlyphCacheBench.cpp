@@ -19,6 +19,9 @@
 #include "tools/Resources.h"
 #include "tools/ToolUtils.h"
 
+#include <thread>
+#include <vector>
+
 static void do_font_stuff(SkFont* font) {
     SkPaint defaultPaint;
     for (SkScalar i = 8; i < 64; i++) {
@@ -112,10 +115,139 @@ private:
     SkString fName;
 };
 
+// Strike lookups from many threads at once, all hitting in the global strike cache.
+// Each loop is one findOrCreateStrike() per thread, so as the thread count grows, flat
+// times mean lookups/sec are scaling with it and rising times mean the cache is contended.
+class SkGlyphCacheLookup : public Benchmark {
+public:
+    explicit SkGlyphCacheLookup(int threads) : fThreads(threads) {
+        fName.printf("SkGlyphCacheLookup_%dthreads", threads);
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        SkFont font;
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        font.setSubpixel(true);
+        font.setTypeface(ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic()));
+
+        SkPaint defaultPaint;
+        for (int i = 0; i < kStrikes; i++) {
+            font.setSize(8 + i);
+            fSpecs.push_back(SkStrikeSpec::MakeMask(
+                    font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                    SkScalerContextFlags::kNone, SkMatrix::I()));
+            (void)fSpecs.back().findOrCreateStrike();
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < fThreads; t++) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < loops; i++) {
+                    (void)fSpecs[(i + t) % kStrikes].findOrCreateStrike();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+private:
+    static constexpr int kStrikes = 32;
+
+    const int                 fThreads;
+    SkString                  fName;
+    std::vector<SkStrikeSpec> fSpecs;
+};
+
+// Glyph rasterization from many threads at once, each thread rendering from its own typeface
+// (or all from the same one when shared). Every loop renders into a fresh private strike cache,
+// so each glyph goes through the font's scaler context rather than being found in a cache.
+class SkGlyphCacheRasterize : public Benchmark {
+public:
+    SkGlyphCacheRasterize(int threads, bool shared) : fThreads(threads), fShared(shared) {
+        fName.printf("SkGlyphCacheRasterize_%dthreads%s", threads, shared ? "_shared" : "");
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        SkPaint defaultPaint;
+        for (int t = 0; t < fThreads; t++) {
+            // Each typeface made from a resource is distinct, even when made from the same file.
+            sk_sp<SkTypeface> typeface = fShared && t > 0 ? fTypefaces.back()
+                                                          : MakeResourceAsTypeface(kResource);
+            if (!typeface) {
+                typeface = ToolUtils::create_portable_typeface();
+            }
+            fTypefaces.push_back(typeface);
+
+            SkFont font(typeface, 18);
+            font.setEdging(SkFont::Edging::kAntiAlias);
+            fSpecs.push_back(SkStrikeSpec::MakeMask(
+                    font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                    SkScalerContextFlags::kNone, SkMatrix::I()));
+        }
+        SkFont font(fTypefaces[0]);
+        for (int i = 0; i < kGlyphs; i++) {
+            fGlyphs[i] = SkPackedGlyphID{font.unicharToGlyph('a' + i)};
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < fThreads; t++) {
+            threads.emplace_back([&, t] {
+                const SkGlyph* results[kGlyphs];
+                for (int i = 0; i < loops; i++) {
+                    SkStrikeCache cache;
+                    sk_sp<SkStrike> strike = fSpecs[t].findOrCreateStrike(&cache);
+                    (void)strike->prepareImages(SkMakeSpan(fGlyphs), results);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+private:
+    static constexpr char kResource[] = "fonts/Roboto-Regular.ttf";
+    static constexpr int  kGlyphs     = 26;
+
+    const int                      fThreads;
+    const bool                     fShared;
+    SkString                       fName;
+    std::vector<sk_sp<SkTypeface>> fTypefaces;
+    std::vector<SkStrikeSpec>      fSpecs;
+    SkPackedGlyphID                fGlyphs[kGlyphs];
+};
+
 DEF_BENCH( return new SkGlyphCacheBasic(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheBasic(32 * 1024 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(32 * 1024 * 1024); )
+DEF_BENCH( return new SkGlyphCacheLookup(1); )
+DEF_BENCH( return new SkGlyphCacheLookup(4); )
+DEF_BENCH( return new SkGlyphCacheLookup(16); )
+DEF_BENCH( return new SkGlyphCacheLookup(32); )
+DEF_BENCH( return new SkGlyphCacheRasterize(1, false); )
+DEF_BENCH( return new SkGlyphCacheRasterize(8, false); )
+DEF_BENCH( return new SkGlyphCacheRasterize(8,  true); )
 
 namespace {
 class DiscardableManager : public SkStrikeServer::DiscardableHandleManager,
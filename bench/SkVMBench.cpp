@@ -0,0 +1,60 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkColorPriv.h"
+#include "src/core/SkVM.h"
+
+extern bool gSkVMAllowAVX512;
+
+// Measures SkVM blitter throughput on wide spans: an 8888 src-over-dst blend,
+// JIT'd with or without the AVX-512 backend.
+class SkVMSrcOverBench : public Benchmark {
+public:
+    SkVMSrcOverBench(int pixels, bool avx512) : fPixels(pixels), fAVX512(avx512) {
+        fName.printf("SkVM_srcover_%d%s", pixels, avx512 ? "_avx512" : "");
+    }
+
+private:
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        fSrc.resize(fPixels, SkPackARGB32(0x80, 0x40, 0x20, 0x10));
+        fDst.resize(fPixels, SkPackARGB32(0xff, 0x10, 0x20, 0x30));
+
+        skvm::PixelFormat fmt = skvm::SkColorType_to_PixelFormat(kRGBA_8888_SkColorType);
+        skvm::Builder b;
+        skvm::Ptr src = b.varying<uint32_t>(),
+                  dst = b.varying<uint32_t>();
+        skvm::Color s = b.load(fmt, src),
+                    d = b.load(fmt, dst);
+        b.store(fmt, dst, skvm::blend(SkBlendMode::kSrcOver, s, d));
+
+        const bool allowed = gSkVMAllowAVX512;
+        gSkVMAllowAVX512 = fAVX512;
+        fProgram = b.done();
+        gSkVMAllowAVX512 = allowed;
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops --> 0) {
+            fProgram.eval(fPixels, fSrc.data(), fDst.data());
+        }
+    }
+
+    int                   fPixels;
+    bool                  fAVX512;
+    SkString              fName;
+    std::vector<uint32_t> fSrc, fDst;
+    skvm::Program         fProgram;
+};
+
+DEF_BENCH(return new SkVMSrcOverBench(  15, false);)
+DEF_BENCH(return new SkVMSrcOverBench(4096, false);)
+DEF_BENCH(return new SkVMSrcOverBench(  15,  true);)
+DEF_BENCH(return new SkVMSrcOverBench(4096,  true);)
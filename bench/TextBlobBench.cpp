@@ -13,8 +13,10 @@
 #include "include/core/SkString.h"
 #include "include/core/SkTextBlob.h"
 #include "include/core/SkTypeface.h"
+#include "include/private/SkTArray.h"
 #include "include/private/SkTemplates.h"
 #include "include/utils/SkRandom.h"
+#include "src/core/SkTextBlobRasterCache.h"
 #include "tools/Resources.h"
 
 #include "tools/ToolUtils.h"
@@ -109,3 +111,65 @@ class TextBlobMakeBench : public SkTextBlobBench {
     }
 };
 DEF_BENCH( return new TextBlobMakeBench(); )
+
+/*
+ * Scrolls a page of static text blobs by whole pixels, as UI does. With the raster blob cache,
+ * each blob finds the glyphs it drew the frame before; without it, every draw looks up its
+ * strike and glyphs again.
+ */
+class TextBlobScrollBench : public Benchmark {
+public:
+    explicit TextBlobScrollBench(bool useRasterCache) : fUseRasterCache(useRasterCache) {}
+
+private:
+    const char* onGetName() override {
+        return fUseRasterCache ? "TextBlobScroll_cached" : "TextBlobScroll_uncached";
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kRaster_Backend;
+    }
+
+    void onDelayedSetup() override {
+        SkFont font(ToolUtils::create_portable_typeface("serif", SkFontStyle()), 12);
+        font.setSubpixel(true);
+        SkRandom random;
+        for (int i = 0; i < 40; ++i) {
+            SkString line;
+            for (int word = 0; word < 8; ++word) {
+                line.appendf("%s ", kWords[random.nextULessThan(SK_ARRAY_COUNT(kWords))]);
+            }
+            fBlobs.push_back(SkTextBlob::MakeFromString(line.c_str(), font));
+        }
+    }
+
+    void onPreDraw(SkCanvas*) override {
+        SkTextBlobRasterCache::GlobalCache()->setGlyphBudget(
+                fUseRasterCache ? SkTextBlobRasterCache::kDefaultGlyphBudget : 0);
+    }
+
+    void onPostDraw(SkCanvas*) override {
+        SkTextBlobRasterCache::GlobalCache()->setGlyphBudget(
+                SkTextBlobRasterCache::kDefaultGlyphBudget);
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        for (int i = 0; i < loops; i++) {
+            int scroll = i % 20;
+            for (int line = 0; line < fBlobs.count(); ++line) {
+                canvas->drawTextBlob(fBlobs[line], 10, 15.0f * (line + 1) - scroll, paint);
+            }
+        }
+    }
+
+    static constexpr const char* kWords[] = {
+        "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "Settings", "Cancel",
+        "message", "account", "Open", "window", "12:45", "yesterday", "reply", "share",
+    };
+
+    bool fUseRasterCache;
+    SkTArray<sk_sp<SkTextBlob>> fBlobs;
+};
+DEF_BENCH( return new TextBlobScrollBench(true); )
+DEF_BENCH( return new TextBlobScrollBench(false); )
@@ -68,6 +68,7 @@ extern bool gSkForceRasterPipelineBlitter;
 extern bool gUseSkVMBlitter;
 extern bool gSkVMAllowJIT;
 extern bool gSkVMJITViaDylib;
+extern bool gSkVMAllowAVX512;
 
 #ifndef SK_BUILD_FOR_WIN
     #include <unistd.h>
@@ -142,6 +143,7 @@ static DEFINE_string(benchType,  "",
 static DEFINE_bool(forceRasterPipeline, false, "sets gSkForceRasterPipelineBlitter");
 static DEFINE_bool(skvm, false, "sets gUseSkVMBlitter");
 static DEFINE_bool(jit, true, "JIT SkVM?");
+static DEFINE_bool(avx512, true, "Allow the SkVM JIT to use AVX-512 when the CPU supports it?");
 static DEFINE_bool(dylib, false, "JIT via dylib (much slower compile but easier to debug/profile)");
 
 static DEFINE_bool2(pre_log, p, false,
@@ -1291,6 +1293,7 @@ int main(int argc, char** argv) {
     gUseSkVMBlitter = FLAGS_skvm;
     gSkVMAllowJIT = FLAGS_jit;
     gSkVMJITViaDylib = FLAGS_dylib;
+    gSkVMAllowAVX512 = FLAGS_avx512;
 
     int runs = 0;
     BenchmarkStream benchStream;
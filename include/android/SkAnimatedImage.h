@@ -15,6 +15,7 @@
 #include "include/core/SkRect.h"
 
 class SkAndroidCodec;
+class SkData;
 class SkImage;
 class SkPicture;
 
@@ -41,6 +42,26 @@ public:
      */
     static sk_sp<SkAnimatedImage> Make(std::unique_ptr<SkAndroidCodec>);
 
+    /**
+     *  Like Make(), but decoded frames are shared with every other SkAnimatedImage
+     *  made by MakeShared() from the same encoded data, at the same decoded size
+     *  and format.
+     *
+     *  Frames live in the process-wide SkResourceCache, so instances showing the
+     *  same animation decode each frame, and the frames it depends on, once
+     *  between them rather than once per instance. Frames that were purged from
+     *  the cache are decoded again as needed.
+     *
+     *  Returns null if encoded cannot be decoded or on failure to allocate pixels.
+     */
+    static sk_sp<SkAnimatedImage> MakeShared(sk_sp<SkData> encoded, const SkImageInfo& info,
+            SkIRect cropRect, sk_sp<SkPicture> postProcess);
+
+    /**
+     *  Simpler version that uses the default size, no cropping, and no postProcess.
+     */
+    static sk_sp<SkAnimatedImage> MakeShared(sk_sp<SkData> encoded);
+
     ~SkAnimatedImage() override;
 
     /**
@@ -152,9 +173,27 @@ private:
     Frame                           fRestoreFrame;
     int                             fRepetitionCount;
     int                             fRepetitionsCompleted;
+    // The encoded data whose frames are shared, or null if frames are not shared.
+    const sk_sp<SkData>             fSharedEncoded;
+    // Identifies fSharedEncoded in the shared frame cache.
+    const uint64_t                  fFrameCacheID;
+    // Encoded data already found to match fSharedEncoded, to skip comparing it again.
+    mutable sk_sp<SkData>           fMatchedEncoded;
 
     SkAnimatedImage(std::unique_ptr<SkAndroidCodec>, const SkImageInfo& requestedInfo,
-            SkIRect cropRect, sk_sp<SkPicture> postProcess);
+            SkIRect cropRect, sk_sp<SkPicture> postProcess, sk_sp<SkData> sharedEncoded);
+
+    static sk_sp<SkAnimatedImage> Make(std::unique_ptr<SkAndroidCodec>,
+            const SkImageInfo& info, SkIRect cropRect, sk_sp<SkPicture> postProcess,
+            sk_sp<SkData> sharedEncoded);
+
+    /**
+     *  Looks up frame |index| in the shared frame cache, sharing its pixels with
+     *  frame->fBitmap on success. Frames are only shared if they were decoded
+     *  from the same encoded bytes, not just ones with the same hash.
+     */
+    bool findSharedFrame(int index, const SkImageInfo& info, Frame* frame) const;
+    void addSharedFrame(const Frame&) const;
 
     int computeNextFrame(int current, bool* animationEnded);
     double finish();
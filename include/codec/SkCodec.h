@@ -27,6 +27,7 @@
 class SkAndroidCodec;
 class SkColorSpace;
 class SkData;
+class SkExecutor;
 class SkFrameHolder;
 class SkImage;
 class SkPngChunkReader;
@@ -290,6 +291,7 @@ public:
             , fFrameIndex(0)
             , fPriorFrame(kNoFrame)
             , fRegionHeight(0)
+            , fExecutor(nullptr)
         {}
 
         ZeroInitialized            fZeroInitialized;
@@ -338,6 +340,13 @@ public:
         *  To do the sampleDecode correctly, region height is required
         */
         unsigned int               fRegionHeight;
+
+        /**
+         *  If set, getPixels() may decode independent parts of the image concurrently on
+         *  this executor.  Currently only used by the JPEG codec, for baseline images whose
+         *  scan is split by restart markers.  The result is identical to a serial decode.
+         */
+        SkExecutor*                fExecutor;
     };
 
     /**
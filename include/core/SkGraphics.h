@@ -73,6 +73,24 @@ public:
      */
     static void PurgeFontCache();
 
+    /**
+     *  SaveFontCache() writes the glyphs in the font cache (their metrics, masks, and paths) to a
+     *  file. LoadFontCache() maps such a file read-only, and from then on the font cache fills
+     *  the strikes it creates from that file, when it has them, instead of rasterizing those
+     *  glyphs again. Many processes may load the same file; one can save over it while others
+     *  have it loaded.
+     *
+     *  Strikes are matched by the font's contents rather than by typeface, so the same font
+     *  loaded in another process finds them. A file written by a different Skia milestone, or
+     *  with a different file format, is rejected, as is any strike whose data fails its
+     *  checksum. The file doesn't record the font backend (e.g. the FreeType version) that
+     *  rasterized the glyphs, so only share it among processes of the same build.
+     *
+     *  Both return false on failure.
+     */
+    static bool SaveFontCache(const char path[]);
+    static bool LoadFontCache(const char path[]);
+
     /**
      *  This function returns the memory used for temporary images and other resources.
      */
@@ -144,6 +162,34 @@ public:
      *  Call early in main() to allow Skia to use a JIT to accelerate CPU-bound operations.
      */
     static void AllowJIT();
+
+    /**
+     *  Machine code from the JIT is kept in a process-wide cache, keyed by program and CPU
+     *  features. SaveJITCodeCache() writes that cache to a file, and LoadJITCodeCache() maps
+     *  such a file back in (typically early in main(), after AllowJIT()), so that a short-lived
+     *  process skips compiling any program it shares with the process that saved the file.
+     *
+     *  A file is only accepted on a CPU with the same features, by a build whose JIT emits the
+     *  same code for a reference program as the build that saved it. At most a fixed number of
+     *  programs are cached; the least recently used ones are dropped first. A file contains
+     *  executable code, so only load files from a trusted location.
+     *
+     *  Both return false on failure, including when the JIT is not available.
+     */
+    static bool SaveJITCodeCache(const char path[]);
+    static bool LoadJITCodeCache(const char path[]);
+
+    struct JITCodeCacheStats {
+        int    fHits;           // programs whose code came from the cache
+        int    fMisses;         // programs compiled from scratch
+        double fCompileMs;      // time spent compiling the misses
+        double fSavedMs;        // time the hits originally took to compile
+    };
+
+    /**
+     *  Returns how well the JIT code cache has done in this process so far.
+     */
+    static JITCodeCacheStats GetJITCodeCacheStats();
 };
 
 class SkAutoGraphics {
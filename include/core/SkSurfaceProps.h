@@ -52,7 +52,13 @@ class SK_API SkSurfaceProps {
 public:
     enum Flags {
         kUseDeviceIndependentFonts_Flag = 1 << 0,
-        kLast_Flag                      = kUseDeviceIndependentFonts_Flag
+        /**
+         *  On raster surfaces, play back large pictures by splitting the device clip into tiles
+         *  and drawing the tiles concurrently on SkExecutor::GetDefault(). Pictures are drawn
+         *  directly into the device's pixels, bypassing any SkCanvas subclass draw overrides.
+         */
+        kParallelPicturePlayback_Flag   = 1 << 1,
+        kLast_Flag                      = kParallelPicturePlayback_Flag
     };
     /** Deprecated alias used by Chromium. Will be removed. */
     static const Flags kUseDistanceFieldFonts_Flag = kUseDeviceIndependentFonts_Flag;
@@ -75,6 +81,10 @@ public:
         return SkToBool(fFlags & kUseDeviceIndependentFonts_Flag);
     }
 
+    bool isParallelPicturePlayback() const {
+        return SkToBool(fFlags & kParallelPicturePlayback_Flag);
+    }
+
     bool operator==(const SkSurfaceProps& that) const {
         return fFlags == that.fFlags && fPixelGeometry == that.fPixelGeometry;
     }
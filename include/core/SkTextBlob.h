@@ -250,8 +250,14 @@ private:
         fCacheID.store(cacheID);
     }
 
+    // Like notifyAddedToCache, for SkTextBlobRasterCache.
+    void notifyAddedToRasterCache() const {
+        fAddedToRasterCache.store(true);
+    }
+
     friend class SkGlyphRunList;
     friend class GrTextBlobCache;
+    friend class SkTextBlobRasterCache;
     friend class SkTextBlobBuilder;
     friend class SkTextBlobPriv;
     friend class SkTextBlobRunIterator;
@@ -259,6 +265,7 @@ private:
     const SkRect                  fBounds;
     const uint32_t                fUniqueID;
     mutable std::atomic<uint32_t> fCacheID;
+    mutable std::atomic<bool>     fAddedToRasterCache;
 
     SkDEBUGCODE(size_t fStorageSize;)
 
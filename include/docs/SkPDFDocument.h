@@ -196,15 +196,38 @@ struct Metadata {
     /** Executor to handle threaded work within PDF Backend. If this is nullptr,
         then all work will be done serially on the main thread. To have worker
         threads assist with various tasks, set this to a valid SkExecutor
-        instance. Currently used for executing Deflate algorithm in parallel.
+        instance. Currently used for compressing content streams, encoding
+        images and subsetting fonts in parallel.
 
-        If set, the PDF output will be non-reproducible in the order and
-        internal numbering of objects, but should render the same.
+        Objects finished on the executor are written in the order their work
+        was queued, so the output is the same for any number of threads.
 
         Experimental.
     */
     SkExecutor* fExecutor = nullptr;
 
+    /** When fExecutor is set, the approximate number of bytes of queued work
+        (content streams and images waiting to be compressed and written) that
+        may be held in memory at once. Past this, drawing waits for the
+        executor to catch up. Zero means no limit.
+
+        Experimental.
+    */
+    size_t fExecutorMemoryBudget = 64 * 1024 * 1024;
+
+    /** If nonzero, write the document in streaming mode.  Each page is
+        written as soon as it ends, and once the per-document state kept
+        between pages (font glyph usage, typeface metrics, and the image,
+        shader and graphic state deduplication tables) grows past this many
+        bytes, the fonts used so far are written and that state is dropped.
+        This bounds memory for documents with many thousands of pages, at the
+        cost of a larger file: fonts and images used on both sides of a flush
+        are written more than once.
+
+        Experimental.
+    */
+    size_t fStreamingMemoryBudget = 0;
+
     /** Preferred Subsetter. Only respected if both are compiled in.
 
         The Sfntly subsetter is deprecated.
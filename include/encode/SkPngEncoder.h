@@ -11,6 +11,7 @@
 #include "include/core/SkDataTable.h"
 #include "include/encode/SkEncoder.h"
 
+class SkExecutor;
 class SkPngEncoderMgr;
 class SkWStream;
 
@@ -59,6 +60,16 @@ public:
          *  and the (2i + 1)-th entry is the text for the i-th comment.
          */
         sk_sp<SkDataTable> fComments;
+
+        /**
+         *  If set, Encode() splits the image into bands of rows that are filtered and
+         *  compressed independently on this executor, then stitched into a single zlib stream.
+         *  The output is deterministic (it does not depend on the number of threads), but is
+         *  typically slightly larger than, and not byte-identical to, the serial output.
+         *
+         *  Only used by Encode(); encoders returned by Make() always compress serially.
+         */
+        SkExecutor* fExecutor = nullptr;
     };
 
     /**
@@ -12,7 +12,9 @@
 #include "tools/Resources.h"
 
 #include <cfloat>
+#include "include/core/SkExecutor.h"
 #include "include/core/SkPictureRecorder.h"
+#include "include/utils/SkRandom.h"
 #include "modules/skparagraph/utils/TestFontCollection.h"
 
 using namespace skia::textlayout;
@@ -46,15 +48,127 @@ struct ParagraphBench : public Benchmark {
         SkCanvas* canvas = rec.beginRecording({0,0, 2000,3000});
         while (loops-- > 0) {
             paragraph->layout(fWidth);
-            auto impl = static_cast<ParagraphImpl*>(paragraph.get());
             paragraph->paint(canvas, 0, 0);
             paragraph->markDirty();
-            impl->resetCache();
+            fontCollection->getParagraphCache()->reset();
         }
     }
 };
+
+// A text editor typing into the middle of a 50KB paragraph: every keystroke builds the
+// paragraph again and lays it out. Incremental layout reshapes only the text around the edit.
+struct ParagraphEditBench : public Benchmark {
+    ParagraphEditBench(bool incremental) : fIncremental(incremental) {
+        fName.printf("paragraph_edit_middle_%s", incremental ? "incremental" : "full");
+    }
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    void onDelayedSetup() override {
+        const char* words[] = { "lorem", "ipsum", "dolor", "sit", "amet", "consectetur",
+                                "adipiscing", "elit", "sed", "do", "eiusmod", "tempor" };
+        // One paragraph of words, with no hard line breaks at all
+        SkRandom random;
+        while (fText.size() < 50 * 1024) {
+            fText.append(words[random.nextULessThan(SK_ARRAY_COUNT(words))]);
+            fText.append(" ");
+        }
+
+        fFontCollection = sk_make_sp<FontCollection>();
+        fFontCollection->setDefaultFontManager(SkFontMgr::RefDefault());
+        fParagraphStyle.turnHintingOff();
+        fParagraphStyle.setIncrementalLayout(fIncremental);
+
+        // The first layout of the whole text happens before the editing starts
+        this->build()->layout(kWidth);
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        const size_t middle = fText.size() / 2;
+        for (int i = 0; i < loops; i++) {
+            // Type one more letter (never undo it, which would find the old text in the cache)
+            fText.insert(middle, "x");
+            this->build()->layout(kWidth);
+        }
+    }
+
+    std::unique_ptr<Paragraph> build() {
+        ParagraphBuilderImpl builder(fParagraphStyle, fFontCollection);
+        builder.addText(fText.c_str(), fText.size());
+        return builder.Build();
+    }
+
+    static constexpr SkScalar kWidth = 1000;
+
+    const bool fIncremental;
+    SkString fName;
+    SkString fText;
+    ParagraphStyle fParagraphStyle;
+    sk_sp<FontCollection> fFontCollection;
+};
+
+// A feed: hundreds of short independent paragraphs laid out every frame, on 0 (this thread
+// only) to 8 threads. The paragraph cache is off so every layout shapes its text.
+struct ParagraphBatchBench : public Benchmark {
+    ParagraphBatchBench(int threads) : fThreads(threads) {
+        fName.printf("paragraph_batch_layout_%d_threads", threads);
+    }
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    void onDelayedSetup() override {
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+
+        auto fontCollection = sk_make_sp<FontCollection>();
+        fontCollection->setDefaultFontManager(SkFontMgr::RefDefault());
+        fontCollection->getParagraphCache()->turnOn(false);
+        ParagraphStyle paragraphStyle;
+        paragraphStyle.turnHintingOff();
+
+        const char* words[] = { "lorem", "ipsum", "dolor", "sit", "amet", "consectetur",
+                                "adipiscing", "elit", "sed", "do", "eiusmod", "tempor" };
+        SkRandom random;
+        for (int i = 0; i < kParagraphs; ++i) {
+            SkString text;
+            int count = 10 + random.nextULessThan(40);
+            for (int w = 0; w < count; ++w) {
+                text.append(words[random.nextULessThan(SK_ARRAY_COUNT(words))]);
+                text.append(" ");
+            }
+            ParagraphBuilderImpl builder(paragraphStyle, fontCollection);
+            builder.addText(text.c_str(), text.size());
+            fParagraphs.push_back(builder.Build());
+            fParagraphPtrs.push_back(fParagraphs.back().get());
+            fWidths.push_back(300);
+        }
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            for (auto paragraph : fParagraphPtrs) {
+                paragraph->markDirty();
+            }
+            Paragraph::LayoutAll(SkMakeSpan(fParagraphPtrs), SkMakeSpan(fWidths), fExecutor.get());
+        }
+    }
+
+    static constexpr int kParagraphs = 200;
+
+    const int fThreads;
+    SkString fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    std::vector<std::unique_ptr<Paragraph>> fParagraphs;
+    std::vector<Paragraph*> fParagraphPtrs;
+    std::vector<SkScalar> fWidths;
+};
 }  // namespace
 
+DEF_BENCH(return new ParagraphEditBench(false);)
+DEF_BENCH(return new ParagraphEditBench(true);)
+DEF_BENCH(return new ParagraphBatchBench(0);)
+DEF_BENCH(return new ParagraphBatchBench(1);)
+DEF_BENCH(return new ParagraphBatchBench(2);)
+DEF_BENCH(return new ParagraphBatchBench(4);)
+DEF_BENCH(return new ParagraphBatchBench(8);)
+
 #define PARAGRAPH_BENCH(X) DEF_BENCH(return new ParagraphBench(50000, "text/" #X ".txt", "paragraph_" #X);)
 //PARAGRAPH_BENCH(arabic)
 //PARAGRAPH_BENCH(emoji)
@@ -6,6 +6,7 @@
 #include <set>
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkRefCnt.h"
+#include "include/private/SkMutex.h"
 #include "include/private/SkTHash.h"
 #include "modules/skparagraph/include/ParagraphCache.h"
 #include "modules/skparagraph/include/TextStyle.h"
@@ -15,6 +16,9 @@ namespace textlayout {
 
 class TextStyle;
 class Paragraph;
+
+// Paragraphs on different threads can look up typefaces in the same font collection at once
+// (see Paragraph::LayoutAll), but it must not be configured while any of them is being laid out.
 class FontCollection : public SkRefCnt {
 public:
     FontCollection();
@@ -39,7 +43,9 @@ public:
     void enableFontFallback();
     bool fontFallbackEnabled() { return fEnableFontFallback; }
 
-    ParagraphCache* getParagraphCache() { return &fParagraphCache; }
+    ParagraphCache* getParagraphCache() { return fParagraphCache.get(); }
+    // Shares the cache with other font collections (see ParagraphCache)
+    void setParagraphCache(sk_sp<ParagraphCache> paragraphCache);
 
     void clearCaches();
 
@@ -65,14 +71,17 @@ private:
     };
 
     bool fEnableFontFallback;
-    SkTHashMap<FamilyKey, std::vector<sk_sp<SkTypeface>>, FamilyKey::Hasher> fTypefaces;
+    // Paragraphs laid out on different threads look up their typefaces at the same time
+    SkMutex fTypefacesMutex;
+    SkTHashMap<FamilyKey, std::vector<sk_sp<SkTypeface>>, FamilyKey::Hasher> fTypefaces
+            SK_GUARDED_BY(fTypefacesMutex);
     sk_sp<SkFontMgr> fDefaultFontManager;
     sk_sp<SkFontMgr> fAssetFontManager;
     sk_sp<SkFontMgr> fDynamicFontManager;
     sk_sp<SkFontMgr> fTestFontManager;
 
     std::vector<SkString> fDefaultFamilyNames;
-    ParagraphCache fParagraphCache;
+    sk_sp<ParagraphCache> fParagraphCache;
 };
 }  // namespace textlayout
 }  // namespace skia
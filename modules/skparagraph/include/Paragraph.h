@@ -2,12 +2,14 @@
 #ifndef Paragraph_DEFINED
 #define Paragraph_DEFINED
 
+#include "include/core/SkSpan.h"
 #include "modules/skparagraph/include/FontCollection.h"
 #include "modules/skparagraph/include/Metrics.h"
 #include "modules/skparagraph/include/ParagraphStyle.h"
 #include "modules/skparagraph/include/TextStyle.h"
 
 class SkCanvas;
+class SkExecutor;
 
 namespace skia {
 namespace textlayout {
@@ -37,6 +39,17 @@ public:
 
     virtual void layout(SkScalar width) = 0;
 
+    // Lays out paragraphs[i] to widths[i] for every i, spread over the executor's threads
+    // (or one after another on this thread if executor is null), and returns when all are done.
+    //
+    // Different paragraphs can be laid out at the same time, even when they share a font
+    // collection: FontCollection, its ParagraphCache, SkShaper (HarfBuzz) and SkUnicode (ICU)
+    // lock their shared state. One paragraph must only be used by one thread at a time, and a
+    // font collection must not be configured (font managers, fallback) while it's in use.
+    static void LayoutAll(SkSpan<Paragraph* const> paragraphs,
+                          SkSpan<const SkScalar> widths,
+                          SkExecutor* executor);
+
     virtual void paint(SkCanvas* canvas, SkScalar x, SkScalar y) = 0;
 
     // Returns a vector of bounding boxes that enclose all text between
@@ -2,11 +2,12 @@
 #ifndef ParagraphCache_DEFINED
 #define ParagraphCache_DEFINED
 
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkString.h"
 #include "include/private/SkMutex.h"
-#include "src/core/SkLRUCache.h"
+#include <atomic>
 #include <functional>  // std::function
-
-#define PARAGRAPH_CACHE_STATS
+#include <memory>
 
 namespace skia {
 namespace textlayout {
@@ -27,51 +28,75 @@ class ParagraphCacheValue;
 
 bool operator==(const ParagraphCacheKey& a, const ParagraphCacheKey& b);
 
-class ParagraphCache {
+// Shaping results of paragraphs, keyed by their text and the styles that affect shaping.
+// All the methods are thread safe; entries are spread over shards with a lock each, so
+// paragraphs laid out on different threads rarely wait for each other.
+// One cache can be shared by several font collections (FontCollection::setParagraphCache)
+// as long as they resolve the same font families to the same typefaces.
+class ParagraphCache : public SkRefCnt {
 public:
     ParagraphCache();
-    ~ParagraphCache();
+    ~ParagraphCache() override;
 
     void abandon();
     void reset();
     bool updateParagraph(ParagraphImpl* paragraph);
     bool findParagraph(ParagraphImpl* paragraph);
 
+    // The cache evicts the least recently used paragraphs to keep their (approximate) size
+    // within the budget
+    void setByteBudget(size_t bytes);
+    size_t getByteBudget() const { return fByteBudget.load(std::memory_order_relaxed); }
+
+    struct Stats {
+        int fEntries = 0;
+        size_t fBytes = 0;
+        uint64_t fHits = 0;
+        uint64_t fMisses = 0;
+        uint64_t fInsertions = 0;
+        uint64_t fEvictions = 0;
+    };
+    Stats getStats() const;
+
     // For testing
     void setChecker(std::function<void(ParagraphImpl* impl, const char*, bool)> checker) {
         fChecker = std::move(checker);
     }
     void printStatistics();
     void turnOn(bool value) { fCacheIsOn = value; }
-    int count() { return fLRUCacheMap.count(); }
+    int count() const { return this->getStats().fEntries; }
 
     bool isPossiblyTextEditing(ParagraphImpl* paragraph);
 
  private:
 
     struct Entry;
-    void updateFrom(const ParagraphImpl* paragraph, Entry* entry);
+    struct Shard;
     void updateTo(ParagraphImpl* paragraph, const Entry* entry);
+    int shardIndex(const ParagraphCacheKey& key) const;
+    void purgeAsNeeded(int firstShard);
+    bool overBudget() const {
+        return fTotalBytes.load(std::memory_order_relaxed) > this->getByteBudget();
+    }
 
-     mutable SkMutex fParagraphMutex;
-     std::function<void(ParagraphImpl* impl, const char*, bool)> fChecker;
-
-    static const int kMaxEntries = 128;
+    static constexpr size_t kDefaultByteBudget = 4 * 1024 * 1024;
+    static constexpr int kShardCount = 16;
 
-    struct KeyHash {
-        uint32_t mix(uint32_t hash, uint32_t data) const;
-        uint32_t operator()(const ParagraphCacheKey& key) const;
-    };
+    std::unique_ptr<Shard[]> fShards;
+    std::function<void(ParagraphImpl* impl, const char*, bool)> fChecker;
+    std::atomic<size_t> fByteBudget;
+    std::atomic<size_t> fTotalBytes;
+    std::atomic<bool> fCacheIsOn;
 
-    SkLRUCache<ParagraphCacheKey, std::unique_ptr<Entry>, KeyHash> fLRUCacheMap;
-    bool fCacheIsOn;
-    ParagraphCacheValue* fLastCachedValue;
+    // The start and the end of the text last added to the cache
+    mutable SkMutex fLastCachedMutex;
+    SkString fLastCachedPrefix SK_GUARDED_BY(fLastCachedMutex);
+    SkString fLastCachedSuffix SK_GUARDED_BY(fLastCachedMutex);
 
-#ifdef PARAGRAPH_CACHE_STATS
-    int fTotalRequests;
-    int fCacheMisses;
-    int fHashMisses; // cache hit but hash table missed
-#endif
+    std::atomic<uint64_t> fHits;
+    std::atomic<uint64_t> fMisses;
+    std::atomic<uint64_t> fInsertions;
+    std::atomic<uint64_t> fEvictions;
 };
 
 }  // namespace textlayout
@@ -122,6 +122,12 @@ struct ParagraphStyle {
     DrawOptions getDrawOptions() { return fDrawingOptions; }
     void setDrawOptions(DrawOptions value) { fDrawingOptions = value; }
 
+    // Shape long text in pieces split at hard line breaks (and, in left-to-right text, between
+    // words), caching each piece on its own, so that after an edit only the pieces around it have
+    // to be shaped again
+    bool getIncrementalLayout() const { return fIncrementalLayout; }
+    void setIncrementalLayout(bool value) { fIncrementalLayout = value; }
+
 private:
     StrutStyle fStrutStyle;
     TextStyle fDefaultTextStyle;
@@ -134,6 +140,7 @@ private:
     TextHeightBehavior fTextHeightBehavior;
     bool fHintingIsOn;
     DrawOptions fDrawingOptions = DrawOptions::kDirect;
+    bool fIncrementalLayout = false;
 };
 }  // namespace textlayout
 }  // namespace skia
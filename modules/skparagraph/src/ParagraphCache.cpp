@@ -1,8 +1,10 @@
 // Copyright 2019 Google LLC.
 #include <memory>
 
+#include "include/private/SkTHash.h"
 #include "modules/skparagraph/include/ParagraphCache.h"
 #include "modules/skparagraph/src/ParagraphImpl.h"
+#include "src/core/SkTInternalLList.h"
 
 namespace skia {
 namespace textlayout {
@@ -21,6 +23,13 @@ namespace {
     bool exactlyEqual(SkScalar x, SkScalar y) {
         return x == y || (x != x && y != y);
     }
+
+    uint32_t mix(uint32_t hash, uint32_t data) {
+        hash += data;
+        hash += (hash << 10);
+        hash ^= (hash >> 6);
+        return hash;
+    }
 }  // namespace
 
 class ParagraphCacheKey {
@@ -29,12 +38,20 @@ public:
         : fText(paragraph->fText.c_str(), paragraph->fText.size())
         , fPlaceholders(paragraph->fPlaceholders)
         , fTextStyles(paragraph->fTextStyles)
-        , fParagraphStyle(paragraph->paragraphStyle()) { }
+        , fParagraphStyle(paragraph->paragraphStyle())
+        , fHash(this->computeHash()) { }
+
+    uint32_t hash() const { return fHash; }
 
     SkString fText;
     SkTArray<Placeholder, true> fPlaceholders;
     SkTArray<Block, true> fTextStyles;
     ParagraphStyle fParagraphStyle;
+
+private:
+    uint32_t computeHash() const;
+
+    uint32_t fHash;
 };
 
 class ParagraphCacheValue {
@@ -59,18 +76,30 @@ public:
     std::vector<SkUnicode::BidiRegion> fBidiRegions;
     SkTArray<TextIndex, true> fUTF8IndexForUTF16Index;
     SkTArray<size_t, true> fUTF16IndexForUTF8Index;
-};
 
-uint32_t ParagraphCache::KeyHash::mix(uint32_t hash, uint32_t data) const {
-    hash += data;
-    hash += (hash << 10);
-    hash ^= (hash >> 6);
-    return hash;
-}
+    // Counts the memory the value holds on to (close enough to keep the cache within its budget)
+    size_t approximateBytes() const {
+        size_t bytes = sizeof(ParagraphCacheValue) + fKey.fText.size() +
+                       fKey.fPlaceholders.size() * sizeof(Placeholder) +
+                       fKey.fTextStyles.size() * sizeof(Block);
+        for (auto& run : fRuns) {
+            // Glyphs, positions, bounds, cluster indexes and shifts
+            bytes += sizeof(Run) + run.size() * (sizeof(SkGlyphID) + sizeof(SkPoint) +
+                                                 sizeof(SkRect) + sizeof(uint32_t) +
+                                                 sizeof(SkScalar));
+        }
+        bytes += fCodeUnitProperties.size() * sizeof(CodeUnitFlags) +
+                 fWords.size() * sizeof(size_t) +
+                 fBidiRegions.size() * sizeof(SkUnicode::BidiRegion) +
+                 fUTF8IndexForUTF16Index.size() * sizeof(TextIndex) +
+                 fUTF16IndexForUTF8Index.size() * sizeof(size_t);
+        return bytes;
+    }
+};
 
-uint32_t ParagraphCache::KeyHash::operator()(const ParagraphCacheKey& key) const {
+uint32_t ParagraphCacheKey::computeHash() const {
     uint32_t hash = 0;
-    for (auto& ph : key.fPlaceholders) {
+    for (auto& ph : fPlaceholders) {
         if (ph.fRange.width() == 0) {
             continue;
         }
@@ -85,7 +114,7 @@ uint32_t ParagraphCache::KeyHash::operator()(const ParagraphCacheKey& key) const
         }
     }
 
-    for (auto& ts : key.fTextStyles) {
+    for (auto& ts : fTextStyles) {
         if (ts.fStyle.isPlaceholder()) {
             continue;
         }
@@ -105,10 +134,10 @@ uint32_t ParagraphCache::KeyHash::operator()(const ParagraphCacheKey& key) const
         hash = mix(hash, SkGoodHash()(ts.fRange));
     }
 
-    hash = mix(hash, SkGoodHash()(relax(key.fParagraphStyle.getHeight())));
-    hash = mix(hash, SkGoodHash()(key.fParagraphStyle.getTextDirection()));
+    hash = mix(hash, SkGoodHash()(relax(fParagraphStyle.getHeight())));
+    hash = mix(hash, SkGoodHash()(fParagraphStyle.getTextDirection()));
 
-    auto& strutStyle = key.fParagraphStyle.getStrutStyle();
+    auto& strutStyle = fParagraphStyle.getStrutStyle();
     if (strutStyle.getStrutEnabled()) {
         hash = mix(hash, SkGoodHash()(relax(strutStyle.getHeight())));
         hash = mix(hash, SkGoodHash()(relax(strutStyle.getLeading())));
@@ -121,11 +150,14 @@ uint32_t ParagraphCache::KeyHash::operator()(const ParagraphCacheKey& key) const
         }
     }
 
-    hash = mix(hash, SkGoodHash()(key.fText));
+    hash = mix(hash, SkGoodHash()(fText));
     return hash;
 }
 
 bool operator==(const ParagraphCacheKey& a, const ParagraphCacheKey& b) {
+    if (a.hash() != b.hash()) {
+        return false;
+    }
     if (a.fText.size() != b.fText.size()) {
         return false;
     }
@@ -187,26 +219,75 @@ bool operator==(const ParagraphCacheKey& a, const ParagraphCacheKey& b) {
     return true;
 }
 
+// Texts this long that start or end the same as the last cached text are likely being edited
+#define NOCACHE_PREFIX_LENGTH 40
+
 struct ParagraphCache::Entry {
 
-    Entry(ParagraphCacheValue* value) : fValue(value) {}
+    Entry(ParagraphCacheValue* value, size_t bytes) : fValue(value), fBytes(bytes) {}
     std::unique_ptr<ParagraphCacheValue> fValue;
+    size_t fBytes;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
+};
+
+// One shard holds the paragraphs whose keys hash to it, least recently used last
+struct ParagraphCache::Shard {
+    ~Shard() {
+        SkAutoMutexExclusive lock(fMutex);
+        this->reset();
+    }
+
+    // Returns the number of bytes freed
+    size_t reset() SK_REQUIRES(fMutex) {
+        size_t bytes = 0;
+        fMap.reset();
+        while (Entry* entry = fLRU.head()) {
+            bytes += entry->fBytes;
+            fLRU.remove(entry);
+            delete entry;
+        }
+        return bytes;
+    }
+
+    size_t remove(Entry* entry) SK_REQUIRES(fMutex) {
+        size_t bytes = entry->fBytes;
+        fMap.remove(entry->fValue->fKey);
+        fLRU.remove(entry);
+        delete entry;
+        return bytes;
+    }
+
+    struct Traits {
+        static bool isValid(const Entry* entry) { return entry != nullptr; }
+        static const ParagraphCacheKey& GetKey(Entry* entry) { return entry->fValue->fKey; }
+        static uint32_t Hash(const ParagraphCacheKey& key) { return key.hash(); }
+    };
+
+    SkMutex fMutex;
+    SkTHashTable<Entry*, ParagraphCacheKey, Traits> fMap SK_GUARDED_BY(fMutex);
+    SkTInternalLList<Entry> fLRU SK_GUARDED_BY(fMutex);
 };
 
 ParagraphCache::ParagraphCache()
-    : fChecker([](ParagraphImpl* impl, const char*, bool){ })
-    , fLRUCacheMap(kMaxEntries)
+    : fShards(new Shard[kShardCount])
+    , fChecker([](ParagraphImpl* impl, const char*, bool){ })
+    , fByteBudget(kDefaultByteBudget)
+    , fTotalBytes(0)
     , fCacheIsOn(true)
-    , fLastCachedValue(nullptr)
-#ifdef PARAGRAPH_CACHE_STATS
-    , fTotalRequests(0)
-    , fCacheMisses(0)
-    , fHashMisses(0)
-#endif
+    , fHits(0)
+    , fMisses(0)
+    , fInsertions(0)
+    , fEvictions(0)
 { }
 
 ParagraphCache::~ParagraphCache() { }
 
+int ParagraphCache::shardIndex(const ParagraphCacheKey& key) const {
+    // The low bits pick the slot within the shard's table
+    return (key.hash() >> 24) % kShardCount;
+}
+
 void ParagraphCache::updateTo(ParagraphImpl* paragraph, const Entry* entry) {
 
     paragraph->fRuns.reset();
@@ -221,13 +302,30 @@ void ParagraphCache::updateTo(ParagraphImpl* paragraph, const Entry* entry) {
     }
 }
 
+ParagraphCache::Stats ParagraphCache::getStats() const {
+    Stats stats;
+    for (int i = 0; i < kShardCount; ++i) {
+        Shard& shard = fShards[i];
+        SkAutoMutexExclusive lock(shard.fMutex);
+        stats.fEntries += shard.fMap.count();
+    }
+    stats.fBytes = fTotalBytes.load(std::memory_order_relaxed);
+    stats.fHits = fHits.load(std::memory_order_relaxed);
+    stats.fMisses = fMisses.load(std::memory_order_relaxed);
+    stats.fInsertions = fInsertions.load(std::memory_order_relaxed);
+    stats.fEvictions = fEvictions.load(std::memory_order_relaxed);
+    return stats;
+}
+
 void ParagraphCache::printStatistics() {
+    auto stats = this->getStats();
+    auto requests = stats.fHits + stats.fMisses;
     SkDebugf("--- Paragraph Cache ---\n");
-    SkDebugf("Total requests: %d\n", fTotalRequests);
-    SkDebugf("Cache misses: %d\n", fCacheMisses);
-    SkDebugf("Cache miss %%: %f\n", (fTotalRequests > 0) ? 100.f * fCacheMisses / fTotalRequests : 0.f);
-    int cacheHits = fTotalRequests - fCacheMisses;
-    SkDebugf("Hash miss %%: %f\n", (cacheHits > 0) ? 100.f * fHashMisses / cacheHits : 0.f);
+    SkDebugf("Entries: %d (%zu bytes of %zu)\n", stats.fEntries, stats.fBytes, this->getByteBudget());
+    SkDebugf("Total requests: %llu\n", (unsigned long long)requests);
+    SkDebugf("Cache misses: %llu\n", (unsigned long long)stats.fMisses);
+    SkDebugf("Cache miss %%: %f\n", (requests > 0) ? 100.f * stats.fMisses / requests : 0.f);
+    SkDebugf("Evictions: %llu\n", (unsigned long long)stats.fEvictions);
     SkDebugf("---------------------\n");
 }
 
@@ -236,36 +334,62 @@ void ParagraphCache::abandon() {
 }
 
 void ParagraphCache::reset() {
-    SkAutoMutexExclusive lock(fParagraphMutex);
-#ifdef PARAGRAPH_CACHE_STATS
-    fTotalRequests = 0;
-    fCacheMisses = 0;
-    fHashMisses = 0;
-#endif
-    fLRUCacheMap.reset();
-    fLastCachedValue = nullptr;
+    for (int i = 0; i < kShardCount; ++i) {
+        Shard& shard = fShards[i];
+        SkAutoMutexExclusive lock(shard.fMutex);
+        fTotalBytes -= shard.reset();
+    }
+    {
+        SkAutoMutexExclusive lock(fLastCachedMutex);
+        fLastCachedPrefix.reset();
+        fLastCachedSuffix.reset();
+    }
+    fHits = 0;
+    fMisses = 0;
+    fInsertions = 0;
+    fEvictions = 0;
+}
+
+void ParagraphCache::setByteBudget(size_t bytes) {
+    fByteBudget = bytes;
+    this->purgeAsNeeded(0);
+}
+
+// Evicts the least recently used paragraphs of every shard in turn (starting from the given one,
+// which the caller has already purged as far as it could) until the cache fits in its budget.
+// The order within the cache is only approximately LRU, but no lock is held for long.
+void ParagraphCache::purgeAsNeeded(int firstShard) {
+    for (int i = 0; i < kShardCount && this->overBudget(); ++i) {
+        Shard& shard = fShards[(firstShard + i) % kShardCount];
+        SkAutoMutexExclusive lock(shard.fMutex);
+        while (this->overBudget() && shard.fLRU.tail() != nullptr) {
+            fTotalBytes -= shard.remove(shard.fLRU.tail());
+            fEvictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
 }
 
 bool ParagraphCache::findParagraph(ParagraphImpl* paragraph) {
     if (!fCacheIsOn) {
         return false;
     }
-#ifdef PARAGRAPH_CACHE_STATS
-    ++fTotalRequests;
-#endif
-    SkAutoMutexExclusive lock(fParagraphMutex);
     ParagraphCacheKey key(paragraph);
-    std::unique_ptr<Entry>* entry = fLRUCacheMap.find(key);
+    Shard& shard = fShards[this->shardIndex(key)];
+    SkAutoMutexExclusive lock(shard.fMutex);
+    Entry** entry = shard.fMap.find(key);
 
     if (!entry) {
         // We have a cache miss
-#ifdef PARAGRAPH_CACHE_STATS
-        ++fCacheMisses;
-#endif
+        fMisses.fetch_add(1, std::memory_order_relaxed);
         fChecker(paragraph, "missingParagraph", true);
         return false;
     }
-    updateTo(paragraph, entry->get());
+    fHits.fetch_add(1, std::memory_order_relaxed);
+    if (*entry != shard.fLRU.head()) {
+        shard.fLRU.remove(*entry);
+        shard.fLRU.addToHead(*entry);
+    }
+    updateTo(paragraph, *entry);
     fChecker(paragraph, "foundParagraph", true);
     return true;
 }
@@ -274,51 +398,74 @@ bool ParagraphCache::updateParagraph(ParagraphImpl* paragraph) {
     if (!fCacheIsOn) {
         return false;
     }
-#ifdef PARAGRAPH_CACHE_STATS
-    ++fTotalRequests;
-#endif
-    SkAutoMutexExclusive lock(fParagraphMutex);
+    // isTooMuchMemoryWasted(paragraph) not needed for now
+    if (isPossiblyTextEditing(paragraph)) {
+        // Skip this paragraph
+        return false;
+    }
 
-    ParagraphCacheKey key(paragraph);
-    std::unique_ptr<Entry>* entry = fLRUCacheMap.find(key);
-    if (!entry) {
-        // isTooMuchMemoryWasted(paragraph) not needed for now
-        if (isPossiblyTextEditing(paragraph)) {
-            // Skip this paragraph
+    // Copy the results before taking the lock
+    auto value = std::make_unique<ParagraphCacheValue>(paragraph);
+    auto bytes = value->approximateBytes();
+    if (bytes > this->getByteBudget() / 2) {
+        // It would push (almost) everything else out
+        return false;
+    }
+
+    int index = this->shardIndex(value->fKey);
+    {
+        Shard& shard = fShards[index];
+        SkAutoMutexExclusive lock(shard.fMutex);
+        if (shard.fMap.find(value->fKey)) {
+            // We do not have to update the paragraph
             return false;
         }
-        ParagraphCacheValue* value = new ParagraphCacheValue(paragraph);
-        fLRUCacheMap.insert(key, std::make_unique<Entry>(value));
+
+        {
+            SkAutoMutexExclusive lastLock(fLastCachedMutex);
+            auto& text = value->fKey.fText;
+            auto length = std::min<size_t>(text.size(), NOCACHE_PREFIX_LENGTH);
+            fLastCachedPrefix.set(text.c_str(), length);
+            fLastCachedSuffix.set(text.c_str() + text.size() - length, length);
+        }
+
+        auto entry = new Entry(value.release(), bytes);
+        shard.fMap.set(entry);
+        shard.fLRU.addToHead(entry);
+        fTotalBytes += bytes;
+        fInsertions.fetch_add(1, std::memory_order_relaxed);
         fChecker(paragraph, "addedParagraph", true);
-        fLastCachedValue = value;
-        return true;
-    } else {
-        // We do not have to update the paragraph
-        return false;
+
+        // Make room in this shard first (but keep the new paragraph), then in the others
+        while (this->overBudget() && shard.fLRU.tail() != entry) {
+            fTotalBytes -= shard.remove(shard.fLRU.tail());
+            fEvictions.fetch_add(1, std::memory_order_relaxed);
+        }
     }
+    this->purgeAsNeeded((index + 1) % kShardCount);
+    return true;
 }
 
 // Special situation: (very) long paragraph that is close to the last formatted paragraph
-#define NOCACHE_PREFIX_LENGTH 40
 bool ParagraphCache::isPossiblyTextEditing(ParagraphImpl* paragraph) {
-    if (fLastCachedValue == nullptr) {
+    auto& text = paragraph->fText;
+    if (text.size() < NOCACHE_PREFIX_LENGTH) {
+        // The current text is too short
         return false;
     }
 
-    auto& lastText = fLastCachedValue->fKey.fText;
-    auto& text = paragraph->fText;
-
-    if ((lastText.size() < NOCACHE_PREFIX_LENGTH) || (text.size() < NOCACHE_PREFIX_LENGTH)) {
-        // Either last text or the current are too short
+    SkAutoMutexExclusive lock(fLastCachedMutex);
+    if (fLastCachedPrefix.size() < NOCACHE_PREFIX_LENGTH) {
+        // Either there is no last text or it is too short
         return false;
     }
 
-    if (std::strncmp(lastText.c_str(), text.c_str(), NOCACHE_PREFIX_LENGTH) == 0) {
+    if (std::strncmp(fLastCachedPrefix.c_str(), text.c_str(), NOCACHE_PREFIX_LENGTH) == 0) {
         // Texts have the same starts
         return true;
     }
 
-    if (std::strncmp(&lastText[lastText.size() - NOCACHE_PREFIX_LENGTH], &text[text.size() - NOCACHE_PREFIX_LENGTH], NOCACHE_PREFIX_LENGTH) == 0) {
+    if (std::strncmp(fLastCachedSuffix.c_str(), &text[text.size() - NOCACHE_PREFIX_LENGTH], NOCACHE_PREFIX_LENGTH) == 0) {
         // Texts have the same ends
         return true;
     }
@@ -6,6 +6,7 @@
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkSpan.h"
 #include "include/core/SkTypeface.h"
+#include "include/private/SkOpts_spi.h"
 #include "include/private/SkTFitsIn.h"
 #include "include/private/SkTo.h"
 #include "modules/skparagraph/include/Metrics.h"
@@ -17,6 +18,7 @@
 #include "modules/skparagraph/src/Run.h"
 #include "modules/skparagraph/src/TextLine.h"
 #include "modules/skparagraph/src/TextWrapper.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/utils/SkUTF.h"
 #include <math.h>
 #include <algorithm>
@@ -61,6 +63,24 @@ Paragraph::Paragraph(ParagraphStyle style, sk_sp<FontCollection> fonts)
             , fExceededMaxLines(0)
 { }
 
+void Paragraph::LayoutAll(SkSpan<Paragraph* const> paragraphs,
+                          SkSpan<const SkScalar> widths,
+                          SkExecutor* executor) {
+    SkASSERT(paragraphs.size() == widths.size());
+    if (executor == nullptr) {
+        for (size_t i = 0; i < paragraphs.size(); ++i) {
+            paragraphs[i]->layout(widths[i]);
+        }
+        return;
+    }
+
+    SkTaskGroup taskGroup(*executor);
+    taskGroup.batch(SkToInt(paragraphs.size()), [&](int i) {
+        paragraphs[i]->layout(widths[i]);
+    });
+    taskGroup.wait();
+}
+
 ParagraphImpl::ParagraphImpl(const SkString& text,
                              ParagraphStyle style,
                              SkTArray<Block, true> blocks,
@@ -484,6 +504,13 @@ bool ParagraphImpl::shapeTextIntoEndlessLine() {
         return true;
     }
 
+    if (fParagraphStyle.getIncrementalLayout()) {
+        auto segments = this->findShapingSegments();
+        if (segments.size() > 1) {
+            return this->shapeTextBySegments(segments);
+        }
+    }
+
     if (!computeCodeUnitProperties()) {
         return false;
     }
@@ -510,6 +537,136 @@ bool ParagraphImpl::shapeTextIntoEndlessLine() {
     }
 }
 
+static bool is_ascii_alnum(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+// Splits the text into segments that can each be shaped on their own. Nothing is shaped across a
+// hard line break, nor across the spaces before a word as long as bidi resolves those spaces the
+// same way at the end of a segment: true when all of the text is left-to-right. Words only count
+// when they start with an ASCII letter or digit, which can't combine with the space before them.
+// Which boundaries end a segment depends on the text just before them rather than on where the
+// segment started, so after an edit the segments fall back into the same places soon after it,
+// and only the segments around the edit have new text.
+std::vector<TextRange> ParagraphImpl::findShapingSegments() const {
+    static constexpr size_t kMinSegmentSize = 512;
+    static constexpr size_t kMaxSegmentSize = 4096;
+    static constexpr size_t kBreakHashWindow = 16;
+    static constexpr uint32_t kBoundariesPerSegmentBreak = 32;
+
+    std::vector<TextRange> segments;
+    // Placeholders are shaped in between the text, so leave them to the whole paragraph
+    if (fPlaceholders.size() > 1) {
+        return segments;
+    }
+
+    std::vector<SkUnicode::BidiRegion> bidiRegions;
+    const bool splitWords =
+            fParagraphStyle.getTextDirection() == TextDirection::kLtr &&
+            fUnicode->getBidiRegions(fText.c_str(), fText.size(),
+                                     SkUnicode::TextDirection::kLTR, &bidiRegions) &&
+            bidiRegions.size() == 1 && bidiRegions[0].level == 0;
+
+    const char* text = fText.c_str();
+    size_t start = 0;
+    for (size_t i = 1; i < fText.size(); ++i) {
+        bool boundary = text[i - 1] == '\n' ||
+                        (splitWords && text[i - 1] == ' ' && is_ascii_alnum(text[i]));
+        if (!boundary) {
+            continue;
+        }
+        auto size = i - start;
+        if (size < kMinSegmentSize) {
+            continue;
+        }
+        auto hash = SkOpts::hash_fn(text + i - kBreakHashWindow, kBreakHashWindow, 0);
+        if (hash % kBoundariesPerSegmentBreak == 0 || size >= kMaxSegmentSize) {
+            segments.emplace_back(start, i);
+            start = i;
+        }
+    }
+    if (start < fText.size()) {
+        segments.emplace_back(start, fText.size());
+    }
+    return segments;
+}
+
+// Shapes every segment as a paragraph of its own, which lets the paragraph cache find the
+// segments that have not changed since the last layout, and then stitches the results together
+bool ParagraphImpl::shapeTextBySegments(const std::vector<TextRange>& segments) {
+
+    auto style = fParagraphStyle;
+    style.setIncrementalLayout(false);
+
+    fFontSwitches.reset();
+    fUnresolvedGlyphs = 0;
+    SkScalar advanceX = 0;
+    // The pieces borrow this paragraph's SkUnicode rather than each making their own
+    std::unique_ptr<SkUnicode> unicode = std::move(fUnicode);
+    for (auto segment : segments) {
+        SkTArray<Block, true> blocks;
+        for (auto& block : fTextStyles) {
+            auto text = block.fRange * segment;
+            if (text.width() > 0) {
+                blocks.emplace_back(text.start - segment.start, text.end - segment.start, block.fStyle);
+            }
+        }
+        SkTArray<Placeholder, true> placeholders;
+        placeholders.emplace_back(segment.width(), segment.width(), PlaceholderStyle(),
+                                  fPlaceholders.back().fTextStyle, BlockRange(0, blocks.size()),
+                                  TextRange(0, segment.width()));
+
+        ParagraphImpl piece(SkString(fText.c_str() + segment.start, segment.width()), style,
+                            std::move(blocks), std::move(placeholders), fFontCollection,
+                            std::move(unicode));
+        piece.fCodeUnitProperties.push_back_n(segment.width() + 1, kNoCodeUnitFlag);
+        bool shaped = piece.shapeTextIntoEndlessLine();
+        unicode = std::move(piece.fUnicode);
+        if (!shaped) {
+            fUnicode = std::move(unicode);
+            return false;
+        }
+
+        // Move everything by the segment start (and its runs by the width of the text before it)
+        SkScalar segmentEnd = advanceX;
+        for (auto& pieceRun : piece.fRuns) {
+            auto& run = fRuns.emplace_back(pieceRun);
+            run.setOwner(this);
+            run.fIndex = fRuns.size() - 1;
+            run.fTextRange = TextRange(pieceRun.fTextRange.start + segment.start,
+                                       pieceRun.fTextRange.end + segment.start);
+            run.fClusterStart += segment.start;
+            run.fOffset.fX += advanceX;
+            for (auto& position : run.fPositions) {
+                position.fX += advanceX;
+            }
+            segmentEnd = std::max(segmentEnd, run.fOffset.fX + run.fAdvance.fX);
+        }
+        advanceX = segmentEnd;
+
+        for (size_t i = 0; i <= segment.width(); ++i) {
+            auto flags = piece.fCodeUnitProperties[i];
+            if (i == 0 && segment.start > 0) {
+                // The segment start already has the break the segment before ended with,
+                // not the soft one at the start of text
+                flags &= ~kSoftLineBreakBefore;
+            }
+            fCodeUnitProperties[segment.start + i] |= flags;
+        }
+        for (auto& region : piece.fBidiRegions) {
+            fBidiRegions.emplace_back(region.start + segment.start, region.end + segment.start,
+                                      region.level);
+        }
+        for (auto& fontSwitch : piece.fFontSwitches) {
+            fFontSwitches.emplace_back(fontSwitch.fTextStart + segment.start, fontSwitch.fFont);
+        }
+        fUnresolvedGlyphs += piece.fUnresolvedGlyphs;
+    }
+    fUnicode = std::move(unicode);
+
+    return true;
+}
+
 void ParagraphImpl::breakShapedTextIntoLines(SkScalar maxWidth) {
     TextWrapper textWrapper;
     textWrapper.breakTextIntoLines(
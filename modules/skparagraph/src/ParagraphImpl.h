@@ -196,6 +196,8 @@ public:
     void buildClusterTable();
     void spaceGlyphs();
     bool shapeTextIntoEndlessLine();
+    std::vector<TextRange> findShapingSegments() const;
+    bool shapeTextBySegments(const std::vector<TextRange>& segments);
     void breakShapedTextIntoLines(SkScalar maxWidth);
     void paintLinesIntoPicture(SkScalar x, SkScalar y);
     void paintLines(SkCanvas* canvas, SkScalar x, SkScalar y);
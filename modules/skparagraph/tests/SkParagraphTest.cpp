@@ -3,6 +3,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkImageEncoder.h"
@@ -5107,6 +5108,60 @@ DEF_TEST(SkParagraph_CacheStyles, reporter) {
     test(2, false);
 }
 
+DEF_TEST(SkParagraph_CacheBudget, reporter) {
+    auto cache = sk_make_sp<ParagraphCache>();
+    sk_sp<ResourceFontCollection> fontCollection1 = sk_make_sp<ResourceFontCollection>();
+    if (!fontCollection1->fontsFound()) return;
+    sk_sp<ResourceFontCollection> fontCollection2 = sk_make_sp<ResourceFontCollection>();
+    fontCollection1->setParagraphCache(cache);
+    fontCollection2->setParagraphCache(cache);
+
+    ParagraphStyle paragraph_style;
+    paragraph_style.turnHintingOff();
+
+    TextStyle text_style;
+    text_style.setFontFamilies({SkString("Roboto")});
+    text_style.setColor(SK_ColorBLACK);
+
+    auto layout = [&](sk_sp<FontCollection> fontCollection, const char* text) {
+        ParagraphBuilderImpl builder(paragraph_style, fontCollection);
+        builder.pushStyle(text_style);
+        builder.addText(text, strlen(text));
+        builder.pop();
+        auto paragraph = builder.Build();
+        paragraph->layout(TestCanvasWidth);
+    };
+
+    // Both font collections use the same cache
+    layout(fontCollection1, "Shared text");
+    layout(fontCollection2, "Shared text");
+    auto stats = cache->getStats();
+    REPORTER_ASSERT(reporter, stats.fEntries == 1);
+    REPORTER_ASSERT(reporter, stats.fHits == 1);
+    REPORTER_ASSERT(reporter, stats.fMisses == 1);
+    REPORTER_ASSERT(reporter, stats.fInsertions == 1);
+    REPORTER_ASSERT(reporter, stats.fBytes > 0);
+
+    // Room for about three paragraphs like that
+    auto budget = stats.fBytes * 3;
+    cache->setByteBudget(budget);
+    for (int i = 0; i < 10; ++i) {
+        SkString text;
+        text.printf("Text number %d", i);
+        layout(fontCollection1, text.c_str());
+        REPORTER_ASSERT(reporter, cache->getStats().fBytes <= budget);
+    }
+    stats = cache->getStats();
+    REPORTER_ASSERT(reporter, stats.fInsertions == 11);
+    REPORTER_ASSERT(reporter, stats.fEvictions > 0);
+    REPORTER_ASSERT(reporter, stats.fEntries == SkToInt(stats.fInsertions - stats.fEvictions));
+
+    // Shrinking the budget evicts right away
+    cache->setByteBudget(0);
+    REPORTER_ASSERT(reporter, cache->count() == 0);
+    REPORTER_ASSERT(reporter, cache->getStats().fBytes == 0);
+}
+
 DEF_TEST(SkParagraph_EmptyParagraphWithLineBreak, reporter) {
     sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
     if (!fontCollection->fontsFound()) return;
@@ -6214,3 +6269,139 @@ DEF_TEST(SkParagraph_RTLGlyphPositionsInEmptyLines, reporter) {
     auto res3 = paragraph->getGlyphPositionAtCoordinate(0, height);
     REPORTER_ASSERT(reporter, res3.position == 10 && res3.affinity == Affinity::kUpstream);
 }
+
+DEF_TEST(SkParagraph_IncrementalLayout, reporter) {
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    if (!fontCollection->fontsFound()) return;
+    sk_sp<ResourceFontCollection> uncachedCollection = sk_make_sp<ResourceFontCollection>();
+    uncachedCollection->getParagraphCache()->turnOn(false);
+
+    TextStyle text_style;
+    text_style.setFontFamilies({SkString("Roboto")});
+    text_style.setFontSize(20);
+    text_style.setColor(SK_ColorBLACK);
+
+    // Numbers at both ends keep the paragraph cache from taking the lines for edits of each other
+    SkString text;
+    auto makeText = [&](const char* separator) {
+        text.reset();
+        for (int i = 0; i < 200; ++i) {
+            text.appendf("%d: The quick brown fox jumps over the lazy dog %d%s", i, i, separator);
+        }
+    };
+
+    auto layout = [&](sk_sp<FontCollection> collection, bool incremental) {
+        ParagraphStyle paragraph_style;
+        paragraph_style.turnHintingOff();
+        paragraph_style.setIncrementalLayout(incremental);
+        ParagraphBuilderImpl builder(paragraph_style, collection);
+        builder.pushStyle(text_style);
+        builder.addText(text.c_str(), text.size());
+        builder.pop();
+        auto paragraph = builder.Build();
+        paragraph->layout(TestCanvasWidth);
+        return paragraph;
+    };
+
+    auto compare = [&](Paragraph* incremental, Paragraph* full) {
+        REPORTER_ASSERT(reporter, incremental->lineNumber() == full->lineNumber());
+        REPORTER_ASSERT(reporter, incremental->getHeight() == full->getHeight());
+        REPORTER_ASSERT(reporter, SkScalarNearlyEqual(incremental->getMaxIntrinsicWidth(),
+                                                      full->getMaxIntrinsicWidth()));
+
+        std::vector<LineMetrics> incrementalLines, fullLines;
+        incremental->getLineMetrics(incrementalLines);
+        full->getLineMetrics(fullLines);
+        REPORTER_ASSERT(reporter, incrementalLines.size() == fullLines.size());
+        for (size_t i = 0; i < std::min(incrementalLines.size(), fullLines.size()); ++i) {
+            REPORTER_ASSERT(reporter, incrementalLines[i].fStartIndex == fullLines[i].fStartIndex);
+            REPORTER_ASSERT(reporter, incrementalLines[i].fEndIndex == fullLines[i].fEndIndex);
+            REPORTER_ASSERT(reporter, SkScalarNearlyEqual(incrementalLines[i].fWidth,
+                                                          fullLines[i].fWidth));
+        }
+
+        // Select text across many segments
+        auto incrementalRects = incremental->getRectsForRange(
+                10, text.size() - 10, RectHeightStyle::kTight, RectWidthStyle::kTight);
+        auto fullRects = full->getRectsForRange(
+                10, text.size() - 10, RectHeightStyle::kTight, RectWidthStyle::kTight);
+        REPORTER_ASSERT(reporter, incrementalRects.size() == fullRects.size());
+        for (size_t i = 0; i < std::min(incrementalRects.size(), fullRects.size()); ++i) {
+            REPORTER_ASSERT(reporter, SkScalarNearlyEqual(incrementalRects[i].rect.fLeft,
+                                                          fullRects[i].rect.fLeft));
+            REPORTER_ASSERT(reporter, SkScalarNearlyEqual(incrementalRects[i].rect.fRight,
+                                                          fullRects[i].rect.fRight));
+            REPORTER_ASSERT(reporter, incrementalRects[i].rect.fTop == fullRects[i].rect.fTop);
+        }
+    };
+
+    // Lines, and a single line that can only be split between words
+    auto cache = fontCollection->getParagraphCache();
+    for (const char* separator : {"\n", " "}) {
+        cache->reset();
+        makeText(separator);
+        compare(layout(fontCollection, true).get(), layout(uncachedCollection, false).get());
+        auto segments = cache->count();
+        REPORTER_ASSERT(reporter, segments > 1);
+
+        // Type a word into the middle: the whole paragraph is missing from the cache, and so are
+        // the segments around the edit, but not the rest of them
+        int missing = 0;
+        cache->setChecker([&](ParagraphImpl*, const char* event, bool) {
+            if (std::strcmp(event, "missingParagraph") == 0) {
+                ++missing;
+            }
+        });
+        text.insert(text.size() / 2, "typed ");
+        compare(layout(fontCollection, true).get(), layout(uncachedCollection, false).get());
+        REPORTER_ASSERT(reporter, missing >= 2 && missing < segments);
+        cache->setChecker([](ParagraphImpl*, const char*, bool) { });
+    }
+}
+
+DEF_TEST(SkParagraph_LayoutAll, reporter) {
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    if (!fontCollection->fontsFound()) return;
+    sk_sp<ResourceFontCollection> serialCollection = sk_make_sp<ResourceFontCollection>();
+    serialCollection->getParagraphCache()->turnOn(false);
+
+    ParagraphStyle paragraph_style;
+    paragraph_style.turnHintingOff();
+    TextStyle text_style;
+    text_style.setFontFamilies({SkString("Roboto")});
+    text_style.setFontSize(20);
+    text_style.setColor(SK_ColorBLACK);
+
+    auto build = [&](sk_sp<FontCollection> collection, int i) {
+        SkString text;
+        for (int j = 0; j <= i % 7; ++j) {
+            text.appendf("Paragraph %d has some words in it. ", i);
+        }
+        ParagraphBuilderImpl builder(paragraph_style, collection);
+        builder.pushStyle(text_style);
+        builder.addText(text.c_str(), text.size());
+        builder.pop();
+        return builder.Build();
+    };
+
+    static constexpr int kCount = 64;
+    std::vector<std::unique_ptr<Paragraph>> paragraphs;
+    std::vector<Paragraph*> pointers;
+    std::vector<SkScalar> widths;
+    for (int i = 0; i < kCount; ++i) {
+        paragraphs.push_back(build(fontCollection, i));
+        pointers.push_back(paragraphs.back().get());
+        widths.push_back(100 + 10 * (i % 20));
+    }
+
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+    Paragraph::LayoutAll(SkMakeSpan(pointers), SkMakeSpan(widths), executor.get());
+
+    for (int i = 0; i < kCount; ++i) {
+        auto expected = build(serialCollection, i);
+        expected->layout(widths[i]);
+        REPORTER_ASSERT(reporter, paragraphs[i]->lineNumber() == expected->lineNumber());
+        REPORTER_ASSERT(reporter, paragraphs[i]->getHeight() == expected->getHeight());
+        REPORTER_ASSERT(reporter, paragraphs[i]->getLongestLine() == expected->getLongestLine());
+    }
+}
@@ -41,6 +41,8 @@ class SkFont;
 class SkFontMgr;
 class SkUnicode;
 
+// An SkShaper must only be used by one thread at a time, but different shapers can shape on
+// different threads at once: the state they share (like HarfBuzz's faces) is locked.
 class SKSHAPER_API SkShaper {
 public:
     static std::unique_ptr<SkShaper> MakePrimitive();
@@ -1256,41 +1256,179 @@ void ShapeDontWrapOrReorder::wrap(char const * const utf8, size_t utf8Bytes,
     handler->commitLine();
 }
 
-class HBLockedFaceCache {
+template <typename K, typename V> class HBLockedCache {
 public:
-    HBLockedFaceCache(SkLRUCache<SkFontID, HBFace>& lruCache, SkMutex& mutex)
+    HBLockedCache(SkLRUCache<K, V>& lruCache, SkMutex& mutex)
         : fLRUCache(lruCache), fMutex(mutex)
     {
         fMutex.acquire();
     }
-    HBLockedFaceCache(const HBLockedFaceCache&) = delete;
-    HBLockedFaceCache& operator=(const HBLockedFaceCache&) = delete;
-    HBLockedFaceCache(HBLockedFaceCache&&) = delete;
-    HBLockedFaceCache& operator=(HBLockedFaceCache&&) = delete;
+    HBLockedCache(const HBLockedCache&) = delete;
+    HBLockedCache& operator=(const HBLockedCache&) = delete;
+    HBLockedCache(HBLockedCache&&) = delete;
+    HBLockedCache& operator=(HBLockedCache&&) = delete;
 
-    ~HBLockedFaceCache() {
+    ~HBLockedCache() {
         fMutex.release();
     }
 
-    HBFace* find(SkFontID fontId) {
-        return fLRUCache.find(fontId);
+    V* find(const K& key) {
+        return fLRUCache.find(key);
     }
-    HBFace* insert(SkFontID fontId, HBFace hbFace) {
-        return fLRUCache.insert(fontId, std::move(hbFace));
+    V* insert(const K& key, V value) {
+        return fLRUCache.insert(key, std::move(value));
     }
     void reset() {
         fLRUCache.reset();
     }
 private:
-    SkLRUCache<SkFontID, HBFace>& fLRUCache;
+    SkLRUCache<K, V>& fLRUCache;
     SkMutex& fMutex;
 };
+
+using HBLockedFaceCache = HBLockedCache<SkFontID, HBFace>;
 static HBLockedFaceCache get_hbFace_cache() {
     static SkMutex gHBFaceCacheMutex;
     static SkLRUCache<SkFontID, HBFace> gHBFaceCache(100);
     return HBLockedFaceCache(gHBFaceCache, gHBFaceCacheMutex);
 }
 
+// HBFonts made immutable, so any number of threads may shape with them at once, keyed by
+// append_font_key. Take a reference (hb_font_reference) before releasing the lock.
+using HBLockedFontCache = HBLockedCache<SkString, HBFont>;
+static HBLockedFontCache get_hbFont_cache() {
+    static SkMutex gHBFontCacheMutex;
+    static SkLRUCache<SkString, HBFont> gHBFontCache(100);
+    return HBLockedFontCache(gHBFontCache, gHBFontCacheMutex);
+}
+
+// The glyphs HarfBuzz returned for a run, with clusters relative to the start of the run.
+struct CachedShapedRun {
+    std::unique_ptr<ShapedGlyph[]> fGlyphs;
+    size_t fNumGlyphs;
+    SkVector fAdvance;
+};
+
+// Short runs (labels, numbers, button titles) are shaped over and over again; keep the results
+// for the most recent ones, keyed by make_run_key. Longer runs rarely repeat and are not kept.
+constexpr size_t kMaxCachedRunBytes = 128;
+using HBLockedRunCache = HBLockedCache<SkString, CachedShapedRun>;
+static HBLockedRunCache get_shapedRun_cache() {
+    static SkMutex gShapedRunCacheMutex;
+    static SkLRUCache<SkString, CachedShapedRun> gShapedRunCache(1024);
+    return HBLockedRunCache(gShapedRunCache, gShapedRunCacheMutex);
+}
+
+template <typename T> void append_pod(SkString* key, const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value, "");
+    key->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Everything about font that create_hb_font and the skhb font funcs look at.
+void append_font_key(SkString* key, const SkFont& font) {
+    append_pod(key, font.getTypeface()->uniqueID());
+    append_pod(key, font.getSize());
+    append_pod(key, font.getScaleX());
+    append_pod(key, font.getSkewX());
+    uint32_t flags = (font.isForceAutoHinting() << 0)
+                   | (font.isEmbeddedBitmaps()  << 1)
+                   | (font.isSubpixel()         << 2)
+                   | (font.isLinearMetrics()    << 3)
+                   | (font.isEmbolden()         << 4)
+                   | (font.isBaselineSnap()     << 5)
+                   | ((uint32_t)font.getEdging()  << 8)
+                   | ((uint32_t)font.getHinting() << 16);
+    append_pod(key, flags);
+}
+
+// HarfBuzz looks at no more than HB_BUFFER_CONTEXT_LENGTH (5) code points on either side of
+// the run, so only those are part of the key.
+constexpr int kRunContextLength = 5;
+
+SkString make_run_key(const SkFont& font,
+                      hb_direction_t direction,
+                      hb_script_t script,
+                      hb_language_t language,
+                      SkSpan<const hb_feature_t> features,
+                      const char* utf8, size_t utf8Bytes,
+                      const char* utf8Start, const char* utf8End) {
+    SkString key;
+    append_font_key(&key, font);
+    append_pod(&key, direction);
+    append_pod(&key, script);
+    // Languages are interned, so the pointer identifies one.
+    append_pod(&key, reinterpret_cast<uintptr_t>(language));
+
+    const unsigned runStart = SkTo<unsigned>(utf8Start - utf8);
+    const unsigned runEnd   = SkTo<unsigned>(utf8End   - utf8);
+    append_pod(&key, SkTo<uint32_t>(features.size()));
+    for (const hb_feature_t& feature : features) {
+        append_pod(&key, feature.tag);
+        append_pod(&key, feature.value);
+        if (feature.start == HB_FEATURE_GLOBAL_START && feature.end == HB_FEATURE_GLOBAL_END) {
+            append_pod(&key, feature.start);
+            append_pod(&key, feature.end);
+        } else {
+            append_pod(&key, std::max(feature.start, runStart) - runStart);
+            append_pod(&key, std::min(feature.end, runEnd) - runStart);
+        }
+    }
+
+    const char* contextStart = utf8Start;
+    for (int i = 0; i < kRunContextLength && contextStart > utf8; ++i) {
+        do {
+            --contextStart;
+        } while (contextStart > utf8 && (*contextStart & 0xC0) == 0x80);
+    }
+    const char* contextEnd = utf8End;
+    for (int i = 0; i < kRunContextLength && contextEnd < utf8 + utf8Bytes; ++i) {
+        utf8_next(&contextEnd, utf8 + utf8Bytes);
+    }
+    append_pod(&key, SkTo<uint32_t>(utf8Start - contextStart));
+    append_pod(&key, SkTo<uint32_t>(utf8End - utf8Start));
+    key.append(contextStart, contextEnd - contextStart);
+    return key;
+}
+
+HBFont find_or_create_hb_font(const SkFont& font) {
+    SkString fontKey;
+    append_font_key(&fontKey, font);
+    {
+        HBLockedFontCache cache = get_hbFont_cache();
+        if (HBFont* hbFontCached = cache.find(fontKey)) {
+            return HBFont(hb_font_reference(hbFontCached->get()));
+        }
+    }
+
+    HBFont hbFont;
+    {
+        // An HBFace is expensive (it sanitizes the bits).
+        // An HBFace is actually tied to the data, not the typeface.
+        // The size of 100 here is completely arbitrary and used to match libtxt.
+        HBLockedFaceCache cache = get_hbFace_cache();
+        SkFontID dataId = font.getTypeface()->uniqueID();
+        HBFace* hbFaceCached = cache.find(dataId);
+        if (!hbFaceCached) {
+            HBFace hbFace(create_hb_face(*font.getTypeface()));
+            hbFaceCached = cache.insert(dataId, std::move(hbFace));
+        }
+        hbFont = create_hb_font(font, *hbFaceCached);
+    }
+    if (!hbFont) {
+        return nullptr;
+    }
+    // The face's shape plans are cached on it by HarfBuzz, so they live as long as the font.
+    hb_font_make_immutable(hbFont.get());
+
+    HBLockedFontCache cache = get_hbFont_cache();
+    if (HBFont* hbFontCached = cache.find(fontKey)) {
+        // Another thread made one first.
+        return HBFont(hb_font_reference(hbFontCached->get()));
+    }
+    cache.insert(fontKey, HBFont(hb_font_reference(hbFont.get())));
+    return hbFont;
+}
+
 ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
                                   size_t const utf8Bytes,
                                   char const * const utf8Start,
@@ -1305,6 +1443,62 @@ ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
     ShapedRun run(RunHandler::Range(utf8Start - utf8, utf8runLength),
                   font.currentFont(), bidi.currentLevel(), nullptr, 0);
 
+    hb_direction_t direction = is_LTR(bidi.currentLevel()) ? HB_DIRECTION_LTR:HB_DIRECTION_RTL;
+    hb_script_t hbScript = hb_script_from_iso15924_tag((hb_tag_t)script.currentScript());
+    // Buffers with HB_LANGUAGE_INVALID race since hb_language_get_default is not thread safe.
+    // The user must provide a language, but may provide data hb_language_from_string cannot use.
+    // Use "und" for the undefined language in this case (RFC5646 4.1 5).
+    hb_language_t hbLanguage = hb_language_from_string(language.currentLanguage(), -1);
+    if (hbLanguage == HB_LANGUAGE_INVALID) {
+        hbLanguage = fUndefinedLanguage;
+    }
+
+    SkSTArray<32, hb_feature_t> hbFeatures;
+    for (const auto& feature : SkMakeSpan(features, featuresSize)) {
+        if (feature.end < SkTo<size_t>(utf8Start - utf8) ||
+                          SkTo<size_t>(utf8End   - utf8)  <= feature.start)
+        {
+            continue;
+        }
+        if (feature.start <= SkTo<size_t>(utf8Start - utf8) &&
+                             SkTo<size_t>(utf8End   - utf8) <= feature.end)
+        {
+            hbFeatures.push_back({ (hb_tag_t)feature.tag, feature.value,
+                                   HB_FEATURE_GLOBAL_START, HB_FEATURE_GLOBAL_END});
+        } else {
+            hbFeatures.push_back({ (hb_tag_t)feature.tag, feature.value,
+                                   SkTo<unsigned>(feature.start), SkTo<unsigned>(feature.end)});
+        }
+    }
+
+    const unsigned runStart = SkTo<unsigned>(utf8Start - utf8);
+    SkString runKey;
+    if (utf8runLength <= kMaxCachedRunBytes) {
+        runKey = make_run_key(run.fFont, direction, hbScript, hbLanguage,
+                              SkMakeSpan(hbFeatures.data(), hbFeatures.size()),
+                              utf8, utf8Bytes, utf8Start, utf8End);
+        HBLockedRunCache cache = get_shapedRun_cache();
+        if (const CachedShapedRun* cached = cache.find(runKey)) {
+            if (cached->fNumGlyphs == 0) {
+                return run;
+            }
+            run = ShapedRun(RunHandler::Range(runStart, utf8runLength),
+                            font.currentFont(), bidi.currentLevel(),
+                            std::unique_ptr<ShapedGlyph[]>(new ShapedGlyph[cached->fNumGlyphs]),
+                            cached->fNumGlyphs, cached->fAdvance);
+            for (size_t i = 0; i < cached->fNumGlyphs; ++i) {
+                run.fGlyphs[i] = cached->fGlyphs[i];
+                run.fGlyphs[i].fCluster += runStart;
+            }
+            return run;
+        }
+    }
+
+    HBFont hbFont = find_or_create_hb_font(font.currentFont());
+    if (!hbFont) {
+        return run;
+    }
+
     hb_buffer_t* buffer = fBuffer.get();
     SkAutoTCallVProc<hb_buffer_t, hb_buffer_clear_contents> autoClearBuffer(buffer);
     hb_buffer_set_content_type(buffer, HB_BUFFER_CONTENT_TYPE_UNICODE);
@@ -1329,60 +1523,20 @@ ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
     // Add postcontext.
     hb_buffer_add_utf8(buffer, utf8Current, utf8 + utf8Bytes - utf8Current, 0, 0);
 
-    hb_direction_t direction = is_LTR(bidi.currentLevel()) ? HB_DIRECTION_LTR:HB_DIRECTION_RTL;
     hb_buffer_set_direction(buffer, direction);
-    hb_buffer_set_script(buffer, hb_script_from_iso15924_tag((hb_tag_t)script.currentScript()));
-    // Buffers with HB_LANGUAGE_INVALID race since hb_language_get_default is not thread safe.
-    // The user must provide a language, but may provide data hb_language_from_string cannot use.
-    // Use "und" for the undefined language in this case (RFC5646 4.1 5).
-    hb_language_t hbLanguage = hb_language_from_string(language.currentLanguage(), -1);
-    if (hbLanguage == HB_LANGUAGE_INVALID) {
-        hbLanguage = fUndefinedLanguage;
-    }
+    hb_buffer_set_script(buffer, hbScript);
     hb_buffer_set_language(buffer, hbLanguage);
     hb_buffer_guess_segment_properties(buffer);
 
-    // TODO: better cache HBFace (data) / hbfont (typeface)
-    // An HBFace is expensive (it sanitizes the bits).
-    // An HBFont is fairly inexpensive.
-    // An HBFace is actually tied to the data, not the typeface.
-    // The size of 100 here is completely arbitrary and used to match libtxt.
-    HBFont hbFont;
-    {
-        HBLockedFaceCache cache = get_hbFace_cache();
-        SkFontID dataId = font.currentFont().getTypeface()->uniqueID();
-        HBFace* hbFaceCached = cache.find(dataId);
-        if (!hbFaceCached) {
-            HBFace hbFace(create_hb_face(*font.currentFont().getTypeface()));
-            hbFaceCached = cache.insert(dataId, std::move(hbFace));
-        }
-        hbFont = create_hb_font(font.currentFont(), *hbFaceCached);
-    }
-    if (!hbFont) {
-        return run;
-    }
-
-    SkSTArray<32, hb_feature_t> hbFeatures;
-    for (const auto& feature : SkMakeSpan(features, featuresSize)) {
-        if (feature.end < SkTo<size_t>(utf8Start - utf8) ||
-                          SkTo<size_t>(utf8End   - utf8)  <= feature.start)
-        {
-            continue;
-        }
-        if (feature.start <= SkTo<size_t>(utf8Start - utf8) &&
-                             SkTo<size_t>(utf8End   - utf8) <= feature.end)
-        {
-            hbFeatures.push_back({ (hb_tag_t)feature.tag, feature.value,
-                                   HB_FEATURE_GLOBAL_START, HB_FEATURE_GLOBAL_END});
-        } else {
-            hbFeatures.push_back({ (hb_tag_t)feature.tag, feature.value,
-                                   SkTo<unsigned>(feature.start), SkTo<unsigned>(feature.end)});
-        }
-    }
-
     hb_shape(hbFont.get(), buffer, hbFeatures.data(), hbFeatures.size());
     unsigned len = hb_buffer_get_length(buffer);
     if (len == 0) {
+        if (!runKey.isEmpty()) {
+            HBLockedRunCache cache = get_shapedRun_cache();
+            if (!cache.find(runKey)) {
+                cache.insert(runKey, CachedShapedRun{nullptr, 0, {0, 0}});
+            }
+        }
         return run;
     }
 
@@ -1394,7 +1548,7 @@ ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
     hb_glyph_info_t* info = hb_buffer_get_glyph_infos(buffer, nullptr);
     hb_glyph_position_t* pos = hb_buffer_get_glyph_positions(buffer, nullptr);
 
-    run = ShapedRun(RunHandler::Range(utf8Start - utf8, utf8runLength),
+    run = ShapedRun(RunHandler::Range(runStart, utf8runLength),
                     font.currentFont(), bidi.currentLevel(),
                     std::unique_ptr<ShapedGlyph[]>(new ShapedGlyph[len]), len);
 
@@ -1427,6 +1581,19 @@ ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
     }
     run.fAdvance = runAdvance;
 
+    if (!runKey.isEmpty()) {
+        CachedShapedRun cached{std::unique_ptr<ShapedGlyph[]>(new ShapedGlyph[len]), len,
+                               runAdvance};
+        for (unsigned i = 0; i < len; i++) {
+            cached.fGlyphs[i] = run.fGlyphs[i];
+            cached.fGlyphs[i].fCluster -= runStart;
+        }
+        HBLockedRunCache cache = get_shapedRun_cache();
+        if (!cache.find(runKey)) {
+            cache.insert(runKey, std::move(cached));
+        }
+    }
+
     return run;
 }
 
@@ -1513,6 +1680,7 @@ std::unique_ptr<SkShaper> SkShaper::MakeShapeDontWrapOrReorder(sk_sp<SkFontMgr>
 }
 
 void SkShaper::PurgeHarfBuzzCache() {
-    HBLockedFaceCache cache = get_hbFace_cache();
-    cache.reset();
+    get_shapedRun_cache().reset();
+    get_hbFont_cache().reset();
+    get_hbFace_cache().reset();
 }
@@ -75,6 +75,8 @@ class SKUNICODE_API SkScriptIterator {
     virtual bool getScript(SkUnichar u, ScriptID* script) = 0;
 };
 
+// An SkUnicode must only be used by one thread at a time, but different instances can be used on
+// different threads at once: the state they share (like ICU's break iterators) is locked.
 class SKUNICODE_API SkUnicode {
     public:
         typedef uint32_t CombiningClass;
@@ -9,18 +9,123 @@
 #include "include/codec/SkAndroidCodec.h"
 #include "include/codec/SkCodec.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkData.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkPixelRef.h"
 #include "src/codec/SkCodecPriv.h"
 #include "src/core/SkImagePriv.h"
+#include "src/core/SkOpts.h"
 #include "src/core/SkPixmapPriv.h"
+#include "src/core/SkResourceCache.h"
 
 #include <limits.h>
 #include <utility>
 
+namespace {
+static unsigned gAnimatedFrameKeyNamespaceLabel;
+
+// A decoded frame depends only on the encoded data, the frame index and the
+// decoded size and format. The alpha type follows from the frame itself.
+struct AnimatedFrameKey : public SkResourceCache::Key {
+    AnimatedFrameKey(uint64_t frameCacheID, int frameIndex, const SkImageInfo& info)
+        : fFrameIndex(frameIndex)
+        , fWidth(info.width())
+        , fHeight(info.height())
+        , fColorType(info.colorType())
+        , fColorSpaceHash_lo(info.colorSpace() ? (uint32_t)info.colorSpace()->hash() : 0)
+        , fColorSpaceHash_hi(info.colorSpace() ? (uint32_t)(info.colorSpace()->hash() >> 32) : 0)
+    {
+        this->init(&gAnimatedFrameKeyNamespaceLabel, frameCacheID,
+                   sizeof(*this) - sizeof(SkResourceCache::Key));
+    }
+
+    int32_t  fFrameIndex;
+    int32_t  fWidth;
+    int32_t  fHeight;
+    int32_t  fColorType;
+    uint32_t fColorSpaceHash_lo;
+    uint32_t fColorSpaceHash_hi;
+};
+
+struct AnimatedFrameValue {
+    // Shares its SkPixelRef with every instance using the frame. SkAnimatedImage
+    // only decodes into pixels it owns uniquely, so these are never overwritten.
+    SkBitmap                         fBitmap;
+    SkCodecAnimation::DisposalMethod fDisposalMethod;
+    // The data the frame was decoded from, since the key only holds its hash. It is
+    // shared by every frame of the animation, so it isn't counted in bytesUsed().
+    sk_sp<SkData>                    fEncoded;
+};
+
+struct AnimatedFrameRec : public SkResourceCache::Rec {
+    AnimatedFrameRec(const AnimatedFrameKey& key, const AnimatedFrameValue& value)
+        : fKey(key)
+        , fValue(value) {}
+
+    AnimatedFrameKey   fKey;
+    AnimatedFrameValue fValue;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(*this) + fValue.fBitmap.computeByteSize(); }
+    const char* getCategory() const override { return "animated-frame"; }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* context) {
+        const auto& rec = static_cast<const AnimatedFrameRec&>(baseRec);
+        *static_cast<AnimatedFrameValue*>(context) = rec.fValue;
+        return true;
+    }
+};
+
+// Instances typically decode their own copy of the same bytes, so identify the
+// animation by its contents rather than by the SkData.
+static uint64_t frame_cache_id(const SkData* encoded) {
+    if (!encoded) {
+        return 0;
+    }
+    return (uint64_t)SkOpts::hash(encoded->data(), encoded->size()) << 32 |
+           SkOpts::hash(encoded->data(), encoded->size(), (uint32_t)encoded->size());
+}
+}  // namespace
+
 sk_sp<SkAnimatedImage> SkAnimatedImage::Make(std::unique_ptr<SkAndroidCodec> codec,
         const SkImageInfo& requestedInfo, SkIRect cropRect, sk_sp<SkPicture> postProcess) {
+    return Make(std::move(codec), requestedInfo, cropRect, std::move(postProcess), nullptr);
+}
+
+sk_sp<SkAnimatedImage> SkAnimatedImage::MakeShared(sk_sp<SkData> encoded,
+        const SkImageInfo& requestedInfo, SkIRect cropRect, sk_sp<SkPicture> postProcess) {
+    if (!encoded) {
+        return nullptr;
+    }
+
+    auto codec = SkAndroidCodec::MakeFromData(encoded);
+    if (codec && codec->getEncodedFormat() == SkEncodedImageFormat::kHEIF) {
+        // HEIF only knows a frame's duration once this codec has decoded it.
+        return Make(std::move(codec), requestedInfo, cropRect, std::move(postProcess), nullptr);
+    }
+    return Make(std::move(codec), requestedInfo, cropRect, std::move(postProcess),
+                std::move(encoded));
+}
+
+sk_sp<SkAnimatedImage> SkAnimatedImage::MakeShared(sk_sp<SkData> encoded) {
+    auto codec = SkAndroidCodec::MakeFromData(encoded);
+    if (!codec) {
+        return nullptr;
+    }
+
+    auto decodeInfo = codec->getInfo();
+    if (SkEncodedOriginSwapsWidthHeight(codec->codec()->getOrigin())) {
+        decodeInfo = decodeInfo.makeWH(decodeInfo.height(), decodeInfo.width());
+    }
+    const auto cropRect = SkIRect::MakeSize(decodeInfo.dimensions());
+    return MakeShared(std::move(encoded), decodeInfo, cropRect, nullptr);
+}
+
+sk_sp<SkAnimatedImage> SkAnimatedImage::Make(std::unique_ptr<SkAndroidCodec> codec,
+        const SkImageInfo& requestedInfo, SkIRect cropRect, sk_sp<SkPicture> postProcess,
+        sk_sp<SkData> sharedEncoded) {
     if (!codec) {
         return nullptr;
     }
@@ -30,7 +135,7 @@ sk_sp<SkAnimatedImage> SkAnimatedImage::Make(std::unique_ptr<SkAndroidCodec> cod
     }
 
     auto image = sk_sp<SkAnimatedImage>(new SkAnimatedImage(std::move(codec), requestedInfo,
-                cropRect, std::move(postProcess)));
+                cropRect, std::move(postProcess), std::move(sharedEncoded)));
     if (!image->fDisplayFrame.fBitmap.getPixels()) {
         // tryAllocPixels failed.
         return nullptr;
@@ -54,7 +159,8 @@ sk_sp<SkAnimatedImage> SkAnimatedImage::Make(std::unique_ptr<SkAndroidCodec> cod
 }
 
 SkAnimatedImage::SkAnimatedImage(std::unique_ptr<SkAndroidCodec> codec,
-        const SkImageInfo& requestedInfo, SkIRect cropRect, sk_sp<SkPicture> postProcess)
+        const SkImageInfo& requestedInfo, SkIRect cropRect, sk_sp<SkPicture> postProcess,
+        sk_sp<SkData> sharedEncoded)
     : fCodec(std::move(codec))
     , fDecodeInfo(requestedInfo)
     , fCropRect(cropRect)
@@ -64,6 +170,8 @@ SkAnimatedImage::SkAnimatedImage(std::unique_ptr<SkAndroidCodec> codec,
     , fFinished(false)
     , fRepetitionCount(fCodec->codec()->getRepetitionCount())
     , fRepetitionsCompleted(0)
+    , fSharedEncoded(std::move(sharedEncoded))
+    , fFrameCacheID(frame_cache_id(fSharedEncoded.get()))
 {
     auto scaledSize = requestedInfo.dimensions();
 
@@ -238,6 +346,18 @@ int SkAnimatedImage::decodeNextFrame() {
         }
     }
 
+    auto alphaType = kOpaque_SkAlphaType == frameInfo.fAlphaType ?
+                     kOpaque_SkAlphaType : kPremul_SkAlphaType;
+    auto info = fDecodeInfo.makeAlphaType(alphaType);
+    if (this->findSharedFrame(frameToDecode, info, &fDecodingFrame)) {
+        using std::swap;
+        swap(fDecodingFrame, fDisplayFrame);
+        if (animationEnded) {
+            return this->finish();
+        }
+        return fCurrentFrameDuration;
+    }
+
     // The following code makes an effort to avoid overwriting a frame that will
     // be used again. If frame |i| is_restore_previous, frame |i+1| will not
     // depend on frame |i|, so do not overwrite frame |i-1|, which may be needed
@@ -289,12 +409,23 @@ int SkAnimatedImage::decodeNextFrame() {
                 return this->finish();
             }
             options.fPriorFrame = fDecodingFrame.fIndex;
+        } else if (fFrameCacheID) {
+            // Start from the latest frame another instance has already decoded,
+            // rather than decoding the chain from fRequiredFrame again.
+            for (int i = frameToDecode - 1; i >= frameInfo.fRequiredFrame; i--) {
+                Frame shared;
+                if (this->findSharedFrame(i, fDecodeInfo, &shared) && validPriorFrame(shared)) {
+                    if (!shared.copyTo(&fDecodingFrame)) {
+                        SkCodecPrintf("Failed to allocate pixels for frame\n");
+                        return this->finish();
+                    }
+                    options.fPriorFrame = fDecodingFrame.fIndex;
+                    break;
+                }
+            }
         }
     }
 
-    auto alphaType = kOpaque_SkAlphaType == frameInfo.fAlphaType ?
-                     kOpaque_SkAlphaType : kPremul_SkAlphaType;
-    auto info = fDecodeInfo.makeAlphaType(alphaType);
     SkBitmap* dst = &fDecodingFrame.fBitmap;
     if (!fDecodingFrame.init(info, Frame::OnInit::kRestoreIfNecessary)) {
         return this->finish();
@@ -313,6 +444,7 @@ int SkAnimatedImage::decodeNextFrame() {
     using std::swap;
     swap(fDecodingFrame, fDisplayFrame);
     fDisplayFrame.fBitmap.notifyPixelsChanged();
+    this->addSharedFrame(fDisplayFrame);
 
     if (animationEnded) {
         return this->finish();
@@ -331,6 +463,41 @@ int SkAnimatedImage::decodeNextFrame() {
     return fCurrentFrameDuration;
 }
 
+bool SkAnimatedImage::findSharedFrame(int index, const SkImageInfo& info, Frame* frame) const {
+    if (!fFrameCacheID) {
+        return false;
+    }
+
+    AnimatedFrameValue value;
+    if (!SkResourceCache::Find(AnimatedFrameKey(fFrameCacheID, index, info),
+                               AnimatedFrameRec::Visitor, &value)) {
+        return false;
+    }
+    // Different data can hash the same, so only share frames of identical data.
+    if (value.fEncoded != fSharedEncoded && value.fEncoded != fMatchedEncoded) {
+        if (!value.fEncoded->equals(fSharedEncoded.get())) {
+            return false;
+        }
+        fMatchedEncoded = std::move(value.fEncoded);
+    }
+    frame->fBitmap = std::move(value.fBitmap);
+    frame->fIndex = index;
+    frame->fDisposalMethod = value.fDisposalMethod;
+    return true;
+}
+
+void SkAnimatedImage::addSharedFrame(const Frame& frame) const {
+    if (!fFrameCacheID) {
+        return;
+    }
+
+    // From now on the cache holds a reference to the pixels, so Frame::init
+    // will decode the next frame into a new allocation rather than over them.
+    SkResourceCache::Add(new AnimatedFrameRec(
+            AnimatedFrameKey(fFrameCacheID, frame.fIndex, frame.fBitmap.info()),
+            {frame.fBitmap, frame.fDisposalMethod, fSharedEncoded}));
+}
+
 void SkAnimatedImage::onDraw(SkCanvas* canvas) {
     auto image = this->getCurrentFrameSimple();
 
@@ -8,6 +8,7 @@
 #include "src/codec/SkJpegCodec.h"
 
 #include "include/codec/SkCodec.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkTypes.h"
 #include "include/private/SkColorData.h"
@@ -16,8 +17,13 @@
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkJpegDecoderMgr.h"
 #include "src/codec/SkParseEncodedOrigin.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/pdf/SkJpegInfo.h"
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
 // stdio is needed for libjpeg-turbo
 #include <stdio.h>
 #include "src/codec/SkJpegUtility.h"
@@ -519,6 +525,339 @@ static inline bool needs_swizzler_to_convert_from_cmyk(J_COLOR_SPACE jpegColorTy
     return !hasCMYKColorSpace || !hasColorSpaceXform;
 }
 
+namespace {
+// Where the restart markers split the entropy-coded data of a JPEG with a single scan.
+struct JpegRestartLayout {
+    int    fWidth = 0;
+    int    fHeight = 0;
+    size_t fHeightOffset = 0;     // Offset of the image height in the SOF segment.
+    size_t fScanStart = 0;        // Offset of the first byte of entropy-coded data.
+    size_t fScanEnd = 0;          // Offset of the EOI marker.
+    int    fMCUHeight = 0;        // In pixels.
+    int    fMCURows = 0;
+    int    fMCUsPerRow = 0;
+    int    fRestartInterval = 0;  // In MCUs.
+    std::vector<size_t> fRestarts;  // Offsets of the RSTn markers.
+
+    int intervalCount() const { return SkToInt(fRestarts.size()) + 1; }
+    size_t intervalStart(int i) const { return i == 0 ? fScanStart : fRestarts[i - 1] + 2; }
+    size_t intervalEnd(int i) const {
+        return i + 1 == this->intervalCount() ? fScanEnd : fRestarts[i];
+    }
+
+    // Returns the restart interval that starts with MCU row, or -1 if the row begins in the
+    // middle of an interval.
+    int intervalAtRow(int row) const {
+        int64_t mcu = (int64_t)row * fMCUsPerRow;
+        return mcu % fRestartInterval == 0 ? SkToInt(mcu / fRestartInterval) : -1;
+    }
+};
+}  // namespace
+
+static int read_big_endian_u16(const uint8_t* data) { return (data[0] << 8) | data[1]; }
+
+/*
+ * Succeeds for baseline and extended sequential Huffman coded JPEGs with a restart interval
+ * and a single scan of all components, and finds the offsets of their restart markers.
+ */
+static bool parse_restart_layout(const uint8_t* data, size_t size, JpegRestartLayout* layout) {
+    constexpr uint8_t kSOF0 = 0xC0;
+    constexpr uint8_t kSOF1 = 0xC1;
+    constexpr uint8_t kSOF15 = 0xCF;
+    constexpr uint8_t kDHT = 0xC4;
+    constexpr uint8_t kSOI = 0xD8;
+    constexpr uint8_t kSOS = 0xDA;
+    constexpr uint8_t kDRI = 0xDD;
+    if (size < 4 || data[0] != 0xFF || data[1] != kSOI) {
+        return false;
+    }
+
+    int components = 0;
+    int maxH = 0;
+    int maxV = 0;
+    size_t offset = 2;
+    while (true) {
+        // Markers may be preceded by any number of fill bytes.
+        while (offset + 1 < size && data[offset] == 0xFF && data[offset + 1] == 0xFF) {
+            offset++;
+        }
+        if (offset + 4 > size || data[offset] != 0xFF) {
+            return false;
+        }
+        const uint8_t marker = data[offset + 1];
+        const size_t length = read_big_endian_u16(data + offset + 2);
+        if (length < 2 || length > size - offset - 2) {
+            return false;
+        }
+        const uint8_t* segment = data + offset + 4;
+        if (marker == kSOF0 || marker == kSOF1) {
+            if (layout->fHeight || length < 8) {
+                return false;
+            }
+            components = segment[5];
+            layout->fHeight = read_big_endian_u16(segment + 1);
+            layout->fWidth = read_big_endian_u16(segment + 3);
+            layout->fHeightOffset = offset + 5;
+            // A zero height is defined later by a DNL marker.
+            if (segment[0] != 8 || components == 0 || length != 8u + 3 * components ||
+                    layout->fHeight == 0 || layout->fWidth == 0) {
+                return false;
+            }
+            for (int i = 0; i < components; i++) {
+                const uint8_t samplingFactors = segment[6 + 3 * i + 1];
+                maxH = std::max(maxH, samplingFactors >> 4);
+                maxV = std::max(maxV, samplingFactors & 0xF);
+            }
+        } else if (marker > kSOF1 && marker <= kSOF15 && marker != kDHT) {
+            // Progressive, lossless, hierarchical or arithmetic coded.
+            return false;
+        } else if (marker == kDRI) {
+            if (length != 4) {
+                return false;
+            }
+            layout->fRestartInterval = read_big_endian_u16(segment);
+        } else if (marker == kSOS) {
+            if (!layout->fHeight || segment[0] != components) {
+                return false;
+            }
+            layout->fScanStart = offset + 2 + length;
+            break;
+        }
+        offset += 2 + length;
+    }
+    if (layout->fRestartInterval == 0) {
+        return false;
+    }
+    if (components == 1) {
+        // The MCU of a non-interleaved scan is a single block.
+        maxH = maxV = 1;
+    }
+    if (maxH < 1 || maxH > 4 || maxV < 1 || maxV > 4) {
+        return false;
+    }
+    const int mcuWidth = 8 * maxH;
+    layout->fMCUHeight = 8 * maxV;
+    layout->fMCUsPerRow = (layout->fWidth + mcuWidth - 1) / mcuWidth;
+    layout->fMCURows = (layout->fHeight + layout->fMCUHeight - 1) / layout->fMCUHeight;
+
+    // The restart markers count up modulo 8.  Any marker but those and EOI means the image has
+    // more than one scan.
+    layout->fRestarts.clear();
+    size_t i = layout->fScanStart;
+    while (true) {
+        const void* found = memchr(data + i, 0xFF, size - i);
+        if (!found) {
+            return false;
+        }
+        i = static_cast<const uint8_t*>(found) - data;
+        if (i + 1 >= size) {
+            return false;
+        }
+        const uint8_t next = data[i + 1];
+        if (next == 0x00) {
+            i += 2;  // A stuffed zero byte.
+        } else if (next == 0xFF) {
+            i += 1;  // A fill byte.
+        } else if (next >= JPEG_RST0 && next <= JPEG_RST0 + 7) {
+            if (next - JPEG_RST0 != SkToInt(layout->fRestarts.size() % 8)) {
+                return false;
+            }
+            layout->fRestarts.push_back(i);
+            i += 2;
+        } else if (next == JPEG_EOI) {
+            layout->fScanEnd = i;
+            break;
+        } else {
+            return false;
+        }
+    }
+    const int64_t mcus = (int64_t)layout->fMCUsPerRow * layout->fMCURows;
+    return layout->intervalCount() ==
+           (mcus + layout->fRestartInterval - 1) / layout->fRestartInterval;
+}
+
+/*
+ * Makes a standalone JPEG holding MCU rows [startRow, endRow) of the image described by layout.
+ * Both rows must start a restart interval (or be the end of the image).
+ */
+static sk_sp<SkData> make_restart_stripe(const uint8_t* data, const JpegRestartLayout& layout,
+                                         int startRow, int endRow) {
+    const int firstInterval = layout.intervalAtRow(startRow);
+    const int endInterval = endRow == layout.fMCURows ? layout.intervalCount()
+                                                      : layout.intervalAtRow(endRow);
+    SkASSERT(0 <= firstInterval && firstInterval < endInterval);
+    const size_t scanStart = layout.intervalStart(firstInterval);
+    const size_t scanEnd = layout.intervalEnd(endInterval - 1);
+    const size_t size = layout.fScanStart + (scanEnd - scanStart) + 2;
+    sk_sp<SkData> stripe = SkData::MakeUninitialized(size);
+    uint8_t* dst = static_cast<uint8_t*>(stripe->writable_data());
+
+    memcpy(dst, data, layout.fScanStart);
+    const int height = std::min(endRow * layout.fMCUHeight, layout.fHeight)
+                     - startRow * layout.fMCUHeight;
+    dst[layout.fHeightOffset + 0] = height >> 8;
+    dst[layout.fHeightOffset + 1] = height & 0xFF;
+    dst += layout.fScanStart;
+
+    // The decoder expects the restart markers to count up from RST0 again.
+    memcpy(dst, data + scanStart, scanEnd - scanStart);
+    for (int i = firstInterval; i + 1 < endInterval; i++) {
+        dst[layout.fRestarts[i] - scanStart + 1] = JPEG_RST0 + (i - firstInterval) % 8;
+    }
+    dst += scanEnd - scanStart;
+    dst[0] = 0xFF;
+    dst[1] = JPEG_EOI;
+    return stripe;
+}
+
+/*
+ * Decodes a stripe made by make_restart_stripe() with the output settings of the image's
+ * decompress struct.  The first skipRows rows are decoded into scratchRow and discarded.
+ * Each of the next rows is decoded into decodeRow, or into dst if that is null, and then
+ * passed to finishRow(dstRow, decodedRow).
+ */
+template <typename FinishRowProc>
+static bool decode_restart_stripe(sk_sp<SkData> encoded, const jpeg_decompress_struct& settings,
+                                  int skipRows, int rows, void* dst, size_t rowBytes,
+                                  JSAMPLE* scratchRow, JSAMPLE* decodeRow,
+                                  FinishRowProc finishRow) {
+    SkMemoryStream stream(std::move(encoded));
+    JpegDecoderMgr decoderMgr(&stream);
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(decoderMgr.errorMgr());
+    if (setjmp(jmp)) {
+        return false;
+    }
+
+    decoderMgr.init();
+    jpeg_decompress_struct* dinfo = decoderMgr.dinfo();
+    if (JPEG_HEADER_OK != jpeg_read_header(dinfo, true)) {
+        return false;
+    }
+    dinfo->out_color_space = settings.out_color_space;
+    dinfo->dither_mode = settings.dither_mode;
+    dinfo->dct_method = settings.dct_method;
+    dinfo->do_fancy_upsampling = settings.do_fancy_upsampling;
+    dinfo->scale_num = settings.scale_num;
+    dinfo->scale_denom = settings.scale_denom;
+    if (!jpeg_start_decompress(dinfo)) {
+        return false;
+    }
+
+    for (int y = -skipRows; y < rows; y++) {
+        JSAMPLE* row = y < 0     ? scratchRow
+                     : decodeRow ? decodeRow
+                                 : SkTAddOffset<JSAMPLE>(dst, y * rowBytes);
+        if (1 != jpeg_read_scanlines(dinfo, &row, 1)) {
+            return false;
+        }
+        if (y >= 0) {
+            finishRow(SkTAddOffset<void>(dst, y * rowBytes), row);
+        }
+    }
+    // Warnings are issued for corrupt or truncated data.  Leave those for the serial decode
+    // to report.
+    return dinfo->err->num_warnings == 0;
+}
+
+bool SkJpegCodec::decodeRestartIntervalsInParallel(const SkImageInfo& dstInfo, void* dst,
+                                                   size_t rowBytes, const Options& options) {
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    if (!options.fExecutor || options.fSubset || JCS_CMYK == dinfo->out_color_space) {
+        return false;
+    }
+
+    // The stripes are copied from the encoded data, so it must all be in memory.
+    SkStream* stream = this->stream();
+    const uint8_t* data = static_cast<const uint8_t*>(stream->getMemoryBase());
+    JpegRestartLayout layout;
+    if (!data || !stream->hasLength() ||
+            !parse_restart_layout(data, stream->getLength(), &layout) ||
+            layout.fWidth != this->dimensions().width() ||
+            layout.fHeight != this->dimensions().height()) {
+        return false;
+    }
+
+    // libjpeg-turbo scales each block of 8 rows to scale_num / scale_denom * 8 rows.
+    const int scaledMCUHeight = layout.fMCUHeight * dinfo->scale_num / dinfo->scale_denom;
+    if (scaledMCUHeight * dinfo->scale_denom != layout.fMCUHeight * dinfo->scale_num ||
+            (layout.fMCURows - 1) * scaledMCUHeight >= dstInfo.height() ||
+            layout.fMCURows * scaledMCUHeight < dstInfo.height()) {
+        return false;
+    }
+
+    // Split the image into stripes of at least kMinStripeMCURows, each starting with a restart
+    // interval.
+    constexpr int kMinStripeMCURows = 4;
+    constexpr int kMaxStripes = 32;
+    const int targetStripes = std::min(kMaxStripes, layout.fMCURows / kMinStripeMCURows);
+    std::vector<int> stripeStarts = {0};
+    for (int i = 1; i < targetStripes; i++) {
+        int row = std::max(i * layout.fMCURows / targetStripes, stripeStarts.back() + 1);
+        while (row < layout.fMCURows && layout.intervalAtRow(row) < 0) {
+            row++;
+        }
+        if (row == layout.fMCURows) {
+            break;
+        }
+        stripeStarts.push_back(row);
+    }
+    stripeStarts.push_back(layout.fMCURows);
+    const int stripeCount = SkToInt(stripeStarts.size()) - 1;
+    if (stripeCount < 2) {
+        return false;
+    }
+
+    // Each stripe needs a scratch row for the skipped rows, and another to color xform from
+    // when that cannot be done in place, as in allocateStorage().
+    const size_t decodedRowBytes = dstInfo.width() * sizeof(uint32_t);
+    const bool xformFromStorage =
+            this->colorXform() && sizeof(uint32_t) != dstInfo.bytesPerPixel();
+    const size_t stripeStorage = decodedRowBytes * (xformFromStorage ? 2 : 1);
+    SkAutoTMalloc<uint8_t> storage;
+    if (!storage.reset(stripeStorage * stripeCount)) {
+        return false;
+    }
+
+    std::atomic<bool> failed{false};
+    SkTaskGroup taskGroup(*options.fExecutor);
+    taskGroup.batch(stripeCount, [&](int i) {
+        const int startRow = stripeStarts[i];
+        const int endRow = stripeStarts[i + 1];
+
+        // Decode one more MCU row above and below the stripe where there is one, so that
+        // upsampling sees the same neighbors as in a serial decode.
+        int decodeStartRow = startRow;
+        if (decodeStartRow > 0) {
+            do {
+                decodeStartRow--;
+            } while (layout.intervalAtRow(decodeStartRow) < 0);
+        }
+        int decodeEndRow = std::min(endRow + 1, layout.fMCURows);
+        while (decodeEndRow < layout.fMCURows && layout.intervalAtRow(decodeEndRow) < 0) {
+            decodeEndRow++;
+        }
+
+        const int firstDstRow = startRow * scaledMCUHeight;
+        const int endDstRow = std::min(endRow * scaledMCUHeight, dstInfo.height());
+        void* stripeDst = SkTAddOffset<void>(dst, firstDstRow * rowBytes);
+        JSAMPLE* scratchRow = SkTAddOffset<JSAMPLE>(storage.get(), i * stripeStorage);
+        JSAMPLE* decodeRow = xformFromStorage ? scratchRow + decodedRowBytes : nullptr;
+        auto finishRow = [&](void* dstRow, const JSAMPLE* decoded) {
+            if (this->colorXform()) {
+                this->applyColorXform(dstRow, decoded, dstInfo.width());
+            }
+        };
+        if (!decode_restart_stripe(make_restart_stripe(data, layout, decodeStartRow, decodeEndRow),
+                                   *dinfo, (startRow - decodeStartRow) * scaledMCUHeight,
+                                   endDstRow - firstDstRow, stripeDst, rowBytes,
+                                   scratchRow, decodeRow, finishRow)) {
+            failed = true;
+        }
+    });
+    taskGroup.wait();
+    return !failed;
+}
+
 /*
  * Performs the jpeg decode
  */
@@ -534,6 +873,10 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
     // Get a pointer to the decompress info since we will use it quite frequently
     jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
 
+    if (this->decodeRestartIntervalsInParallel(dstInfo, dst, dstRowBytes, options)) {
+        return kSuccess;
+    }
+
     // Set the jump location for libjpeg errors
     skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
     if (setjmp(jmp)) {
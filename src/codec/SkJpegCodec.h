@@ -109,6 +109,18 @@ private:
     bool SK_WARN_UNUSED_RESULT allocateStorage(const SkImageInfo& dstInfo);
     int readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count, const Options&);
 
+    /*
+     * If the scan is split by restart markers at MCU row boundaries, decodes horizontal
+     * stripes of the image concurrently on options.fExecutor.  Each stripe is decoded from a
+     * standalone JPEG made of the header and the stripe's restart intervals, with an extra MCU
+     * row above and below so upsampling matches the serial decode.
+     *
+     * Returns false if the image cannot be decoded this way or a stripe fails to decode; the
+     * caller then decodes serially.  Must be called before jpeg_start_decompress().
+     */
+    bool decodeRestartIntervalsInParallel(const SkImageInfo& dstInfo, void* dst,
+                                          size_t rowBytes, const Options&);
+
     /*
      * Scanline decoding.
      */
@@ -53,6 +53,24 @@ void SkBigPicture::partialPlayback(SkCanvas* canvas,
                         initialCTM);
 }
 
+bool SkBigPicture::tiledPlayback(const SkPixmap& dst,
+                                 const SkSurfaceProps& props,
+                                 const SkM44& ctm,
+                                 const SkIRect& clip,
+                                 int tileSize,
+                                 SkExecutor& executor) const {
+    return SkRecordDrawTiled(*fRecord,
+                             dst,
+                             props,
+                             ctm,
+                             clip,
+                             this->drawablePicts(),
+                             this->drawableCount(),
+                             fBBH.get(),
+                             tileSize,
+                             executor);
+}
+
 struct NestedApproxOpCounter {
     int fCount = 0;
 
@@ -16,8 +16,11 @@
 #include "include/private/SkTemplates.h"
 
 class SkBBoxHierarchy;
+class SkExecutor;
 class SkMatrix;
+class SkPixmap;
 class SkRecord;
+class SkSurfaceProps;
 
 // An implementation of SkPicture supporting an arbitrary number of drawing commands.
 class SkBigPicture final : public SkPicture {
@@ -54,6 +57,13 @@ public:
                          int start,
                          int stop,
                          const SkM44& initialCTM) const;
+// Used by SkCanvas when SkSurfaceProps::kParallelPicturePlayback_Flag is set.
+    bool tiledPlayback(const SkPixmap& dst,
+                       const SkSurfaceProps&,
+                       const SkM44& ctm,
+                       const SkIRect& clip,
+                       int tileSize,
+                       SkExecutor&) const;
 // Used by GrRecordReplaceDraw
     const SkBBoxHierarchy* bbh() const { return fBBH.get(); }
     const SkRecord*     record() const { return fRecord.get(); }
@@ -0,0 +1,410 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkBlurEngine.h"
+
+#include "include/core/SkExecutor.h"
+#include "include/core/SkPixmap.h"
+#include "include/private/SkMalloc.h"
+#include "include/private/SkTPin.h"
+#include "include/private/SkTemplates.h"
+#include "include/private/SkTo.h"
+#include "src/core/SkMathPriv.h"
+#include "src/core/SkOpts.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <cmath>
+#include <memory>
+
+SkBlurPass::SkBlurPass(int window, int srcLeft, int srcWidth, int dstWidth)
+        : fWindow{window}
+        , fBorder{SkBlurEngine::BorderForWindow(window)}
+        , fSrcLeft{srcLeft}
+        , fSrcWidth{srcWidth}
+        , fDstWidth{dstWidth} {
+    SkASSERT(window >= 1);
+
+    // The spec uses three boxes of the window for odd windows; for even windows, two boxes of
+    // the window and a third one wider, so the boxes together are centered.
+    fPass0Size = window - 1;
+    fPass1Size = window - 1;
+    fPass2Size = (window & 1) == 1 ? window - 1 : window;
+
+    // If the window is odd then the divisor is just window ^ 3 otherwise,
+    // it is window * window * (window + 1) = window ^ 3 + window ^ 2;
+    uint64_t window2 = window * window;
+    uint64_t window3 = window2 * window;
+    uint64_t divisor = (window & 1) == 1 ? window3 : window3 + window2;
+
+    // NB the sums in the blur code use the following technique to avoid
+    // adding 1/2 to round the divide.
+    //
+    //   Sum/d + 1/2 == (Sum + h) / d
+    //   Sum + d(1/2) ==  Sum + h
+    //     h == (1/2)d
+    //
+    // But the d/2 it self should be rounded.
+    //    h == d/2 + 1/2 == (d + 1) / 2
+    //
+    // weight = 1 / d * 2 ^ 32
+    // A window of 1 does not blur at all, and never uses the weight.
+    fWeight = window > 1 ? static_cast<uint32_t>(round(1.0 / divisor * (1ull << 32))) : 0;
+    fHalf = static_cast<uint32_t>((divisor + 1) / 2);
+}
+
+std::atomic<float> gSkBlurMaxDownsampleError{2.0f};
+
+namespace SkBlurEngine {
+
+// This is defined by the SVG spec:
+// https://drafts.fxtf.org/filter-effects/#feGaussianBlurElement
+int WindowForSigma(double sigma) {
+    // NB 135 is the largest sigma that will not cause a buffer full of 255 mask values to overflow
+    // using the Gauss filter. It also limits the size of buffers used hold intermediate values. The
+    // additional + 1 added to window represents adding one more leading element before subtracting
+    // the trailing element.
+    // Explanation of maximums:
+    //   sum0 = (window + 1) * 255
+    //   sum1 = (window + 1) * sum0 -> (window + 1) * (window + 1) * 255
+    //   sum2 = (window + 1) * sum1 -> (window + 1)^3 * 255
+    //
+    //   The value (window + 1)^3 * 255 must fit in a uint32_t. So,
+    //      (window + 1)^3 * 255 < 2^32. window = 255.
+    //
+    //   window = floor(sigma * 3 * sqrt(2 * kPi) / 4)
+    //   For window <= 255, the largest value for sigma is 135.
+    sigma = SkTPin(sigma, 0.0, 135.0);
+    auto possibleWindow = static_cast<int>(floor(sigma * 3 * sqrt(2 * SK_DoublePI) / 4 + 0.5));
+    return std::max(1, possibleWindow);
+}
+
+// Calculating the border is tricky. The border is the distance in pixels between the first dst
+// pixel and the first src pixel (or the last src pixel and the last dst pixel).
+// I will go through the odd case which is simpler, and then through the even case. Given a
+// stack of filters seven wide for the odd case of three passes.
+//
+//        S
+//     aaaAaaa
+//     bbbBbbb
+//     cccCccc
+//        D
+//
+// The furthest changed pixel is when the filters are in the following configuration.
+//
+//                 S
+//           aaaAaaa
+//        bbbBbbb
+//     cccCccc
+//        D
+//
+//  The A pixel is calculated using the value S, the B uses A, and the C uses B, and
+// finally D is C. So, with a window size of seven the border is nine. In the odd case, the
+// border is 3*((window - 1)/2).
+//
+// For even cases the filter stack is more complicated. The spec specifies two passes
+// of even filters and a final pass of odd filters. A stack for a width of six looks like
+// this.
+//
+//       S
+//    aaaAaa
+//     bbBbbb
+//    cccCccc
+//       D
+//
+// The furthest pixel looks like this.
+//
+//               S
+//          aaaAaa
+//        bbBbbb
+//    cccCccc
+//       D
+//
+// For a window of six, the border value is eight. In the even case the border is 3 *
+// (window/2) - 1.
+int BorderForWindow(int window) {
+    return (window & 1) == 1 ? 3 * ((window - 1) / 2) : 3 * (window / 2) - 1;
+}
+
+// Blurring at 1/scale resolution, the largest difference from the full resolution blur, found
+// at hard edges, is no more than kDownsampleError * scale / sigma 8-bit units.
+static constexpr double kDownsampleError = 72;
+static constexpr int kMaxDownsample = 64;
+
+int DownsampleForSigma(double sigma, float maxError) {
+    int scale = 1;
+    while (scale < kMaxDownsample && 2 * scale * kDownsampleError <= sigma * maxError) {
+        scale *= 2;
+    }
+    return scale;
+}
+
+// Averaging blocks of scale pixels, and scaling them back up with linear interpolation, blur
+// with variances of (scale^2 - 1) / 12 and (scale^2 - 1) / 6; the blur at reduced resolution
+// makes up the rest of sigma^2.
+double ScaledSigma(double sigma, int scale) {
+    double variance = sigma * sigma - (scale * scale - 1) / 4.0;
+    return std::sqrt(std::max(variance, 0.0)) / scale;
+}
+
+// Passes with fewer dst pixels than this run as one stripe.
+static constexpr int kMinPixelsPerStripe = 32 * 1024;
+static constexpr int kMaxStripes = 32;
+
+// Calls fn(top, bottom) for stripes of [0, rows) that together cover pixels, in parallel on
+// executor when there are enough pixels to go around.
+template <typename Fn>
+static void for_each_stripe(SkExecutor* executor, int rows, int64_t pixels, Fn&& fn) {
+    int stripes = 1;
+    if (executor) {
+        stripes = SkTPin((int)(pixels / kMinPixelsPerStripe), 1, std::min(rows, kMaxStripes));
+    }
+    const int rowsPerStripe = (rows + stripes - 1) / stripes;
+    stripes = (rows + rowsPerStripe - 1) / rowsPerStripe;
+
+    if (stripes == 1) {
+        fn(0, rows);
+        return;
+    }
+    SkTaskGroup taskGroup(*executor);
+    taskGroup.batch(stripes, [&](int stripe) {
+        const int top = stripe * rowsPerStripe;
+        fn(top, std::min(top + rowsPerStripe, rows));
+    });
+    taskGroup.wait();
+}
+
+// Blurs the rows of src into the columns of dst, in stripes of rows on executor.
+template <typename T, typename Proc>
+static void blur_transposed(Proc proc, const SkBlurPass& pass,
+                            const T* src, size_t srcRB, int rows,
+                            T* dst, size_t dstRB, SkExecutor* executor) {
+    // Keep every stripe but the last a whole number of groups, so the SIMD lanes stay full.
+    constexpr int kRowsPerGroup = SkBlurPass::kLanes / (sizeof(T) == 4 ? 4 : 1);
+    const int groups = (rows + kRowsPerGroup - 1) / kRowsPerGroup;
+
+    for_each_stripe(executor, groups, sk_64_mul(rows, pass.fDstWidth), [&](int g0, int g1) {
+        const int top    = g0 * kRowsPerGroup,
+                  bottom = std::min(g1 * kRowsPerGroup, rows);
+        SkAutoSTMalloc<1024, uint32_t> scratch(pass.scratchSize());
+        proc(pass, (const T*)((const char*)src + top * srcRB), srcRB, bottom - top,
+             dst + top, dstRB, scratch.get());
+    });
+}
+
+template <typename T, typename Proc>
+static bool blur(Proc proc, const SkPixmap& src, SkIPoint srcOffset, int windowX, int windowY,
+                 const SkPixmap& dst, SkExecutor* executor) {
+    // The horizontal pass only needs the rows of src; the rows of dst above and below src are
+    // filled in by the vertical pass.
+    SkBlurPass passX{windowX, srcOffset.x(), src.width(),  dst.width()},
+               passY{windowY, srcOffset.y(), src.height(), dst.height()};
+
+    // tmp is the horizontally blurred src, transposed: dst.width() rows of src.height() pixels.
+    // The first pass writes down its columns, so the rows are padded to keep power of two
+    // heights from mapping them all to the same cache sets.
+    const size_t tmpRB = (src.height() + 16) * sizeof(T);
+    std::unique_ptr<T, SkFunctionWrapper<void(void*), sk_free>> tmp{
+            (T*)sk_malloc_canfail(dst.width(), tmpRB)};
+    if (!tmp) {
+        return false;
+    }
+
+    blur_transposed<T>(proc, passX, (const T*)src.addr(), src.rowBytes(), src.height(),
+                       tmp.get(), tmpRB, executor);
+    blur_transposed<T>(proc, passY, tmp.get(), tmpRB, dst.width(),
+                       (T*)dst.writable_addr(), dst.rowBytes(), executor);
+    return true;
+}
+
+// Averages each scaleX x scaleY block of src into a pixel of dst; blocks hanging off the right
+// or bottom of src are padded with transparent black.
+template <int C>
+static void downsample(const SkPixmap& src, int scaleX, int scaleY, const SkPixmap& dst,
+                       SkExecutor* executor) {
+    const int shiftX = SkPrevLog2(scaleX),
+              shift  = shiftX + SkPrevLog2(scaleY);
+    const int rowLen = dst.width() * C;
+
+    for_each_stripe(executor, dst.height(), sk_64_mul(src.width(), src.height()),
+                    [&](int top, int bottom) {
+        SkAutoSTMalloc<1024, uint32_t> sums(rowLen);
+        for (int y = top; y < bottom; ++y) {
+            sk_bzero(sums.get(), rowLen * sizeof(uint32_t));
+            for (int sy = y * scaleY; sy < std::min((y + 1) * scaleY, src.height()); ++sy) {
+                auto row = static_cast<const uint8_t*>(src.addr(0, sy));
+                for (int x = 0; x < src.width(); ++x) {
+                    for (int c = 0; c < C; ++c) {
+                        sums[(x >> shiftX) * C + c] += row[x * C + c];
+                    }
+                }
+            }
+            auto out = static_cast<uint8_t*>(dst.writable_addr(0, y));
+            for (int i = 0; i < rowLen; ++i) {
+                out[i] = SkTo<uint8_t>((sums[i] + (1 << shift >> 1)) >> shift);
+            }
+        }
+    });
+}
+
+// Where pixel d of a scanline falls between the n pixels of the scanline scaled down by scale,
+// where the block of pixel srcOrigin starts at dstOrigin: the index of the pixel to its left
+// (-1 to n, out of range ones being transparent black) and the 8-bit weight of the one to its
+// right.
+struct Tap {
+    int fIndex;
+    int fWeight;
+};
+static Tap tap(int d, int scale, int dstOrigin, int srcOrigin, int n) {
+    double u = (d - dstOrigin + 0.5) / scale - 0.5 + srcOrigin;
+    double i = std::floor(u);
+    if (i < -1) {
+        return {-1, 0};
+    }
+    if (i >= n) {
+        return {n, 0};
+    }
+    return {(int)i, (int)std::round((u - i) * 256)};
+}
+
+// Bilinearly scales src up by scaleX x scaleY into dst, where the block of src pixel srcOrigin
+// starts at dst pixel dstOrigin.
+template <int C>
+static void upsample(const SkPixmap& src, SkIPoint srcOrigin, int scaleX, int scaleY,
+                     const SkPixmap& dst, SkIPoint dstOrigin, SkExecutor* executor) {
+    const int w = src.width(),
+              h = src.height();
+    SkAutoTMalloc<Tap> tapsX(dst.width());
+    for (int x = 0; x < dst.width(); ++x) {
+        tapsX[x] = tap(x, scaleX, dstOrigin.x(), srcOrigin.x(), w);
+    }
+
+    for_each_stripe(executor, dst.height(), sk_64_mul(dst.width(), dst.height()),
+                    [&](int top, int bottom) {
+        // A row of src scaled vertically, with one transparent pixel on the left and two on the
+        // right, so every tap reads in range.
+        SkAutoSTMalloc<1024, uint16_t> row((w + 3) * C);
+        sk_bzero(row.get(), (w + 3) * C * sizeof(uint16_t));
+        uint16_t* lerped = row.get() + C;
+
+        for (int y = top; y < bottom; ++y) {
+            Tap ty = tap(y, scaleY, dstOrigin.y(), srcOrigin.y(), h);
+            auto r0 = 0 <= ty.fIndex     && ty.fIndex     < h
+                    ? static_cast<const uint8_t*>(src.addr(0, ty.fIndex    )) : nullptr,
+                 r1 = 0 <= ty.fIndex + 1 && ty.fIndex + 1 < h
+                    ? static_cast<const uint8_t*>(src.addr(0, ty.fIndex + 1)) : nullptr;
+            for (int i = 0; i < w * C; ++i) {
+                lerped[i] = (r0 ? r0[i] * (256 - ty.fWeight) : 0) +
+                            (r1 ? r1[i] *        ty.fWeight  : 0);
+            }
+
+            auto out = static_cast<uint8_t*>(dst.writable_addr(0, y));
+            for (int x = 0; x < dst.width(); ++x) {
+                const uint16_t* p = lerped + tapsX[x].fIndex * C;
+                for (int c = 0; c < C; ++c) {
+                    uint32_t v = p[c] * (256 - tapsX[x].fWeight) + p[C + c] * tapsX[x].fWeight;
+                    out[x * C + c] = SkTo<uint8_t>((v + (1 << 15)) >> 16);
+                }
+            }
+        }
+    });
+}
+
+// Blur at 1/scaleX by 1/scaleY resolution: average blocks of src, blur them with the sigmas
+// scaled to match, and scale the result back up into dst.
+template <typename T, typename Proc>
+static bool downsampled_blur(Proc proc, const SkPixmap& src, SkIPoint srcOffset,
+                             double sigmaX, double sigmaY, int scaleX, int scaleY,
+                             const SkPixmap& dst, SkExecutor* executor) {
+    constexpr int C = sizeof(T);
+    int windowX = WindowForSigma(ScaledSigma(sigmaX, scaleX)),
+        windowY = WindowForSigma(ScaledSigma(sigmaY, scaleY));
+
+    // Pad the small blur by one pixel past its border, so the upsample fades to zero.
+    SkIPoint smallOffset = {BorderForWindow(windowX) + 1, BorderForWindow(windowY) + 1};
+    SkImageInfo smallSrcInfo = src.info().makeWH((src.width()  + scaleX - 1) / scaleX,
+                                                 (src.height() + scaleY - 1) / scaleY);
+    SkImageInfo smallDstInfo = src.info().makeWH(smallSrcInfo.width()  + 2 * smallOffset.x(),
+                                                 smallSrcInfo.height() + 2 * smallOffset.y());
+    size_t smallSrcSize = smallSrcInfo.computeMinByteSize(),
+           smallDstSize = smallDstInfo.computeMinByteSize();
+    if (SkImageInfo::ByteSizeOverflowed(smallSrcSize) ||
+        SkImageInfo::ByteSizeOverflowed(smallDstSize)) {
+        return false;
+    }
+    std::unique_ptr<char, SkFunctionWrapper<void(void*), sk_free>> storage{
+            (char*)sk_malloc_canfail(smallSrcSize + smallDstSize)};
+    if (!storage) {
+        return false;
+    }
+    SkPixmap smallSrc{smallSrcInfo, storage.get(), smallSrcInfo.minRowBytes()},
+             smallDst{smallDstInfo, storage.get() + smallSrcSize, smallDstInfo.minRowBytes()};
+
+    downsample<C>(src, scaleX, scaleY, smallSrc, executor);
+    if (!blur<T>(proc, smallSrc, smallOffset, windowX, windowY, smallDst, executor)) {
+        return false;
+    }
+    upsample<C>(smallDst, smallOffset, scaleX, scaleY, dst, srcOffset, executor);
+    return true;
+}
+
+bool Blur(const SkPixmap& src, SkIPoint srcOffset, int windowX, int windowY,
+          const SkPixmap& dst) {
+    return Blur(src, srcOffset, windowX, windowY, dst, &SkExecutor::GetDefault());
+}
+
+bool Blur(const SkPixmap& src, SkIPoint srcOffset, int windowX, int windowY,
+          const SkPixmap& dst, SkExecutor* executor) {
+    SkASSERT(src.colorType() == dst.colorType());
+    if (dst.width() <= 0 || dst.height() <= 0) {
+        return true;
+    }
+    if (src.width() <= 0 || src.height() <= 0) {
+        return dst.erase(SK_ColorTRANSPARENT);
+    }
+
+    switch (src.colorType()) {
+        case kN32_SkColorType:
+            return blur<uint32_t>(SkOpts::blur_rows_8888, src, srcOffset, windowX, windowY, dst,
+                                  executor);
+        case kAlpha_8_SkColorType:
+            return blur<uint8_t>(SkOpts::blur_rows_a8, src, srcOffset, windowX, windowY, dst,
+                                 executor);
+        default:
+            return false;
+    }
+}
+
+bool GaussianBlur(const SkPixmap& src, SkIPoint srcOffset, double sigmaX, double sigmaY,
+                  const SkPixmap& dst) {
+    return GaussianBlur(src, srcOffset, sigmaX, sigmaY, dst, &SkExecutor::GetDefault(),
+                        gSkBlurMaxDownsampleError);
+}
+
+bool GaussianBlur(const SkPixmap& src, SkIPoint srcOffset, double sigmaX, double sigmaY,
+                  const SkPixmap& dst, SkExecutor* executor, float maxError) {
+    SkASSERT(src.colorType() == dst.colorType());
+    int scaleX = DownsampleForSigma(sigmaX, maxError),
+        scaleY = DownsampleForSigma(sigmaY, maxError);
+    if ((scaleX == 1 && scaleY == 1) ||
+        dst.width() <= 0 || dst.height() <= 0 || src.width() <= 0 || src.height() <= 0) {
+        return Blur(src, srcOffset, WindowForSigma(sigmaX), WindowForSigma(sigmaY), dst,
+                    executor);
+    }
+
+    switch (src.colorType()) {
+        case kN32_SkColorType:
+            return downsampled_blur<uint32_t>(SkOpts::blur_rows_8888, src, srcOffset,
+                                              sigmaX, sigmaY, scaleX, scaleY, dst, executor);
+        case kAlpha_8_SkColorType:
+            return downsampled_blur<uint8_t>(SkOpts::blur_rows_a8, src, srcOffset,
+                                             sigmaX, sigmaY, scaleX, scaleY, dst, executor);
+        default:
+            return false;
+    }
+}
+
+}  // namespace SkBlurEngine
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBlurEngine_DEFINED
+#define SkBlurEngine_DEFINED
+
+#include "include/core/SkPoint.h"
+#include "include/core/SkTypes.h"
+
+#include <atomic>
+
+class SkExecutor;
+class SkPixmap;
+
+// One direction of the three box filter approximation of a Gaussian blur from the SVG spec
+// (https://drafts.fxtf.org/filter-effects/#feGaussianBlurElement), as run over the scanlines of
+// an image. Position d of a dst scanline is centered on position d - fSrcLeft of the src
+// scanline; src pixels outside of [0, fSrcWidth) are transparent black.
+struct SkBlurPass {
+    // The SkOpts blurs run this many uint32_t lanes of sums at a time.
+    static constexpr int kLanes = 8;
+
+    SkBlurPass(int window, int srcLeft, int srcWidth, int dstWidth);
+
+    // The number of uint32_ts of scratch the SkOpts blurs need for the trailing edges.
+    int scratchSize() const { return (fPass0Size + fPass1Size + fPass2Size) * kLanes; }
+
+    int      fWindow;
+    int      fBorder;       // How far a src pixel spreads in each direction.
+    int      fSrcLeft;
+    int      fSrcWidth;
+    int      fDstWidth;
+    int      fPass0Size, fPass1Size, fPass2Size;  // The trailing edges kept for each box.
+    uint32_t fWeight;       // 2^32 / the sum of the weights
+    uint32_t fHalf;         // Half the sum of the weights, to round the result.
+};
+
+// The blur behind the raster SkBlurImageFilter and SkMaskBlurFilter. Both directions scan
+// memory in order: the first pass blurs rows and writes them transposed, so the second pass
+// blurs the columns as rows of the transposed image and transposes them back. Each pass runs
+// several scanlines at a time in SIMD lanes (SkOpts::blur_rows_8888 and blur_rows_a8), and
+// large passes are split into stripes of scanlines that run in parallel on
+// SkExecutor::GetDefault(). Results do not depend on the executor.
+//
+// Large sigmas are blurred at reduced resolution: src is averaged down by a power of two in
+// each direction, blurred with the sigmas scaled to match, and bilinearly scaled back up.
+namespace SkBlurEngine {
+
+// The box size for sigma, as the spec computes it, pinned to 255. A window of 1 does not blur.
+int WindowForSigma(double sigma);
+
+// How far a blur with the window spreads a src pixel in each direction.
+int BorderForWindow(int window);
+
+// Blur src, which sits at srcOffset in dst, into dst; dst pixels too far from src are cleared.
+// src and dst must both be N32 or both be A8, with no overlap. Returns false if the color type
+// is not supported or the intermediate image could not be allocated.
+bool Blur(const SkPixmap& src, SkIPoint srcOffset, int windowX, int windowY,
+          const SkPixmap& dst);
+
+// Like Blur() above, which runs on SkExecutor::GetDefault(), but runs on executor, or only on
+// the calling thread if executor is null. For tests and benches.
+bool Blur(const SkPixmap& src, SkIPoint srcOffset, int windowX, int windowY,
+          const SkPixmap& dst, SkExecutor* executor);
+
+// The power of two to scale down by to blur sigma while adding no more than maxError (in 8-bit
+// units) to the result; 1 to blur at full resolution. Scaling starts once sigma reaches
+// 144 / maxError.
+int DownsampleForSigma(double sigma, float maxError);
+
+// The sigma that, blurred at 1/scale resolution, gives a blur of sigma.
+double ScaledSigma(double sigma, int scale);
+
+// Like Blur() with the windows for sigmaX and sigmaY, but blurs at reduced resolution in
+// directions where the sigma is large enough for gSkBlurMaxDownsampleError.
+bool GaussianBlur(const SkPixmap& src, SkIPoint srcOffset, double sigmaX, double sigmaY,
+                  const SkPixmap& dst);
+
+// Like GaussianBlur() above, but on executor (or the calling thread if null) and with maxError
+// in place of gSkBlurMaxDownsampleError. For tests and benches.
+bool GaussianBlur(const SkPixmap& src, SkIPoint srcOffset, double sigmaX, double sigmaY,
+                  const SkPixmap& dst, SkExecutor* executor, float maxError);
+
+}  // namespace SkBlurEngine
+
+// The most, in 8-bit units, that SkBlurEngine::GaussianBlur() may differ from a full resolution
+// blur by when it blurs large sigmas at reduced resolution. Raising it makes blurs cheaper from
+// a smaller sigma on; 0 always blurs at full resolution. Defaults to 2.
+extern std::atomic<float> gSkBlurMaxDownsampleError;
+
+#endif  // SkBlurEngine_DEFINED
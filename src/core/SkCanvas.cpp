@@ -8,6 +8,7 @@
 #include "include/core/SkCanvas.h"
 
 #include "include/core/SkColorFilter.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkPathEffect.h"
@@ -21,6 +22,7 @@
 #include "include/private/SkTo.h"
 #include "include/utils/SkNoDrawCanvas.h"
 #include "src/core/SkArenaAlloc.h"
+#include "src/core/SkBigPicture.h"
 #include "src/core/SkBitmapDevice.h"
 #include "src/core/SkCanvasPriv.h"
 #include "src/core/SkClipOpPriv.h"
@@ -35,6 +37,7 @@
 #include "src/core/SkMatrixPriv.h"
 #include "src/core/SkMatrixUtils.h"
 #include "src/core/SkPaintPriv.h"
+#include "src/core/SkPicturePriv.h"
 #include "src/core/SkRasterClip.h"
 #include "src/core/SkSpecialImage.h"
 #include "src/core/SkStrikeCache.h"
@@ -2530,6 +2533,26 @@ void SkCanvas::onDrawPicture(const SkPicture* picture, const SkMatrix* matrix,
         return;
     }
 
+    if (!paint && fProps.isParallelPicturePlayback() &&
+        this->topDevice()->onGetClipType() == SkBaseDevice::ClipType::kRect) {
+        if (const SkBigPicture* bp = SkPicturePriv::AsSkBigPicture(sk_ref_sp(picture))) {
+            this->predrawNotify();
+            SkPixmap pm;
+            SkBaseDevice* device = this->topDevice();
+            if (device->accessPixels(&pm)) {
+                SkM44 ctm = device->localToDevice44();
+                if (matrix) {
+                    ctm.preConcat(*matrix);
+                }
+                if (bp->tiledPlayback(pm, fProps, ctm, device->devClipBounds(),
+                                      kParallelPicturePlaybackTileSize,
+                                      SkExecutor::GetDefault())) {
+                    return;
+                }
+            }
+        }
+    }
+
     SkAutoCanvasMatrixPaint acmp(this, matrix, paint, picture->cullRect());
     picture->playback(this);
 }
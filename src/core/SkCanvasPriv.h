@@ -71,4 +71,10 @@ public:
  */
 constexpr int kMaxPictureOpsToUnrollInsteadOfRef = 1;
 
+/**
+ *  Width and height of the device-space tiles used when SkSurfaceProps requests parallel picture
+ *  playback. Kept a multiple of the dither pattern size so tile origins don't shift dithering.
+ */
+constexpr int kParallelPicturePlaybackTileSize = 256;
+
 #endif
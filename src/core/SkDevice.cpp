@@ -349,7 +349,8 @@ void SkBaseDevice::drawFilteredImage(const skif::Mapping& mapping, SkSpecialImag
                       skif::FilterResult<For::kInput>(sk_ref_sp(src)));
 
     SkIPoint offset;
-    sk_sp<SkSpecialImage> result = as_IFB(filter)->filterImage(ctx).imageAndOffset(&offset);
+    sk_sp<SkSpecialImage> result =
+            as_IFB(filter)->filterImageInTiles(ctx).imageAndOffset(&offset);
     if (result) {
         SkMatrix deviceMatrixWithOffset = mapping.deviceMatrix();
         deviceMatrixWithOffset.preTranslate(offset.fX, offset.fY);
@@ -10,6 +10,7 @@
 #include "include/private/SkSemaphore.h"
 #include "include/private/SkSpinlock.h"
 #include "include/private/SkTArray.h"
+#include "src/core/SkExecutorPriv.h"
 #include <deque>
 #include <thread>
 
@@ -54,6 +55,10 @@ void SkExecutor::SetDefault(SkExecutor* executor) {
     gDefaultExecutor = executor;
 }
 
+bool SkExecutorPriv::HasDefault() {
+    return gDefaultExecutor != nullptr;
+}
+
 // We'll always push_back() new work, but pop from the front of deques or the back of SkTArray.
 static inline std::function<void(void)> pop(std::deque<std::function<void(void)>>* list) {
     std::function<void(void)> fn = std::move(list->front());
@@ -0,0 +1,19 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkExecutorPriv_DEFINED
+#define SkExecutorPriv_DEFINED
+
+namespace SkExecutorPriv {
+
+// Whether SkExecutor::SetDefault() has installed an executor, rather than GetDefault() falling
+// back to one that runs all work right away on the calling thread.
+bool HasDefault();
+
+}  // namespace SkExecutorPriv
+
+#endif  // SkExecutorPriv_DEFINED
@@ -12,6 +12,7 @@
 #include "include/private/SkTo.h"
 #include "src/core/SkDraw.h"
 #include "src/core/SkFontPriv.h"
+#include "src/core/SkOpts.h"
 #include "src/core/SkPaintDefaults.h"
 #include "src/core/SkScalerCache.h"
 #include "src/core/SkScalerContext.h"
@@ -157,22 +158,14 @@ public:
     const SkUnichar* convert(const void* text, size_t byteLength, SkTextEncoding encoding) {
         const SkUnichar* uni;
         switch (encoding) {
-            case SkTextEncoding::kUTF8: {
+            case SkTextEncoding::kUTF8:
                 uni = fStorage.reset(byteLength);
-                const char* ptr = (const char*)text;
-                const char* end = ptr + byteLength;
-                for (int i = 0; ptr < end; ++i) {
-                    fStorage[i] = SkUTF::NextUTF8(&ptr, end);
-                }
-            } break;
-            case SkTextEncoding::kUTF16: {
+                SkOpts::utf8_to_utf32((const char*)text, byteLength, fStorage.get());
+                break;
+            case SkTextEncoding::kUTF16:
                 uni = fStorage.reset(byteLength);
-                const uint16_t* ptr = (const uint16_t*)text;
-                const uint16_t* end = ptr + (byteLength >> 1);
-                for (int i = 0; ptr < end; ++i) {
-                    fStorage[i] = SkUTF::NextUTF16(&ptr, end);
-                }
-            } break;
+                SkOpts::utf16_to_utf32((const uint16_t*)text, byteLength, fStorage.get());
+                break;
             case SkTextEncoding::kUTF32:
                 uni = (const SkUnichar*)text;
                 break;
@@ -404,7 +397,7 @@ SkRect SkFontPriv::GetFontBounds(const SkFont& font) {
 int SkFontPriv::CountTextElements(const void* text, size_t byteLength, SkTextEncoding encoding) {
     switch (encoding) {
         case SkTextEncoding::kUTF8:
-            return SkUTF::CountUTF8(reinterpret_cast<const char*>(text), byteLength);
+            return SkOpts::count_utf8(reinterpret_cast<const char*>(text), byteLength);
         case SkTextEncoding::kUTF16:
             return SkUTF::CountUTF16(reinterpret_cast<const uint16_t*>(text), byteLength);
         case SkTextEncoding::kUTF32:
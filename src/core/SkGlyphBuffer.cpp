@@ -68,6 +68,20 @@ void SkDrawableGlyphBuffer::startBitmapDevice(
     SkDEBUGCODE(fPhase = kInput);
 }
 
+void SkDrawableGlyphBuffer::startDrawable(SkSpan<SkGlyph* const> glyphs,
+                                          SkSpan<const SkPoint> positions,
+                                          SkVector offset) {
+    SkASSERT(glyphs.size() == positions.size());
+    SkASSERT(glyphs.size() <= fMaxSize);
+    fInputSize = glyphs.size();
+    fDrawableSize = glyphs.size();
+    for (size_t i = 0; i < glyphs.size(); i++) {
+        fMultiBuffer[i] = glyphs[i];
+        fPositions[i] = positions[i] + offset;
+    }
+    SkDEBUGCODE(fPhase = kProcess);
+}
+
 void SkDrawableGlyphBuffer::startGPUDevice(
         const SkZip<const SkGlyphID, const SkPoint>& source,
         const SkMatrix& drawMatrix,
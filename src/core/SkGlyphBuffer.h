@@ -172,6 +172,11 @@ public:
             const SkMatrix& drawMatrix,
             const SkGlyphPositionRoundingSpec& roundingSpec);
 
+    // Load the buffer with glyphs ready to draw, as recorded from an earlier drawable(), with
+    // their positions moved by offset.
+    void startDrawable(SkSpan<SkGlyph* const> glyphs, SkSpan<const SkPoint> positions,
+                       SkVector offset);
+
     SkString dumpInput() const;
 
     // The input of SkPackedGlyphIDs
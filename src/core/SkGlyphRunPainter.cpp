@@ -29,11 +29,13 @@
 #include "src/core/SkDraw.h"
 #include "src/core/SkEnumerate.h"
 #include "src/core/SkFontPriv.h"
+#include "src/core/SkPaintPriv.h"
 #include "src/core/SkRasterClip.h"
 #include "src/core/SkScalerCache.h"
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeForGPU.h"
 #include "src/core/SkStrikeSpec.h"
+#include "src/core/SkTextBlobRasterCache.h"
 #include "src/core/SkTraceEvent.h"
 
 #include <climits>
@@ -78,6 +80,51 @@ SkGlyphRunListPainter::SkGlyphRunListPainter(const GrSurfaceDrawContext& rtc)
 
 #endif
 
+// Whether any of the runs' strikes position glyphs by sub-pixel; their rounding specs follow
+// their fonts.
+static bool uses_subpixel_positions(const SkGlyphRunList& glyphRunList) {
+    for (const SkGlyphRun& glyphRun : glyphRunList) {
+        if (glyphRun.font().isSubpixel()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool make_raster_cache_key(const SkGlyphRunList& glyphRunList,
+                                  const SkPaint& paint,
+                                  const SkSurfaceProps& props,
+                                  SkScalerContextFlags scalerContextFlags,
+                                  const SkMatrix& deviceMatrix,
+                                  SkPoint mappedOrigin,
+                                  bool subpixel,
+                                  SkTextBlobRasterCache::Key* key) {
+    // The paint may only change the glyph masks through its luminance color.
+    if (!glyphRunList.canCache() || deviceMatrix.hasPerspective() || !deviceMatrix.isFinite() ||
+        !mappedOrigin.isFinite() || paint.getStyle() != SkPaint::kFill_Style ||
+        paint.getPathEffect() != nullptr || paint.getMaskFilter() != nullptr) {
+        return false;
+    }
+
+    // Zero out any padding so the key can be compared and hashed as bytes.
+    memset(key, 0, sizeof(*key));
+    key->fBlobID = glyphRunList.blob()->uniqueID();
+    key->fScalerContextFlags = SkTo<uint32_t>(scalerContextFlags);
+    key->fSurfacePropsFlags = props.flags();
+    key->fPixelGeometry = props.pixelGeometry();
+    key->fLuminanceColor = SkPaintPriv::ComputeLuminanceColor(paint);
+    key->fScaleX = deviceMatrix.getScaleX();
+    key->fSkewX  = deviceMatrix.getSkewX();
+    key->fSkewY  = deviceMatrix.getSkewY();
+    key->fScaleY = deviceMatrix.getScaleY();
+    // Without sub-pixel positions the glyph images don't depend on where the origin lands.
+    if (subpixel) {
+        key->fOriginFraction = {mappedOrigin.x() - SkScalarFloorToScalar(mappedOrigin.x()),
+                                mappedOrigin.y() - SkScalarFloorToScalar(mappedOrigin.y())};
+    }
+    return true;
+}
+
 void SkGlyphRunListPainter::drawForBitmapDevice(
         const SkGlyphRunList& glyphRunList, const SkPaint& paint, const SkMatrix& deviceMatrix,
         const BitmapDevicePainter* bitmapDevice) {
@@ -94,12 +141,41 @@ void SkGlyphRunListPainter::drawForBitmapDevice(
                   : fBitmapFallbackProps;
 
     SkPoint drawOrigin = glyphRunList.origin();
+
+    // A blob drawn again the same way draws the glyphs found the last time it was drawn.
+    SkTextBlobRasterCache* blobCache = SkTextBlobRasterCache::GlobalCache();
+    SkPoint mappedOrigin = deviceMatrix.mapXY(drawOrigin.x(), drawOrigin.y());
+    SkTextBlobRasterCache::Key cacheKey;
+    sk_sp<SkTextBlobRasterCache::Entry> newEntry;
+    const bool subpixel = uses_subpixel_positions(glyphRunList);
+    if (make_raster_cache_key(glyphRunList, paint, props, fScalerContextFlags, deviceMatrix,
+                              mappedOrigin, subpixel, &cacheKey)) {
+        if (auto entry = blobCache->find(cacheKey)) {
+            // With sub-pixel positions the origins only differ by whole pixels. Without, the
+            // recorded positions are moved exactly, and rounded when drawn as they'd be anew.
+            SkVector offset = mappedOrigin - entry->fMappedOrigin;
+            if (subpixel) {
+                offset = {SkScalarRoundToScalar(offset.x()), SkScalarRoundToScalar(offset.y())};
+            }
+            for (const auto& run : entry->fRuns) {
+                fDrawable.startDrawable(SkMakeSpan(run.fGlyphs), SkMakeSpan(run.fPositions),
+                                        offset);
+                bitmapDevice->paintMasks(&fDrawable, paint);
+            }
+            return;
+        }
+        newEntry = sk_make_sp<SkTextBlobRasterCache::Entry>(cacheKey);
+        newEntry->fMappedOrigin = mappedOrigin;
+    }
+
     for (auto& glyphRun : glyphRunList) {
         const SkFont& runFont = glyphRun.font();
 
         fRejects.setSource(glyphRun.source());
 
         if (SkStrikeSpec::ShouldDrawAsPath(paint, runFont, deviceMatrix)) {
+            // Only blobs drawn entirely as masks are cached.
+            newEntry = nullptr;
 
             SkStrikeSpec strikeSpec = SkStrikeSpec::MakePath(
                     runFont, paint, props, fScalerContextFlags);
@@ -128,9 +204,21 @@ void SkGlyphRunListPainter::drawForBitmapDevice(
                     fRejects.source(), drawOrigin, deviceMatrix, strike->roundingSpec());
             strike->prepareForDrawingMasksCPU(&fDrawable);
             fRejects.flipRejectsToSource();
+            if (newEntry) {
+                SkTextBlobRasterCache::Run& run = newEntry->fRuns.emplace_back();
+                for (auto [variant, pos] : fDrawable.drawable()) {
+                    run.fGlyphs.push_back(variant.glyph());
+                    run.fPositions.push_back(pos);
+                }
+                newEntry->fGlyphCount += run.fGlyphs.size();
+                fDrawable.startDrawable(SkMakeSpan(run.fGlyphs), SkMakeSpan(run.fPositions),
+                                        {0, 0});
+                run.fStrike = std::move(strike);
+            }
             bitmapDevice->paintMasks(&fDrawable, paint);
         }
         if (!fRejects.source().empty()) {
+            newEntry = nullptr;
             SkMatrix runMatrix = deviceMatrix;
             runMatrix.preTranslate(drawOrigin.x(), drawOrigin.y());
             std::vector<SkPoint> sourcePositions;
@@ -218,6 +306,10 @@ void SkGlyphRunListPainter::drawForBitmapDevice(
         // TODO: have the mask stage above reject the glyphs that are too big, and handle the
         //  rejects in a more sophisticated stage.
     }
+
+    if (newEntry) {
+        blobCache->add(std::move(newEntry), *glyphRunList.blob());
+    }
 }
 
 // Use the following in your args.gn to dump telemetry for diagnosing chrome Renderer/GPU
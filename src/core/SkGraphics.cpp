@@ -24,8 +24,10 @@
 #include "src/core/SkResourceCache.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrikeCache.h"
+#include "src/core/SkTextBlobRasterCache.h"
 #include "src/core/SkTSearch.h"
 #include "src/core/SkTypefaceCache.h"
+#include "src/core/SkVM.h"
 
 #include <stdlib.h>
 
@@ -120,7 +122,21 @@ int SkGraphics::GetFontCacheCountUsed() {
     return SkStrikeCache::GlobalStrikeCache()->getCacheCountUsed();
 }
 
+bool SkGraphics::SaveFontCache(const char path[]) {
+    return SkStrikeStore::Write(*SkStrikeCache::GlobalStrikeCache(), path);
+}
+
+bool SkGraphics::LoadFontCache(const char path[]) {
+    sk_sp<SkStrikeStore> store = SkStrikeStore::Make(path);
+    if (!store) {
+        return false;
+    }
+    SkStrikeCache::GlobalStrikeCache()->setStrikeStore(std::move(store));
+    return true;
+}
+
 void SkGraphics::PurgeFontCache() {
+    SkTextBlobRasterCache::GlobalCache()->purgeAll();
     SkStrikeCache::GlobalStrikeCache()->purgeAll();
     SkTypefaceCache::PurgeAll();
 }
@@ -130,3 +146,16 @@ extern bool gSkVMAllowJIT;
 void SkGraphics::AllowJIT() {
     gSkVMAllowJIT = true;
 }
+
+bool SkGraphics::SaveJITCodeCache(const char path[]) {
+    return skvm::save_jit_cache(path);
+}
+
+bool SkGraphics::LoadJITCodeCache(const char path[]) {
+    return skvm::load_jit_cache(path);
+}
+
+SkGraphics::JITCodeCacheStats SkGraphics::GetJITCodeCacheStats() {
+    skvm::JITCacheStats stats = skvm::jit_cache_stats();
+    return { stats.hits, stats.misses, stats.jit_ms, stats.saved_ms };
+}
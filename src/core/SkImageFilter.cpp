@@ -8,8 +8,11 @@
 #include "include/core/SkImageFilter.h"
 
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkRect.h"
+#include "include/core/SkRegion.h"
 #include "include/private/SkSafe32.h"
+#include "src/core/SkExecutorPriv.h"
 #include "src/core/SkFuzzLogging.h"
 #include "src/core/SkImageFilterCache.h"
 #include "src/core/SkImageFilter_Base.h"
@@ -18,6 +21,7 @@
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkSpecialImage.h"
 #include "src/core/SkSpecialSurface.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkValidationUtils.h"
 #include "src/core/SkWriteBuffer.h"
 #if SK_SUPPORT_GPU
@@ -217,7 +221,136 @@ void SkImageFilter_Base::flatten(SkWriteBuffer& buffer) const {
     buffer.writeUInt(fCropRect.flags());
 }
 
+// The number of nodes on the paths through the filter DAG, counting shared nodes once per path,
+// but no more than 'limit'.
+static int count_nodes(const SkImageFilter* filter, int limit) {
+    int count = 1;
+    for (int i = 0; i < filter->countInputs() && count < limit; ++i) {
+        if (const SkImageFilter* input = filter->getInput(i)) {
+            count += count_nodes(input, limit - count);
+        }
+    }
+    return std::min(count, limit);
+}
+
+// Some filters treat the edges of their desired output unlike the interior (lighting takes
+// one-sided normals there), and each node of a DAG can move such edges in by another pixel. So
+// what a DAG outputs for one desired output only matches what it outputs for another from
+// edge_apron() pixels in from the edges the two don't share. DAGs of kMaxEdgeApron or more nodes
+// aren't counted any further.
+static constexpr int kMaxEdgeApron = 16;
+
+static int edge_apron(const SkImageFilter* filter) {
+    return count_nodes(filter, kMaxEdgeApron);
+}
+
+// The part of 'valid', which holds the output of a filter as filtered for other clip bounds, that
+// matches what filtering for 'clip' gives: their intersection, less 'apron' pixels along each edge
+// the two don't share. Empty if there's no such part, or if the apron is too big to know.
+static SkIRect reusable_bounds(const SkIRect& valid, const SkIRect& clip, int apron) {
+    SkIRect reusable;
+    if (!reusable.intersect(valid, clip)) {
+        return SkIRect::MakeEmpty();
+    }
+    if (valid == clip) {
+        return reusable;
+    }
+    if (apron >= kMaxEdgeApron) {
+        return SkIRect::MakeEmpty();
+    }
+    if (valid.fLeft   != clip.fLeft)   { reusable.fLeft   += apron; }
+    if (valid.fTop    != clip.fTop)    { reusable.fTop    += apron; }
+    if (valid.fRight  != clip.fRight)  { reusable.fRight  -= apron; }
+    if (valid.fBottom != clip.fBottom) { reusable.fBottom -= apron; }
+    return reusable.isEmpty() ? SkIRect::MakeEmpty() : reusable;
+}
+
+// Replaces the pixels of canvas within 'valid' with those of 'result', which is in the canvas'
+// layer space.
+static void draw_result(SkCanvas* canvas, const skif::FilterResult<For::kOutput>& result,
+                        const SkIRect& valid) {
+    if (result.image()) {
+        SkPaint paint;
+        paint.setBlendMode(SkBlendMode::kSrc);
+        canvas->save();
+        canvas->clipIRect(valid);
+        result.image()->draw(canvas, result.layerOrigin().x(), result.layerOrigin().y(),
+                             SkSamplingOptions(), &paint);
+        canvas->restore();
+    }
+}
+
+namespace {
+// Part of the output of a filter: 'fResult' holds the output within 'fValid'.
+struct PartialResult {
+    skif::FilterResult<For::kOutput> fResult;
+    SkIRect                          fValid;
+};
+}  // anonymous namespace
+
+// Pieces together the output of a filter from 'parts', which together cover the context's clip
+// bounds.
+static skif::FilterResult<For::kOutput> combine_results(const skif::Context& context,
+                                                        const SkTArray<PartialResult>& parts) {
+    SkIRect bounds = SkIRect::MakeEmpty();
+    for (const PartialResult& part : parts) {
+        SkIRect valid;
+        if (part.fResult.image() &&
+            valid.intersect(static_cast<const SkIRect&>(part.fResult.layerBounds()),
+                            part.fValid)) {
+            bounds.join(valid);
+        }
+    }
+    if (!bounds.intersect(context.clipBounds())) {
+        return {};
+    }
+
+    sk_sp<SkSpecialSurface> surf(context.makeSurface(bounds.size()));
+    if (!surf) {
+        return {};
+    }
+    SkCanvas* canvas = surf->getCanvas();
+    canvas->clear(SK_ColorTRANSPARENT);
+    canvas->translate(-bounds.left(), -bounds.top());
+
+    // Where parts overlap they are all valid, so later ones can just replace earlier ones.
+    for (const PartialResult& part : parts) {
+        draw_result(canvas, part.fResult, part.fValid);
+    }
+
+    return skif::FilterResult<For::kOutput>(surf->makeImageSnapshot(),
+                                            skif::LayerSpace<SkIPoint>(bounds.topLeft()));
+}
+
+// filterImageInTiles() filters tiles of at most kTileSize x kTileSize, and starts no more tiles at
+// once than their estimated scratch memory fits in kMaxTileBytesInFlight. It doesn't tile DAGs
+// whose tiles would read more than kMaxTileOverhead times the input of the whole output.
+static constexpr int    kTileSize             = 512;
+static constexpr size_t kMaxTileBytesInFlight = 64 * 1024 * 1024;
+static constexpr double kMaxTileOverhead      = 1.25;
+
 skif::FilterResult<For::kOutput> SkImageFilter_Base::filterImage(const skif::Context& context) const {
+    return this->filterImage(context, nullptr);
+}
+
+skif::FilterResult<For::kOutput> SkImageFilter_Base::filterImageInTiles(
+        const skif::Context& context) const {
+    // Tiles only pay off when they are filtered in parallel, and the default executor just runs
+    // them one after another until SkExecutor::SetDefault() installs a real one.
+    if (!SkExecutorPriv::HasDefault()) {
+        return this->filterImage(context);
+    }
+    return this->filterImageInTiles(context, &SkExecutor::GetDefault(), kTileSize);
+}
+
+skif::FilterResult<For::kOutput> SkImageFilter_Base::filterImageInTiles(
+        const skif::Context& context, SkExecutor* executor, int tileSize) const {
+    const Tiling tiling{executor, tileSize};
+    return this->filterImage(context, &tiling);
+}
+
+skif::FilterResult<For::kOutput> SkImageFilter_Base::filterImage(const skif::Context& context,
+                                                                 const Tiling* tiling) const {
     // TODO (michaelludwig) - Old filters have an implicit assumption that the source image
     // (originally passed separately) has an origin of (0, 0). SkComposeImageFilter makes an effort
     // to ensure that remains the case. Once everyone uses the new type systems for bounds, non
@@ -235,11 +368,39 @@ skif::FilterResult<For::kOutput> SkImageFilter_Base::filterImage(const skif::Con
 
     SkImageFilterCacheKey key(fUniqueID, context.mapping().layerMatrix(), context.clipBounds(),
                               srcGenID, srcSubset);
-    if (context.cache() && context.cache()->get(key, &result)) {
-        return result;
+    auto filter = [&](const skif::Context& ctx) {
+        return tiling && !ctx.gpuBacked() ? this->filterTiles(ctx, *tiling)
+                                          : this->onFilterImage(ctx);
+    };
+    skif::LayerSpace<SkIRect> validBounds;
+    SkIRect reusable = SkIRect::MakeEmpty();
+    int apron = 0;
+    if (context.cache() && context.cache()->find(key, &result, &validBounds)) {
+        apron = edge_apron(this);
+        reusable = reusable_bounds(SkIRect(validBounds), context.clipBounds(), apron);
+        if (reusable == context.clipBounds()) {
+            return result;
+        }
+    }
+    if (!reusable.isEmpty()) {
+        // The cache holds part of the output, as computed for other clip bounds (e.g. before a
+        // scroll), so just filter the rest, a few rects at most. Each is filtered with an apron,
+        // so that its edges inside the clip bounds are left out.
+        SkSTArray<5, PartialResult> parts;
+        parts.push_back({std::move(result), reusable});
+        SkRegion exposed(context.clipBounds());
+        exposed.op(reusable, SkRegion::kDifference_Op);
+        for (SkRegion::Iterator iter(exposed); !iter.done(); iter.next()) {
+            SkIRect desired = iter.rect().makeOutset(apron, apron);
+            SkAssertResult(desired.intersect(context.clipBounds()));
+            parts.push_back({filter(context.withNewDesiredOutput(
+                                     skif::LayerSpace<SkIRect>(desired))),
+                             iter.rect()});
+        }
+        result = combine_results(context, parts);
+    } else {
+        result = filter(context);
     }
-
-    result = this->onFilterImage(context);
 
     if (context.gpuBacked()) {
         SkASSERT(!result.image() || result.image()->isTextureBacked());
@@ -252,6 +413,122 @@ skif::FilterResult<For::kOutput> SkImageFilter_Base::filterImage(const skif::Con
     return result;
 }
 
+skif::FilterResult<For::kOutput> SkImageFilter_Base::filterTiles(const skif::Context& context,
+                                                                 const Tiling& tiling) const {
+    const SkIRect& bounds = context.clipBounds();
+    const int tileSize = std::max(tiling.fTileSize, 1);
+    if (bounds.isEmpty() || (bounds.width() <= tileSize && bounds.height() <= tileSize)) {
+        return this->onFilterImage(context);
+    }
+    const int cols = (bounds.width()  - 1) / tileSize + 1,
+              rows = (bounds.height() - 1) / tileSize + 1,
+              tiles = cols * rows;
+    auto tileBounds = [&](int i) {
+        SkIRect tile = SkIRect::MakeXYWH(bounds.left() + (i % cols) * tileSize,
+                                         bounds.top()  + (i / cols) * tileSize,
+                                         tileSize, tileSize);
+        SkAssertResult(tile.intersect(bounds));
+        return tile;
+    };
+
+    // Each tile is filtered with an edge_apron() outset, except along the clip bounds, and only the
+    // tile itself is kept. DAGs too deep for that are filtered whole.
+    const int apron = edge_apron(this);
+    if (apron >= kMaxEdgeApron) {
+        return this->onFilterImage(context);
+    }
+    auto tileOutput = [&](int i) {
+        SkIRect output = tileBounds(i).makeOutset(apron, apron);
+        SkAssertResult(output.intersect(bounds));
+        return output;
+    };
+
+    // The layer bounds the DAG reads for an output, and the part of the source within them.
+    const skif::LayerSpace<SkIRect> sourceBounds = context.source().layerBounds();
+    auto inputBounds = [&](const SkIRect& output) {
+        return SkIRect(this->onGetInputLayerBounds(
+                context.mapping(), skif::LayerSpace<SkIRect>(output), sourceBounds));
+    };
+    auto inputArea = [&](const SkIRect& output) {
+        SkIRect input = inputBounds(output);
+        return input.intersect(SkIRect(sourceBounds)) ? sk_64_mul(input.width(), input.height())
+                                                      : 0;
+    };
+
+    // The scratch memory a tile needs: every node (the apron counts them) may leave an image as
+    // large as the tile with its input margins, held in flight or by the tile's cache.
+    const double bytesPerPixel = SkColorTypeBytesPerPixel(context.colorType());
+    SkAutoTArray<size_t> tileBytes(tiles);
+    int64_t tiledInputArea = 0;
+    for (int i = 0; i < tiles; ++i) {
+        const SkIRect output = tileOutput(i);
+        tiledInputArea += inputArea(output);
+        SkIRect scratch = inputBounds(output);
+        scratch.join(output);
+        const double bytes = bytesPerPixel * apron * scratch.width() * scratch.height();
+        tileBytes[i] = bytes < kMaxTileBytesInFlight ? static_cast<size_t>(bytes)
+                                                     : kMaxTileBytesInFlight;
+    }
+    // Tiles each read the margins they share with their neighbors, so DAGs that need wide
+    // margins, like large blurs (which run in parallel on their own), are filtered whole.
+    if (tiledInputArea > inputArea(bounds) * kMaxTileOverhead) {
+        return this->onFilterImage(context);
+    }
+
+    sk_sp<SkSpecialSurface> surf(context.makeSurface(bounds.size()));
+    if (!surf) {
+        return {};
+    }
+    SkCanvas* canvas = surf->getCanvas();
+    canvas->clear(SK_ColorTRANSPARENT);
+    canvas->translate(-bounds.left(), -bounds.top());
+
+    SkAutoTArray<skif::FilterResult<For::kOutput>> results(tiles);
+    auto filterTile = [&](int i) {
+        // The tiles don't share intermediate images, and a tile's are freed once it is drawn.
+        // Its cache holds no more than the tile was budgeted for.
+        sk_sp<SkImageFilterCache> cache(SkImageFilterCache::Create(tileBytes[i]));
+        skif::Context tileContext(context.mapping(), skif::LayerSpace<SkIRect>(tileOutput(i)),
+                                  cache.get(), context.colorType(), context.colorSpace(),
+                                  context.source());
+        results[i] = this->onFilterImage(tileContext);
+    };
+
+    bool drewAny = false;
+    for (int first = 0, last; first < tiles; first = last) {
+        // Filter as many tiles at once as fit in the memory budget, but at least one.
+        size_t bytes = tileBytes[first];
+        for (last = first + 1; last < tiles; ++last) {
+            if (bytes + tileBytes[last] > kMaxTileBytesInFlight) {
+                break;
+            }
+            bytes += tileBytes[last];
+        }
+
+        if (tiling.fExecutor && last - first > 1) {
+            SkTaskGroup taskGroup(*tiling.fExecutor);
+            taskGroup.batch(last - first, [&](int i) { filterTile(first + i); });
+            taskGroup.wait();
+        } else {
+            for (int i = first; i < last; ++i) {
+                filterTile(i);
+            }
+        }
+
+        for (int i = first; i < last; ++i) {
+            drewAny |= results[i].image() != nullptr;
+            draw_result(canvas, results[i], tileBounds(i));
+            results[i] = {};
+        }
+    }
+    if (!drewAny) {
+        return {};
+    }
+
+    return skif::FilterResult<For::kOutput>(surf->makeImageSnapshot(),
+                                            skif::LayerSpace<SkIPoint>(bounds.topLeft()));
+}
+
 skif::LayerSpace<SkIRect> SkImageFilter_Base::getInputBounds(
         const skif::Mapping& mapping, const skif::DeviceSpace<SkIRect>& desiredOutput,
         const skif::ParameterSpace<SkRect>* knownContentBounds) const {
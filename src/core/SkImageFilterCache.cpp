@@ -7,6 +7,7 @@
 
 #include "src/core/SkImageFilterCache.h"
 
+#include <cmath>
 #include <vector>
 
 #include "include/core/SkImageFilter.h"
@@ -30,18 +31,33 @@ namespace {
 class CacheImpl : public SkImageFilterCache {
 public:
     typedef SkImageFilterCacheKey Key;
-    CacheImpl(size_t maxBytes) : fMaxBytes(maxBytes), fCurrentBytes(0) { }
+    CacheImpl(size_t maxBytes, Mode mode) : fMaxBytes(maxBytes), fCurrentBytes(0), fMode(mode) { }
     ~CacheImpl() override {
         fLookup.foreach([&](Value* v) { delete v; });
     }
+    struct Value;
+    // A Value as found by its region key; see RegionKey().
+    struct Region {
+        Key fKey;
+        SkIVector fTranslate;
+        Value* fValue;
+        static const Key& GetKey(const Region& r) {
+            return r.fKey;
+        }
+        static uint32_t Hash(const Key& key) {
+            return Value::Hash(key);
+        }
+    };
     struct Value {
         Value(const Key& key, const skif::FilterResult<For::kOutput>& image,
               const SkImageFilter* filter)
-            : fKey(key), fImage(image), fFilter(filter) {}
+            : fKey(key), fImage(image), fFilter(filter)
+            , fRegion(MakeRegion(key, this)) {}
 
         Key fKey;
         skif::FilterResult<For::kOutput> fImage;
         const SkImageFilter* fFilter;
+        Region fRegion;
         static const Key& GetKey(const Value& v) {
             return v.fKey;
         }
@@ -56,14 +72,50 @@ public:
 
         SkAutoMutexExclusive mutex(fMutex);
         if (Value* v = fLookup.find(key)) {
-            if (v != fLRU.head()) {
-                fLRU.remove(v);
-                fLRU.addToHead(v);
-            }
+            this->touch(v);
+            *result = v->fImage;
+            return true;
+        }
+        return false;
+    }
+
+    bool find(const Key& key, skif::FilterResult<For::kOutput>* result,
+              skif::LayerSpace<SkIRect>* validBounds) const override {
+        SkASSERT(result && validBounds);
 
+        SkAutoMutexExclusive mutex(fMutex);
+        if (Value* v = fLookup.find(key)) {
+            this->touch(v);
             *result = v->fImage;
+            *validBounds = skif::LayerSpace<SkIRect>(key.fClipBounds);
+            fStats.fHits++;
             return true;
         }
+
+        if (fMode == Mode::kRegions) {
+            SkIVector translate;
+            if (Region* region = fRegions.find(RegionKey(key, &translate))) {
+                Value* v = region->fValue;
+                SkIVector shift = translate - region->fTranslate;
+                SkIRect valid = v->fKey.fClipBounds.makeOffset(shift);
+                if (SkIRect::Intersects(valid, key.fClipBounds)) {
+                    this->touch(v);
+                    const skif::LayerSpace<SkIPoint>& origin = v->fImage.layerOrigin();
+                    *result = skif::FilterResult<For::kOutput>(
+                            v->fImage.refImage(),
+                            skif::LayerSpace<SkIPoint>({origin.x() + shift.fX,
+                                                        origin.y() + shift.fY}));
+                    *validBounds = skif::LayerSpace<SkIRect>(valid);
+                    if (valid.contains(key.fClipBounds)) {
+                        fStats.fHits++;
+                    } else {
+                        fStats.fPartialHits++;
+                    }
+                    return true;
+                }
+            }
+        }
+        fStats.fMisses++;
         return false;
     }
 
@@ -76,6 +128,13 @@ public:
         Value* v = new Value(key, result, filter);
         fLookup.add(v);
         fLRU.addToHead(v);
+        if (fMode == Mode::kRegions) {
+            // Later results replace earlier ones; they are the likeliest to overlap what's next.
+            if (fRegions.find(v->fRegion.fKey)) {
+                fRegions.remove(v->fRegion.fKey);
+            }
+            fRegions.add(&v->fRegion);
+        }
         fCurrentBytes += result.image() ? result.image()->getSize() : 0;
         if (auto* values = fImageFilterValues.find(filter)) {
             values->push_back(v);
@@ -117,8 +176,60 @@ public:
         fImageFilterValues.remove(filter);
     }
 
+    Mode mode() const override {
+        SkAutoMutexExclusive mutex(fMutex);
+        return fMode;
+    }
+
+    void setMode(Mode mode) override {
+        SkAutoMutexExclusive mutex(fMutex);
+        if (mode != Mode::kRegions) {
+            fRegions.rewind();
+        }
+        fMode = mode;
+    }
+
+    Stats stats() const override {
+        SkAutoMutexExclusive mutex(fMutex);
+        Stats stats = fStats;
+        stats.fBytes = fCurrentBytes;
+        return stats;
+    }
+
     SkDEBUGCODE(int count() const override { return fLookup.count(); })
 private:
+    // Results whose keys differ only in clip bounds share a region key. So do the results of
+    // filters that don't read their source (and so have no source generation ID) when their
+    // affine layer matrices differ only by whole pixels of translation; those are returned in
+    // 'translate' and left out of the key.
+    static Key RegionKey(const Key& key, SkIVector* translate) {
+        SkMatrix matrix = key.fMatrix;
+        *translate = {0, 0};
+        // Larger translates are left in the key rather than risk overflowing translate.
+        constexpr float kMaxTranslate = 1 << 24;
+        if (key.fSrcGenID == 0 && !matrix.hasPerspective() &&
+            std::abs(matrix.getTranslateX()) < kMaxTranslate &&
+            std::abs(matrix.getTranslateY()) < kMaxTranslate) {
+            float tx = std::floor(matrix.getTranslateX()),
+                  ty = std::floor(matrix.getTranslateY());
+            *translate = {(int)tx, (int)ty};
+            matrix.setTranslateX(matrix.getTranslateX() - tx);
+            matrix.setTranslateY(matrix.getTranslateY() - ty);
+        }
+        return Key(key.fUniqueID, matrix, SkIRect::MakeEmpty(), key.fSrcGenID, key.fSrcSubset);
+    }
+    static Region MakeRegion(const Key& key, Value* value) {
+        SkIVector translate;
+        Key regionKey = RegionKey(key, &translate);
+        return {regionKey, translate, value};
+    }
+    void touch(Value* v) const {
+        if (v != fLRU.head()) {
+            fLRU.remove(v);
+            fLRU.addToHead(v);
+        }
+    }
+
     void removeInternal(Value* v) {
         if (v->fFilter) {
             if (auto* values = fImageFilterValues.find(v->fFilter)) {
@@ -134,6 +245,9 @@ private:
                 }
             }
         }
+        if (fRegions.find(v->fRegion.fKey) == &v->fRegion) {
+            fRegions.remove(v->fRegion.fKey);
+        }
         fCurrentBytes -= v->fImage.image() ? v->fImage.image()->getSize() : 0;
         fLRU.remove(v);
         fLookup.remove(v->fKey);
@@ -144,15 +258,19 @@ private:
     mutable SkTInternalLList<Value>                       fLRU;
     // Value* always points to an item in fLookup.
     SkTHashMap<const SkImageFilter*, std::vector<Value*>> fImageFilterValues;
+    // The latest Value for each region key, in kRegions mode.
+    SkTDynamicHash<Region, Key>                           fRegions;
     size_t                                                fMaxBytes;
     size_t                                                fCurrentBytes;
+    Mode                                                  fMode;
+    mutable Stats                                         fStats;
     mutable SkMutex                                       fMutex;
 };
 
 } // namespace
 
-SkImageFilterCache* SkImageFilterCache::Create(size_t maxBytes) {
-    return new CacheImpl(maxBytes);
+SkImageFilterCache* SkImageFilterCache::Create(size_t maxBytes, Mode mode) {
+    return new CacheImpl(maxBytes, mode);
 }
 
 SkImageFilterCache* SkImageFilterCache::Get() {
@@ -49,26 +49,56 @@ struct SkImageFilterCacheKey {
 // This cache maps from (filter's unique ID + CTM + clipBounds + src bitmap generation ID) to result
 // NOTE: this is the _specific_ unique ID of the image filter, so refiltering the same image with a
 // copy of the image filter (with exactly the same parameters) will not yield a cache hit.
+//
+// In kRegions mode, results are also found for other clip bounds, and, for filters that do not
+// read their source, for layer matrices that differ only by whole pixels of translation: the
+// result is moved by that translation, and its pixels are only used where they were computed for
+// the old clip bounds. SkImageFilter_Base::filterImage() also leaves out a few pixels along the
+// edges the old and new clip bounds don't share, since filters may treat the edges of their
+// output specially. This lets a scrolled or partially re-clipped filter reuse what it already
+// computed and only filter the newly exposed area.
 class SkImageFilterCache : public SkRefCnt {
 public:
     SK_USE_FLUENT_IMAGE_FILTER_TYPES_IN_CLASS
 
     enum { kDefaultTransientSize = 32 * 1024 * 1024 };
 
+    enum class Mode {
+        kExact,    // Results are only found for identical keys.
+        kRegions,  // Results are also found by overlapping regions, as described above.
+    };
+
+    struct Stats {
+        int    fHits        = 0;  // find() returned a result covering the clip bounds.
+        int    fPartialHits = 0;  // find() returned a result covering part of the clip bounds.
+        int    fMisses      = 0;  // find() returned nothing.
+        size_t fBytes       = 0;  // The size of the cached images.
+    };
+
     ~SkImageFilterCache() override {}
-    static SkImageFilterCache* Create(size_t maxBytes);
+    static SkImageFilterCache* Create(size_t maxBytes, Mode mode = Mode::kExact);
     static SkImageFilterCache* Get();
 
     // Returns true on cache hit and updates 'result' to be the cached result. Returns false when
     // not in the cache, in which case 'result' is not modified.
     virtual bool get(const SkImageFilterCacheKey& key,
                      skif::FilterResult<For::kOutput>* result) const = 0;
+    // Like get(), but in kRegions mode also finds overlapping results as described above, and
+    // counts the lookup in stats(). On success, 'validBounds' is set to the layer-space bounds
+    // in which 'result' holds the filter's output; it may differ from the output elsewhere.
+    virtual bool find(const SkImageFilterCacheKey& key,
+                      skif::FilterResult<For::kOutput>* result,
+                      skif::LayerSpace<SkIRect>* validBounds) const = 0;
     // 'filter' is included in the caching to allow the purging of all of an image filter's cached
     // results when it is destroyed.
     virtual void set(const SkImageFilterCacheKey& key, const SkImageFilter* filter,
                      const skif::FilterResult<For::kOutput>& result) = 0;
     virtual void purge() = 0;
     virtual void purgeByImageFilter(const SkImageFilter*) = 0;
+
+    virtual Mode mode() const = 0;
+    virtual void setMode(Mode) = 0;
+    virtual Stats stats() const = 0;
     SkDEBUGCODE(virtual int count() const = 0;)
 };
 
@@ -18,6 +18,7 @@
 
 class GrFragmentProcessor;
 class GrRecordingContext;
+class SkExecutor;
 
 // True base class that all SkImageFilter implementations need to extend from. This provides the
 // actual API surface that Skia will use to compute the filtered images.
@@ -41,6 +42,28 @@ public:
      */
     skif::FilterResult<For::kOutput> filterImage(const skif::Context& context) const;
 
+    /**
+     *  Like filterImage(), but when filtering on the CPU, splits clip bounds larger than a tile
+     *  into tiles that are filtered in parallel on SkExecutor::GetDefault(). Each tile only reads
+     *  the input that onGetInputLayerBounds() maps it to, and keeps its intermediate images in a
+     *  transient cache of its own that is freed as soon as the tile is done, so the scratch memory
+     *  in use at once is bounded by the tiles in flight rather than by the whole output. DAGs
+     *  whose tiles would re-read wide margins of their neighbors (e.g. large blurs), or that are
+     *  too deep to tile exactly, are filtered whole.
+     *
+     *  This only tiles once SkExecutor::SetDefault() has installed an executor; until then it is
+     *  just filterImage().
+     *
+     *  The result matches filterImage(), except that blurs which run at reduced resolution may
+     *  differ slightly along the tile seams.
+     */
+    skif::FilterResult<For::kOutput> filterImageInTiles(const skif::Context& context) const;
+
+    // Like filterImageInTiles() above, but with tiles of at most tileSize x tileSize that run on
+    // executor, or only on the calling thread if executor is null. For tests and benches.
+    skif::FilterResult<For::kOutput> filterImageInTiles(const skif::Context& context,
+                                                        SkExecutor* executor, int tileSize) const;
+
     /**
      *  Calculate the smallest-possible required layer bounds that would provide sufficient
      *  information to correctly compute the image filter for every pixel in the desired output
@@ -357,6 +380,17 @@ private:
 
     static void PurgeCache();
 
+    struct Tiling {
+        SkExecutor* fExecutor;  // Null to filter the tiles on the calling thread.
+        int         fTileSize;
+    };
+
+    // The implementation of filterImage(), which filters in tiles when 'tiling' is not null.
+    skif::FilterResult<For::kOutput> filterImage(const skif::Context&, const Tiling*) const;
+
+    // Computes onFilterImage() for the context's clip bounds one tile at a time.
+    skif::FilterResult<For::kOutput> filterTiles(const skif::Context&, const Tiling&) const;
+
     // Configuration points for the filter implementation, marked private since they should not
     // need to be invoked by the subclasses. These refer to the node's specific behavior and are
     // not responsible for aggregating the behavior of the entire filter DAG.
@@ -8,12 +8,14 @@
 #include "src/core/SkMaskBlurFilter.h"
 
 #include "include/core/SkColorPriv.h"
+#include "include/core/SkPixmap.h"
 #include "include/private/SkMalloc.h"
 #include "include/private/SkNx.h"
 #include "include/private/SkTPin.h"
 #include "include/private/SkTemplates.h"
 #include "include/private/SkTo.h"
 #include "src/core/SkArenaAlloc.h"
+#include "src/core/SkBlurEngine.h"
 #include "src/core/SkGaussFilter.h"
 
 #include <cmath>
@@ -985,6 +987,17 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
         dstH = dst->fBounds.height();
     SkASSERT(srcW >= 0 && srcH >= 0 && dstW >= 0 && dstH >= 0);
 
+    // A8 masks, by far the most common, go through the vectorized and threaded blur. The other
+    // formats are converted to alpha as they are read, below.
+    if (src.fFormat == SkMask::kA8_Format) {
+        SkPixmap srcPixmap{SkImageInfo::MakeA8(srcW, srcH), src.fImage, src.fRowBytes},
+                 dstPixmap{SkImageInfo::MakeA8(dstW, dstH), dst->fImage, dst->fRowBytes};
+        if (SkBlurEngine::GaussianBlur(srcPixmap, {borderW, borderH}, fSigmaW, fSigmaH,
+                                       dstPixmap)) {
+            return {SkTo<int32_t>(borderW), SkTo<int32_t>(borderH)};
+        }
+    }
+
     auto bufferSize = std::max(planW.bufferSize(), planH.bufferSize());
     auto buffer = alloc.makeArrayDefault<uint32_t>(bufferSize);
 
@@ -6,6 +6,7 @@
  */
 
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkTypes.h"
 #include "include/private/SkColorData.h"
 #include "include/private/SkHalf.h"
@@ -16,6 +17,8 @@
 #include "src/core/SkMathPriv.h"
 #include "src/core/SkMipmap.h"
 #include "src/core/SkMipmapBuilder.h"
+#include "src/core/SkOpts.h"
+#include "src/core/SkTaskGroup.h"
 #include <new>
 
 //
@@ -395,8 +398,13 @@ size_t SkMipmap::AllocLevelsSize(int levelCount, size_t pixelSize) {
     return SkTo<int32_t>(size);
 }
 
+// Levels with fewer dst pixels than this are filtered in one stripe; splitting them up would
+// cost more than it saves.
+static constexpr int kMinPixelsPerStripe = 64 * 1024;
+static constexpr int kMaxStripes = 32;
+
 SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
-                          bool computeContents) {
+                          bool computeContents, SkExecutor* executor) {
     typedef void FilterProc(void*, const void* srcPtr, size_t srcRB, int count);
 
     FilterProc* proc_1_2 = nullptr;
@@ -417,11 +425,11 @@ SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
             proc_1_2 = downsample_1_2<ColorTypeFilter_8888>;
             proc_1_3 = downsample_1_3<ColorTypeFilter_8888>;
             proc_2_1 = downsample_2_1<ColorTypeFilter_8888>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_8888>;
+            proc_2_2 = SkOpts::downsample_2_2_8888;
             proc_2_3 = downsample_2_3<ColorTypeFilter_8888>;
             proc_3_1 = downsample_3_1<ColorTypeFilter_8888>;
             proc_3_2 = downsample_3_2<ColorTypeFilter_8888>;
-            proc_3_3 = downsample_3_3<ColorTypeFilter_8888>;
+            proc_3_3 = SkOpts::downsample_3_3_8888;
             break;
         case kRGB_565_SkColorType:
             proc_1_2 = downsample_1_2<ColorTypeFilter_565>;
@@ -448,22 +456,22 @@ SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
             proc_1_2 = downsample_1_2<ColorTypeFilter_8>;
             proc_1_3 = downsample_1_3<ColorTypeFilter_8>;
             proc_2_1 = downsample_2_1<ColorTypeFilter_8>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_8>;
+            proc_2_2 = SkOpts::downsample_2_2_a8;
             proc_2_3 = downsample_2_3<ColorTypeFilter_8>;
             proc_3_1 = downsample_3_1<ColorTypeFilter_8>;
             proc_3_2 = downsample_3_2<ColorTypeFilter_8>;
-            proc_3_3 = downsample_3_3<ColorTypeFilter_8>;
+            proc_3_3 = SkOpts::downsample_3_3_a8;
             break;
         case kRGBA_F16Norm_SkColorType:
         case kRGBA_F16_SkColorType:
             proc_1_2 = downsample_1_2<ColorTypeFilter_RGBA_F16>;
             proc_1_3 = downsample_1_3<ColorTypeFilter_RGBA_F16>;
             proc_2_1 = downsample_2_1<ColorTypeFilter_RGBA_F16>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_RGBA_F16>;
+            proc_2_2 = SkOpts::downsample_2_2_f16;
             proc_2_3 = downsample_2_3<ColorTypeFilter_RGBA_F16>;
             proc_3_1 = downsample_3_1<ColorTypeFilter_RGBA_F16>;
             proc_3_2 = downsample_3_2<ColorTypeFilter_RGBA_F16>;
-            proc_3_3 = downsample_3_3<ColorTypeFilter_RGBA_F16>;
+            proc_3_3 = SkOpts::downsample_3_3_f16;
             break;
         case kR8G8_unorm_SkColorType:
             proc_1_2 = downsample_1_2<ColorTypeFilter_88>;
@@ -500,11 +508,11 @@ SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
             proc_1_2 = downsample_1_2<ColorTypeFilter_1010102>;
             proc_1_3 = downsample_1_3<ColorTypeFilter_1010102>;
             proc_2_1 = downsample_2_1<ColorTypeFilter_1010102>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_1010102>;
+            proc_2_2 = SkOpts::downsample_2_2_1010102;
             proc_2_3 = downsample_2_3<ColorTypeFilter_1010102>;
             proc_3_1 = downsample_3_1<ColorTypeFilter_1010102>;
             proc_3_2 = downsample_3_2<ColorTypeFilter_1010102>;
-            proc_3_3 = downsample_3_3<ColorTypeFilter_1010102>;
+            proc_3_3 = SkOpts::downsample_3_3_1010102;
             break;
         case kA16_float_SkColorType:
             proc_1_2 = downsample_1_2<ColorTypeFilter_Alpha_F16>;
@@ -634,14 +642,34 @@ SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
 
         const SkPixmap& dstPM = levels[i].fPixmap;
         if (computeContents) {
-            const void* srcBasePtr = srcPM.addr();
-            void* dstBasePtr = dstPM.writable_addr();
-
             const size_t srcRB = srcPM.rowBytes();
-            for (int y = 0; y < height; y++) {
-                proc(dstBasePtr, srcBasePtr, srcRB, width);
-                srcBasePtr = (char*)srcBasePtr + srcRB * 2; // jump two rows
-                dstBasePtr = (char*)dstBasePtr + dstPM.rowBytes();
+            auto filterRows = [&](int top, int bottom) {
+                const void* srcBasePtr = srcPM.addr(0, 2 * top);
+                void* dstBasePtr = dstPM.writable_addr(0, top);
+                for (int y = top; y < bottom; y++) {
+                    proc(dstBasePtr, srcBasePtr, srcRB, width);
+                    srcBasePtr = (char*)srcBasePtr + srcRB * 2; // jump two rows
+                    dstBasePtr = (char*)dstBasePtr + dstPM.rowBytes();
+                }
+            };
+
+            // Each level is filtered from the one before, so stripes of a level can run in
+            // parallel, but the levels themselves are built in turn.
+            int stripes = 1;
+            if (executor) {
+                stripes = SkTPin((int)(sk_64_mul(width, height) / kMinPixelsPerStripe),
+                                 1, std::min(height, kMaxStripes));
+            }
+            if (stripes == 1) {
+                filterRows(0, height);
+            } else {
+                const int rowsPerStripe = (height + stripes - 1) / stripes;
+                SkTaskGroup taskGroup(*executor);
+                taskGroup.batch(stripes, [&](int stripe) {
+                    const int top = stripe * rowsPerStripe;
+                    filterRows(top, std::min(height, top + rowsPerStripe));
+                });
+                taskGroup.wait();
             }
         }
         srcPM = dstPM;
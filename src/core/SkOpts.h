@@ -14,6 +14,7 @@
 #include "src/core/SkXfermodePriv.h"
 
 struct SkBitmapProcState;
+struct SkBlurPass;
 namespace skvm { struct InterpreterInstruction; }
 
 namespace SkOpts {
@@ -56,6 +57,28 @@ namespace SkOpts {
 
     extern float (*cubic_solver)(float, float, float, float);
 
+    // The same results as looping over SkUTF::CountUTF8, NextUTF8, and NextUTF16: an invalid
+    // sequence is counted as -1, or decodes as -1 and ends the text. dst must have room for a
+    // SkUnichar per code unit. The decoders return the number of SkUnichars written.
+    extern int (*count_utf8)(const char*, size_t);
+    extern int (*utf8_to_utf32)(const char*, size_t, SkUnichar[]);
+    extern int (*utf16_to_utf32)(const uint16_t*, size_t, SkUnichar[]);
+
+    // SkMipmap's 2x2 box and 3x3 triangle filters: one row of count dst pixels from the rows of
+    // src starting at src, srcRB bytes apart.
+    typedef void (*Downsample)(void* dst, const void* src, size_t srcRB, int count);
+    extern Downsample downsample_2_2_8888, downsample_3_3_8888,
+                      downsample_2_2_a8,   downsample_3_3_a8,
+                      downsample_2_2_f16,  downsample_3_3_f16,
+                      downsample_2_2_1010102, downsample_3_3_1010102;
+
+    // SkBlurEngine's pass over rows scanlines of src, writing them transposed into dst.
+    // scratch has room for SkBlurPass::scratchSize() uint32_ts.
+    extern void (*blur_rows_8888)(const SkBlurPass&, const uint32_t* src, size_t srcRB, int rows,
+                                  uint32_t* dst, size_t dstRB, uint32_t* scratch);
+    extern void (*blur_rows_a8)(const SkBlurPass&, const uint8_t* src, size_t srcRB, int rows,
+                                uint8_t* dst, size_t dstRB, uint32_t* scratch);
+
     static inline uint32_t hash(const void* data, size_t bytes, uint32_t seed=0) {
         return hash_fn(data, bytes, seed);
     }
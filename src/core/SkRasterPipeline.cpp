@@ -20,6 +20,7 @@ void SkRasterPipeline::reset() {
     fStages      = nullptr;
     fNumStages   = 0;
     fSlotsNeeded = 1;  // We always need one extra slot for just_return().
+    fAllowLowp   = true;
 }
 
 void SkRasterPipeline::append(StockStage stage, void* ctx) {
@@ -33,6 +34,13 @@ void SkRasterPipeline::append(StockStage stage, void* ctx) {
     SkASSERT(stage !=                   PQish);  // Please use append_transfer_function().
     SkASSERT(stage !=                  HLGish);  // Please use append_transfer_function().
     SkASSERT(stage !=               HLGinvish);  // Please use append_transfer_function().
+    if (stage == bilinear) {
+        // The lowp bilinear stage only samples 8888 images; anything else needs highp.
+        auto ct = static_cast<const SkRasterPipeline_SamplerCtx2*>(ctx)->ct;
+        if (ct != kRGBA_8888_SkColorType && ct != kBGRA_8888_SkColorType) {
+            fAllowLowp = false;
+        }
+    }
     this->unchecked_append(stage, ctx);
 }
 void SkRasterPipeline::unchecked_append(StockStage stage, void* ctx) {
@@ -65,6 +73,7 @@ void SkRasterPipeline::extend(const SkRasterPipeline& src) {
     fStages = &stages[src.fNumStages - 1];
     fNumStages   += src.fNumStages;
     fSlotsNeeded += src.fSlotsNeeded - 1;  // Don't double count just_returns().
+    fAllowLowp   &= src.fAllowLowp;
 }
 
 void SkRasterPipeline::dump() const {
@@ -341,7 +350,7 @@ SkRasterPipeline::StartPipelineFn SkRasterPipeline::build_pipeline(void** ip) co
     // Stages are stored backwards in fStages, so we reverse here, back to front.
     *--ip = (void*)SkOpts::just_return_lowp;
     for (const StageList* st = fStages; st; st = st->prev) {
-        if (auto fn = SkOpts::stages_lowp[st->stage]) {
+        if (auto fn = fAllowLowp ? SkOpts::stages_lowp[st->stage] : nullptr) {
             if (st->ctx) {
                 *--ip = st->ctx;
             }
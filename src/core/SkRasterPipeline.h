@@ -253,6 +253,10 @@ public:
 
     bool empty() const { return fStages == nullptr; }
 
+    // By default we build a lowp pipeline when every stage has a lowp implementation.
+    // This always builds a highp float pipeline instead, e.g. to compare the two.
+    void forceHighp() { fAllowLowp = false; }
+
 private:
     struct StageList {
         StageList* prev;
@@ -270,6 +274,7 @@ private:
     StageList*    fStages;
     int           fNumStages;
     int           fSlotsNeeded;
+    bool          fAllowLowp;
 };
 
 template <size_t bytes>
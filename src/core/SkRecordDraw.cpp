@@ -7,8 +7,10 @@
 
 #include "include/core/SkBBHFactory.h"
 #include "include/core/SkImage.h"
+#include "include/core/SkPixmap.h"
 #include "src/core/SkCanvasPriv.h"
 #include "src/core/SkRecordDraw.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/utils/SkPatchUtils.h"
 
 void SkRecordDraw(const SkRecord& record,
@@ -56,6 +58,54 @@ void SkRecordDraw(const SkRecord& record,
     }
 }
 
+bool SkRecordDrawTiled(const SkRecord& record,
+                       const SkPixmap& dst,
+                       const SkSurfaceProps& props,
+                       const SkM44& ctm,
+                       const SkIRect& clip,
+                       SkPicture const* const drawablePicts[],
+                       int drawableCount,
+                       const SkBBoxHierarchy* bbh,
+                       int tileSize,
+                       SkExecutor& executor) {
+    SkASSERT(tileSize > 0);
+    SkIRect bounds = dst.bounds();
+    if (!bounds.intersect(clip)) {
+        return true;
+    }
+    // Nested pictures are already running on a tile, so don't split them any further.
+    const SkSurfaceProps tileProps(props.flags() & ~SkSurfaceProps::kParallelPicturePlayback_Flag,
+                                   props.pixelGeometry());
+    if (!SkCanvas::MakeRasterDirect(dst.info(), dst.writable_addr(), dst.rowBytes(),
+                                    &tileProps)) {
+        return false;
+    }
+
+    // Anchoring the tile grid at the pixmap origin (rather than at the clip) keeps anything
+    // that depends on device coordinates, like dither patterns, identical to a serial draw.
+    const int left   = bounds.fLeft / tileSize,
+              top    = bounds.fTop  / tileSize,
+              cols   = (bounds.fRight  - 1) / tileSize - left + 1,
+              rows   = (bounds.fBottom - 1) / tileSize - top  + 1;
+
+    SkTaskGroup tg(executor);
+    tg.batch(cols * rows, [&](int i) {
+        SkIRect tile = SkIRect::MakeXYWH((left + i % cols) * tileSize,
+                                         (top  + i / cols) * tileSize,
+                                         tileSize, tileSize);
+        SkPixmap subset;
+        if (!tile.intersect(bounds) || !dst.extractSubset(&subset, tile)) {
+            return;
+        }
+        auto canvas = SkCanvas::MakeRasterDirect(subset.info(), subset.writable_addr(),
+                                                 subset.rowBytes(), &tileProps);
+        canvas->setMatrix(SkM44::Translate(-tile.fLeft, -tile.fTop) * ctm);
+        SkRecordDraw(record, canvas.get(), drawablePicts, nullptr, drawableCount, bbh, nullptr);
+    });
+    tg.wait();
+    return true;
+}
+
 void SkRecordPartialDraw(const SkRecord& record, SkCanvas* canvas,
                          SkPicture const* const drawablePicts[], int drawableCount,
                          int start, int stop,
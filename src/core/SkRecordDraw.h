@@ -15,7 +15,10 @@
 #include "src/core/SkRecord.h"
 
 class SkDrawable;
+class SkExecutor;
 class SkLayerInfo;
+class SkPixmap;
+class SkSurfaceProps;
 
 // Calculate conservative identity space bounds for each op in the record.
 void SkRecordFillBounds(const SkRect& cullRect, const SkRecord&,
@@ -32,6 +35,16 @@ void SkRecordDraw(const SkRecord&, SkCanvas*, SkPicture const* const drawablePic
                   SkDrawable* const drawables[], int drawableCount,
                   const SkBBoxHierarchy*, SkPicture::AbortCallback*);
 
+// Draw an SkRecord directly into the pixels of dst, restricted to the device-space clip.
+// The clip is split into tileSize x tileSize tiles anchored at dst's origin; each tile is
+// culled against the BBH (if any) and played back into its own raster canvas on the executor.
+// Tiles never overlap, so the result does not depend on the executor's thread count.
+// Returns false without drawing if dst cannot be wrapped by a raster canvas.
+bool SkRecordDrawTiled(const SkRecord&, const SkPixmap& dst, const SkSurfaceProps&,
+                       const SkM44& ctm, const SkIRect& clip,
+                       SkPicture const* const drawablePicts[], int drawableCount,
+                       const SkBBoxHierarchy*, int tileSize, SkExecutor&);
+
 // Draw a portion of an SkRecord into an SkCanvas.
 // When drawing a portion of an SkRecord the CTM on the passed in canvas must be
 // the composition of the replay matrix with the record-time CTM (for the portion
@@ -86,6 +86,13 @@ int SkScalerCache::countCachedGlyphs() const {
     return fDigestForPackedGlyphID.count();
 }
 
+void SkScalerCache::forEachGlyph(const std::function<void(const SkGlyph&)>& visitor) const {
+    SkAutoMutexExclusive lock(fMu);
+    for (const SkGlyph* glyph : fGlyphForIndex) {
+        visitor(*glyph);
+    }
+}
+
 std::tuple<SkSpan<const SkGlyph*>, size_t> SkScalerCache::internalPrepare(
         SkSpan<const SkGlyphID> glyphIDs, PathDetail pathDetail, const SkGlyph** results) {
     const SkGlyph** cursor = results;
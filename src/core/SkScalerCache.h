@@ -17,6 +17,7 @@
 #include "src/core/SkGlyph.h"
 #include "src/core/SkGlyphRunPainter.h"
 #include "src/core/SkStrikeForGPU.h"
+#include <functional>
 #include <memory>
 
 class SkScalerContext;
@@ -70,6 +71,9 @@ public:
     /** Return the number of glyphs currently cached. */
     int countCachedGlyphs() const SK_EXCLUDES(fMu);
 
+    /** Call visitor on each glyph currently cached, in the order they were added. */
+    void forEachGlyph(const std::function<void(const SkGlyph&)>& visitor) const SK_EXCLUDES(fMu);
+
     /** If the advance axis intersects the glyph's path, append the positions scaled and offset
         to the array (if non-null), and set the count to the updated array length.
     */
@@ -8,6 +8,7 @@
 #include "src/core/SkStrikeCache.h"
 
 #include <cctype>
+#include <cmath>
 
 #include "include/core/SkGraphics.h"
 #include "include/core/SkRefCnt.h"
@@ -17,6 +18,9 @@
 #include "include/private/SkTemplates.h"
 #include "src/core/SkGlyphRunPainter.h"
 #include "src/core/SkScalerCache.h"
+#include "src/core/SkStrikeSpec.h"
+#include "src/core/SkTaskGroup.h"
+#include "src/core/SkTextBlobRasterCache.h"
 
 bool gSkUseThreadLocalStrikeCaches_IAcknowledgeThisIsIncrediblyExperimental = false;
 
@@ -34,13 +38,38 @@ SkStrikeCache* SkStrikeCache::GlobalStrikeCache() {
 auto SkStrikeCache::findOrCreateStrike(const SkDescriptor& desc,
                                        const SkScalerContextEffects& effects,
                                        const SkTypeface& typeface) -> sk_sp<Strike> {
-    SkAutoMutexExclusive ac(fLock);
-    sk_sp<Strike> strike = this->internalFindStrikeOrNull(desc);
+    Shard* shard = this->shardFor(desc);
+    sk_sp<Strike> strike;
+    {
+        SkAutoMutexExclusive ac(shard->fLock);
+        strike = shard->findStrikeOrNull(desc);
+    }
     if (strike == nullptr) {
-        auto scaler = typeface.createScalerContext(effects, &desc);
-        strike = this->internalCreateStrike(desc, std::move(scaler));
+        // Looking in the store reads the font and checks the stored strike, so do it before
+        // locking the shard, whose other strikes other threads may be waiting for.
+        sk_sp<SkStrikeStore> store = this->strikeStore();
+        SkFontMetrics storedMetrics;
+        const SkStrikeStore::Entry* stored =
+                store ? store->find(desc, typeface, &storedMetrics) : nullptr;
+
+        SkAutoMutexExclusive ac(shard->fLock);
+        // Another thread may have made the strike in the meantime.
+        strike = shard->findStrikeOrNull(desc);
+        if (strike == nullptr) {
+            auto scaler = typeface.createScalerContext(effects, &desc);
+            strike = this->internalCreateStrike(
+                    shard, desc, std::move(scaler), stored ? &storedMetrics : nullptr);
+            if (stored) {
+                // No other thread can see the strike until the shard is unlocked, so fill it
+                // directly, accounting for the glyphs as updateDelta() would.
+                size_t loaded = store->loadGlyphs(stored, &strike->fScalerCache);
+                strike->fMemoryUsed     += loaded;
+                shard->fTotalMemoryUsed += loaded;
+                fTotalMemoryUsed        += loaded;
+            }
+        }
     }
-    this->internalPurge();
+    this->purge();
     return strike;
 }
 
@@ -50,6 +79,48 @@ SkScopedStrikeForGPU SkStrikeCache::findOrCreateScopedStrike(const SkDescriptor&
     return SkScopedStrikeForGPU{this->findOrCreateStrike(desc, effects, typeface).release()};
 }
 
+void SkStrikeCache::prewarm(const SkStrikeSpec& strikeSpec,
+                            SkSpan<const SkGlyphID> glyphIDs,
+                            SkTaskGroup* taskGroup) {
+    if (glyphIDs.empty()) {
+        return;
+    }
+    std::vector<SkGlyphID> ids(glyphIDs.begin(), glyphIDs.end());
+    taskGroup->add([this, strikeSpec, ids = std::move(ids)] {
+        sk_sp<Strike> strike = strikeSpec.findOrCreateStrike(this);
+
+        std::vector<const SkGlyph*> results(ids.size());
+        strike->preparePaths(SkMakeSpan(ids), results.data());
+
+        // Make an image for each sub-pixel position the strike draws. Despite its name, the
+        // field mask keeps the position bits of the axes that are positioned by sub-pixel.
+        const SkIPoint subpixel = strike->roundingSpec().ignorePositionFieldMask;
+        const uint32_t xs = subpixel.x() ? 1u << SkPackedGlyphID::kSubPixelPosLen : 1,
+                       ys = subpixel.y() ? 1u << SkPackedGlyphID::kSubPixelPosLen : 1;
+        std::vector<SkPackedGlyphID> packedIDs;
+        packedIDs.reserve(ids.size() * xs * ys);
+        for (SkGlyphID id : ids) {
+            for (uint32_t y = 0; y < ys; y++) {
+                for (uint32_t x = 0; x < xs; x++) {
+                    packedIDs.emplace_back(id, x, y);
+                }
+            }
+        }
+        results.resize(packedIDs.size());
+        strike->prepareImages(SkMakeSpan(packedIDs), results.data());
+    });
+}
+
+void SkStrikeCache::setStrikeStore(sk_sp<SkStrikeStore> store) {
+    SkAutoSpinlock lock(fStoreLock);
+    fStore = std::move(store);
+}
+
+sk_sp<SkStrikeStore> SkStrikeCache::strikeStore() const {
+    SkAutoSpinlock lock(fStoreLock);
+    return fStore;
+}
+
 void SkStrikeCache::PurgeAll() {
     GlobalStrikeCache()->purgeAll();
 }
@@ -120,13 +191,17 @@ void SkStrikeCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
 }
 
 sk_sp<SkStrike> SkStrikeCache::findStrike(const SkDescriptor& desc) {
-    SkAutoMutexExclusive ac(fLock);
-    sk_sp<SkStrike> result = this->internalFindStrikeOrNull(desc);
-    this->internalPurge();
+    sk_sp<SkStrike> result;
+    {
+        Shard* shard = this->shardFor(desc);
+        SkAutoMutexExclusive ac(shard->fLock);
+        result = shard->findStrikeOrNull(desc);
+    }
+    this->purge();
     return result;
 }
 
-auto SkStrikeCache::internalFindStrikeOrNull(const SkDescriptor& desc) -> sk_sp<Strike> {
+auto SkStrikeCache::Shard::findStrikeOrNull(const SkDescriptor& desc) -> sk_sp<Strike> {
 
     // Check head because it is likely the strike we are looking for.
     if (fHead != nullptr && fHead->getDescriptor() == desc) { return sk_ref_sp(fHead); }
@@ -157,52 +232,54 @@ sk_sp<SkStrike> SkStrikeCache::createStrike(
         std::unique_ptr<SkScalerContext> scaler,
         SkFontMetrics* maybeMetrics,
         std::unique_ptr<SkStrikePinner> pinner) {
-    SkAutoMutexExclusive ac(fLock);
-    return this->internalCreateStrike(desc, std::move(scaler), maybeMetrics, std::move(pinner));
+    sk_sp<Strike> strike;
+    {
+        Shard* shard = this->shardFor(desc);
+        SkAutoMutexExclusive ac(shard->fLock);
+        strike = this->internalCreateStrike(
+                shard, desc, std::move(scaler), maybeMetrics, std::move(pinner));
+    }
+    return strike;
 }
 
 auto SkStrikeCache::internalCreateStrike(
+        Shard* shard,
         const SkDescriptor& desc,
         std::unique_ptr<SkScalerContext> scaler,
         SkFontMetrics* maybeMetrics,
         std::unique_ptr<SkStrikePinner> pinner) -> sk_sp<Strike> {
     auto strike =
             sk_make_sp<Strike>(this, desc, std::move(scaler), maybeMetrics, std::move(pinner));
-    this->internalAttachToHead(strike);
+    size_t memoryUsed = strike->fMemoryUsed;
+    shard->attachToHead(strike);
+    fCacheCount += 1;
+    fTotalMemoryUsed += memoryUsed;
     return strike;
 }
 
 void SkStrikeCache::purgeAll() {
-    SkAutoMutexExclusive ac(fLock);
-    this->internalPurge(fTotalMemoryUsed);
+    this->purge(fTotalMemoryUsed);
 }
 
 size_t SkStrikeCache::getTotalMemoryUsed() const {
-    SkAutoMutexExclusive ac(fLock);
     return fTotalMemoryUsed;
 }
 
 int SkStrikeCache::getCacheCountUsed() const {
-    SkAutoMutexExclusive ac(fLock);
     return fCacheCount;
 }
 
 int SkStrikeCache::getCacheCountLimit() const {
-    SkAutoMutexExclusive ac(fLock);
     return fCacheCountLimit;
 }
 
 size_t SkStrikeCache::setCacheSizeLimit(size_t newLimit) {
-    SkAutoMutexExclusive ac(fLock);
-
-    size_t prevLimit = fCacheSizeLimit;
-    fCacheSizeLimit = newLimit;
-    this->internalPurge();
+    size_t prevLimit = fCacheSizeLimit.exchange(newLimit);
+    this->purge();
     return prevLimit;
 }
 
 size_t  SkStrikeCache::getCacheSizeLimit() const {
-    SkAutoMutexExclusive ac(fLock);
     return fCacheSizeLimit;
 }
 
@@ -211,40 +288,42 @@ int SkStrikeCache::setCacheCountLimit(int newCount) {
         newCount = 0;
     }
 
-    SkAutoMutexExclusive ac(fLock);
-
-    int prevCount = fCacheCountLimit;
-    fCacheCountLimit = newCount;
-    this->internalPurge();
+    int prevCount = fCacheCountLimit.exchange(newCount);
+    this->purge();
     return prevCount;
 }
 
 void SkStrikeCache::forEachStrike(std::function<void(const Strike&)> visitor) const {
-    SkAutoMutexExclusive ac(fLock);
+    for (const Shard& shard : fShards) {
+        SkAutoMutexExclusive ac(shard.fLock);
 
-    this->validate();
+        shard.validate();
 
-    for (Strike* strike = fHead; strike != nullptr; strike = strike->fNext) {
-        visitor(*strike);
+        for (Strike* strike = shard.fHead; strike != nullptr; strike = strike->fNext) {
+            visitor(*strike);
+        }
     }
 }
 
-size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
+size_t SkStrikeCache::purge(size_t minBytesNeeded) {
+    const size_t totalMemoryUsed = fTotalMemoryUsed;
+    const int    cacheCount      = fCacheCount;
+
     size_t bytesNeeded = 0;
-    if (fTotalMemoryUsed > fCacheSizeLimit) {
-        bytesNeeded = fTotalMemoryUsed - fCacheSizeLimit;
+    if (totalMemoryUsed > fCacheSizeLimit) {
+        bytesNeeded = totalMemoryUsed - fCacheSizeLimit;
     }
     bytesNeeded = std::max(bytesNeeded, minBytesNeeded);
     if (bytesNeeded) {
         // no small purges!
-        bytesNeeded = std::max(bytesNeeded, fTotalMemoryUsed >> 2);
+        bytesNeeded = std::max(bytesNeeded, totalMemoryUsed >> 2);
     }
 
     int countNeeded = 0;
-    if (fCacheCount > fCacheCountLimit) {
-        countNeeded = fCacheCount - fCacheCountLimit;
+    if (cacheCount > fCacheCountLimit) {
+        countNeeded = cacheCount - fCacheCountLimit;
         // no small purges!
-        countNeeded = std::max(countNeeded, fCacheCount >> 2);
+        countNeeded = std::max(countNeeded, cacheCount >> 2);
     }
 
     // early exit
@@ -255,22 +334,31 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
     size_t  bytesFreed = 0;
     int     countFreed = 0;
 
-    // Start at the tail and proceed backwards deleting; the list is in LRU
-    // order, with unimportant entries at the tail.
-    Strike* strike = fTail;
-    while (strike != nullptr && (bytesFreed < bytesNeeded || countFreed < countNeeded)) {
-        Strike* prev = strike->fPrev;
+    // Each shard gives up its share of what's needed, so that the strikes purged are roughly
+    // the least recently used ones overall. Shards are locked one at a time; if other threads
+    // grow the cache while we're purging, their own calls to purge() will catch up.
+    auto share = [](double needed, double shardUsed, double totalUsed) {
+        return totalUsed > 0 ? std::ceil(needed * std::min(shardUsed / totalUsed, 1.0)) : 0;
+    };
+    for (Shard& shard : fShards) {
+        SkAutoMutexExclusive ac(shard.fLock);
 
-        // Only delete if the strike is not pinned.
-        if (strike->fPinner == nullptr || strike->fPinner->canDelete()) {
-            bytesFreed += strike->fMemoryUsed;
-            countFreed += 1;
-            this->internalRemoveStrike(strike);
+        auto shardBytesNeeded = (size_t)share(bytesNeeded, shard.fTotalMemoryUsed, totalMemoryUsed);
+        auto shardCountNeeded =    (int)share(countNeeded, shard.fCacheCount,      cacheCount);
+        if (shardBytesNeeded == 0 && shardCountNeeded == 0) {
+            continue;
         }
-        strike = prev;
-    }
 
-    this->validate();
+        size_t shardBytesFreed = 0;
+        int    shardCountFreed = 0;
+        shard.purge(shardBytesNeeded, shardCountNeeded, &shardBytesFreed, &shardCountFreed);
+        shard.validate();
+
+        fTotalMemoryUsed -= shardBytesFreed;
+        fCacheCount      -= shardCountFreed;
+        bytesFreed += shardBytesFreed;
+        countFreed += shardCountFreed;
+    }
 
 #ifdef SPEW_PURGE_STATUS
     if (countFreed) {
@@ -282,7 +370,25 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
     return bytesFreed;
 }
 
-void SkStrikeCache::internalAttachToHead(sk_sp<Strike> strike) {
+void SkStrikeCache::Shard::purge(size_t bytesNeeded, int countNeeded,
+                                 size_t* bytesFreed, int* countFreed) {
+    // Start at the tail and proceed backwards deleting; the list is in LRU
+    // order, with unimportant entries at the tail.
+    Strike* strike = fTail;
+    while (strike != nullptr && (*bytesFreed < bytesNeeded || *countFreed < countNeeded)) {
+        Strike* prev = strike->fPrev;
+
+        // Only delete if the strike is not pinned.
+        if (strike->fPinner == nullptr || strike->fPinner->canDelete()) {
+            *bytesFreed += strike->fMemoryUsed;
+            *countFreed += 1;
+            this->removeStrike(strike);
+        }
+        strike = prev;
+    }
+}
+
+void SkStrikeCache::Shard::attachToHead(sk_sp<Strike> strike) {
     SkASSERT(fStrikeLookup.find(strike->getDescriptor()) == nullptr);
     Strike* strikePtr = strike.get();
     fStrikeLookup.set(std::move(strike));
@@ -303,7 +409,7 @@ void SkStrikeCache::internalAttachToHead(sk_sp<Strike> strike) {
     fHead = strikePtr; // Transfer ownership of strike to the cache list.
 }
 
-void SkStrikeCache::internalRemoveStrike(Strike* strike) {
+void SkStrikeCache::Shard::removeStrike(Strike* strike) {
     SkASSERT(fCacheCount > 0);
     fCacheCount -= 1;
     fTotalMemoryUsed -= strike->fMemoryUsed;
@@ -321,10 +427,13 @@ void SkStrikeCache::internalRemoveStrike(Strike* strike) {
 
     strike->fPrev = strike->fNext = nullptr;
     strike->fRemoved = true;
+    if (strike->fHeldByTextBlobCache) {
+        SkTextBlobRasterCache::PostPurgeStrikeMessage(strike);
+    }
     fStrikeLookup.remove(strike->getDescriptor());
 }
 
-void SkStrikeCache::validate() const {
+void SkStrikeCache::Shard::validate() const {
 #ifdef SK_DEBUG
     size_t computedBytes = 0;
     int computedCount = 0;
@@ -350,9 +459,11 @@ void SkStrikeCache::validate() const {
 
 void SkStrikeCache::Strike::updateDelta(size_t increase) {
     if (increase != 0) {
-        SkAutoMutexExclusive lock{fStrikeCache->fLock};
+        Shard* shard = fStrikeCache->shardFor(this->getDescriptor());
+        SkAutoMutexExclusive lock{shard->fLock};
         fMemoryUsed += increase;
         if (!fRemoved) {
+            shard->fTotalMemoryUsed += increase;
             fStrikeCache->fTotalMemoryUsed += increase;
         }
     }
@@ -8,6 +8,7 @@
 #ifndef SkStrikeCache_DEFINED
 #define SkStrikeCache_DEFINED
 
+#include <atomic>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -15,7 +16,10 @@
 #include "include/private/SkTemplates.h"
 #include "src/core/SkDescriptor.h"
 #include "src/core/SkScalerCache.h"
+#include "src/core/SkStrikeStore.h"
 
+class SkStrikeSpec;
+class SkTaskGroup;
 class SkTraceMemoryDump;
 
 #ifndef SK_DEFAULT_FONT_CACHE_COUNT_LIMIT
@@ -138,28 +142,40 @@ public:
         SkScalerCache                   fScalerCache;
         std::unique_ptr<SkStrikePinner> fPinner;
         size_t                          fMemoryUsed{sizeof(SkScalerCache)};
-        bool                            fRemoved{false};
+        std::atomic<bool>               fRemoved{false};
+        // Set once an SkTextBlobRasterCache entry refs this strike, so that removing the strike
+        // from the cache has it drop those entries.
+        std::atomic<bool>               fHeldByTextBlobCache{false};
     };  // Strike
 
     static SkStrikeCache* GlobalStrikeCache();
 
-    sk_sp<Strike> findStrike(const SkDescriptor& desc) SK_EXCLUDES(fLock);
+    sk_sp<Strike> findStrike(const SkDescriptor& desc);
 
     sk_sp<Strike> createStrike(
             const SkDescriptor& desc,
             std::unique_ptr<SkScalerContext> scaler,
             SkFontMetrics* maybeMetrics = nullptr,
-            std::unique_ptr<SkStrikePinner> = nullptr) SK_EXCLUDES(fLock);
+            std::unique_ptr<SkStrikePinner> = nullptr);
 
     sk_sp<Strike> findOrCreateStrike(
             const SkDescriptor& desc,
             const SkScalerContextEffects& effects,
-            const SkTypeface& typeface) SK_EXCLUDES(fLock);
+            const SkTypeface& typeface);
 
     SkScopedStrikeForGPU findOrCreateScopedStrike(
             const SkDescriptor& desc,
             const SkScalerContextEffects& effects,
-            const SkTypeface& typeface) override SK_EXCLUDES(fLock);
+            const SkTypeface& typeface) override;
+
+    // Adds a task to taskGroup that finds or creates the strike for strikeSpec in this cache and
+    // fills in the metrics, path, and image of each of glyphIDs, so that drawing them later
+    // doesn't have to make them. Images are made for every sub-pixel position the strike can
+    // use. Warming several strikes into the same taskGroup rasterizes them in parallel; call
+    // taskGroup->wait() to know they're ready. This cache must outlive the task.
+    void prewarm(const SkStrikeSpec& strikeSpec,
+                 SkSpan<const SkGlyphID> glyphIDs,
+                 SkTaskGroup* taskGroup);
 
     static void PurgeAll();
     static void Dump();
@@ -168,41 +184,24 @@ public:
     // SkTraceMemoryDump interface.
     static void DumpMemoryStatistics(SkTraceMemoryDump* dump);
 
-    void purgeAll() SK_EXCLUDES(fLock); // does not change budget
-
-    int getCacheCountLimit() const SK_EXCLUDES(fLock);
-    int setCacheCountLimit(int limit) SK_EXCLUDES(fLock);
-    int getCacheCountUsed() const SK_EXCLUDES(fLock);
-
-    size_t getCacheSizeLimit() const SK_EXCLUDES(fLock);
-    size_t setCacheSizeLimit(size_t limit) SK_EXCLUDES(fLock);
-    size_t getTotalMemoryUsed() const SK_EXCLUDES(fLock);
-
-private:
-    sk_sp<Strike> internalFindStrikeOrNull(const SkDescriptor& desc) SK_REQUIRES(fLock);
-    sk_sp<Strike> internalCreateStrike(
-            const SkDescriptor& desc,
-            std::unique_ptr<SkScalerContext> scaler,
-            SkFontMetrics* maybeMetrics = nullptr,
-            std::unique_ptr<SkStrikePinner> = nullptr) SK_REQUIRES(fLock);
+    void purgeAll(); // does not change budget
 
-    // The following methods can only be called when mutex is already held.
-    void internalRemoveStrike(Strike* strike) SK_REQUIRES(fLock);
-    void internalAttachToHead(sk_sp<Strike> strike) SK_REQUIRES(fLock);
+    // Strikes missing from this cache are filled from store, when it has them, rather than by
+    // their typeface's scaler. Pass nullptr to stop using a store.
+    void setStrikeStore(sk_sp<SkStrikeStore> store);
 
-    // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
-    // and attempt to purge caches to match.
-    // Returns number of bytes freed.
-    size_t internalPurge(size_t minBytesNeeded = 0) SK_REQUIRES(fLock);
+    // Calls visitor on each strike, with that strike's shard locked.
+    void forEachStrike(std::function<void(const Strike&)> visitor) const;
 
-    // A simple accounting of what each glyph cache reports and the strike cache total.
-    void validate() const SK_REQUIRES(fLock);
+    int getCacheCountLimit() const;
+    int setCacheCountLimit(int limit);
+    int getCacheCountUsed() const;
 
-    void forEachStrike(std::function<void(const Strike&)> visitor) const SK_EXCLUDES(fLock);
+    size_t getCacheSizeLimit() const;
+    size_t setCacheSizeLimit(size_t limit);
+    size_t getTotalMemoryUsed() const;
 
-    mutable SkMutex fLock;
-    Strike* fHead SK_GUARDED_BY(fLock) {nullptr};
-    Strike* fTail SK_GUARDED_BY(fLock) {nullptr};
+private:
     struct StrikeTraits {
         static bool isValid(const sk_sp<Strike>& strike){
             return (strike == 0) ? false : true;
@@ -214,12 +213,64 @@ private:
             return descriptor.getChecksum();
         }
     };
-    SkTHashTable<sk_sp<Strike>, SkDescriptor, StrikeTraits> fStrikeLookup SK_GUARDED_BY(fLock);
 
-    size_t  fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
-    size_t  fTotalMemoryUsed SK_GUARDED_BY(fLock) {0};
-    int32_t fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
-    int32_t fCacheCount SK_GUARDED_BY(fLock) {0};
+    // Strikes are partitioned by descriptor into shards, each with its own lock, lookup table,
+    // and LRU list, so threads working on different strikes rarely contend. The byte and count
+    // budgets are global; whichever thread pushes the cache over budget purges every shard
+    // in proportion to its share of the total, least recently used strikes first.
+    struct Shard {
+        sk_sp<Strike> findStrikeOrNull(const SkDescriptor& desc) SK_REQUIRES(fLock);
+        void attachToHead(sk_sp<Strike> strike) SK_REQUIRES(fLock);
+        void removeStrike(Strike* strike) SK_REQUIRES(fLock);
+
+        // Remove unpinned strikes from the tail until at least bytesNeeded and countNeeded
+        // have been freed or the shard is exhausted.
+        void purge(size_t bytesNeeded, int countNeeded,
+                   size_t* bytesFreed, int* countFreed) SK_REQUIRES(fLock);
+
+        // A simple accounting of what each glyph cache reports and the shard total.
+        void validate() const SK_REQUIRES(fLock);
+
+        mutable SkMutex fLock;
+        Strike* fHead SK_GUARDED_BY(fLock) {nullptr};
+        Strike* fTail SK_GUARDED_BY(fLock) {nullptr};
+        SkTHashTable<sk_sp<Strike>, SkDescriptor, StrikeTraits> fStrikeLookup
+                SK_GUARDED_BY(fLock);
+        size_t  fTotalMemoryUsed SK_GUARDED_BY(fLock) {0};
+        int32_t fCacheCount      SK_GUARDED_BY(fLock) {0};
+    };
+
+    static constexpr int kShardBits  = 3;
+    static constexpr int kShardCount = 1 << kShardBits;
+
+    Shard* shardFor(const SkDescriptor& desc) {
+        // SkTHashTable indexes with the low bits of the checksum, so shard on the high bits.
+        return &fShards[desc.getChecksum() >> (32 - kShardBits)];
+    }
+
+    sk_sp<Strike> internalCreateStrike(
+            Shard* shard,
+            const SkDescriptor& desc,
+            std::unique_ptr<SkScalerContext> scaler,
+            SkFontMetrics* maybeMetrics = nullptr,
+            std::unique_ptr<SkStrikePinner> = nullptr) SK_REQUIRES(shard->fLock);
+
+    // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
+    // and attempt to purge caches to match. Must be called without any shard lock held.
+    // Returns number of bytes freed.
+    size_t purge(size_t minBytesNeeded = 0);
+
+    sk_sp<SkStrikeStore> strikeStore() const;
+
+    Shard fShards[kShardCount];
+
+    mutable SkSpinlock   fStoreLock;
+    sk_sp<SkStrikeStore> fStore SK_GUARDED_BY(fStoreLock);
+
+    std::atomic<size_t>  fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
+    std::atomic<size_t>  fTotalMemoryUsed{0};
+    std::atomic<int32_t> fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
+    std::atomic<int32_t> fCacheCount{0};
 };
 
 using SkStrike = SkStrikeCache::Strike;
@@ -0,0 +1,391 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkStrikeStore.h"
+
+#include "include/core/SkFontMetrics.h"
+#include "include/core/SkMilestone.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkString.h"
+#include "include/core/SkTypeface.h"
+#include "src/core/SkOpts.h"
+#include "src/core/SkScalerCache.h"
+#include "src/core/SkScalerContext.h"
+#include "src/core/SkStrikeCache.h"
+#include "src/core/SkStrikeSerialization.h"
+
+#include <cstdio>
+
+// The file is a Header, a table of Header::count Entries, then each entry's data: its descriptor
+// (with the typeface ID zeroed), its SkFontMetrics, and its glyphs, as written by Serializer.
+// Bump the version whenever any of that changes, including the layout of anything written as
+// raw bytes, like SkScalerContextRec, SkFontMetrics, and SkPath's serialization. The header also
+// records SK_MILESTONE, so that files aren't shared across Skia releases.
+static constexpr uint32_t kStrikeStoreMagic   = SkSetFourByteTag('s', 'k', 's', 't');
+static constexpr uint32_t kStrikeStoreVersion = 2;
+
+namespace {
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t milestone;      // SK_MILESTONE of the build that wrote the file.
+    uint32_t recSize;        // sizeof(SkScalerContextRec), and
+    uint32_t metricsSize;    // sizeof(SkFontMetrics), to catch builds that lay them out
+    uint32_t tableChecksum;  // differently.
+    uint64_t count;
+};
+
+enum GlyphFlags : uint8_t {
+    kHasImage = 1 << 0,
+    kHasPath  = 1 << 1,  // The path has been made, though the glyph may not have one.
+};
+}  // namespace
+
+static uint64_t hash64(const void* data, size_t size) {
+    return (uint64_t)SkOpts::hash(data, size, 0) | (uint64_t)SkOpts::hash(data, size, 1) << 32;
+}
+
+static uint64_t index_key(uint64_t fontKey, uint32_t descChecksum) {
+    const uint64_t key[] = { fontKey, descChecksum };
+    return hash64(key, sizeof(key));
+}
+
+// Identifies a font across processes, or returns 0 if it can't. A font's head table holds its
+// revision, creation and modification times, and a checksum of the whole file; the names, style,
+// and variation tell apart typefaces made from the same file.
+static uint64_t make_font_key(const SkTypeface& typeface) {
+    SkDynamicMemoryWStream key;
+
+    uint8_t head[54];
+    if (typeface.getTableData(SkSetFourByteTag('h', 'e', 'a', 'd'), 0, sizeof(head), head) ==
+            sizeof(head)) {
+        key.write(head, sizeof(head));
+    } else {
+        int ttcIndex;
+        std::unique_ptr<SkStreamAsset> stream = typeface.openStream(&ttcIndex);
+        sk_sp<SkData> data = stream ? SkData::MakeFromStream(stream.get(), stream->getLength())
+                                    : nullptr;
+        if (!data) {
+            return 0;
+        }
+        uint64_t dataHash = hash64(data->data(), data->size());
+        key.write(&dataHash, sizeof(dataHash));
+        key.write32(ttcIndex);
+    }
+
+    SkString name;
+    typeface.getFamilyName(&name);
+    key.write(name.c_str(), name.size() + 1);
+    if (typeface.getPostScriptName(&name)) {
+        key.write(name.c_str(), name.size() + 1);
+    }
+    SkFontStyle style = typeface.fontStyle();
+    key.write32(style.weight());
+    key.write32(style.width());
+    key.write32(style.slant());
+
+    int axisCount = typeface.getVariationDesignPosition(nullptr, 0);
+    if (axisCount > 0) {
+        std::vector<SkFontArguments::VariationPosition::Coordinate> coords(axisCount);
+        if (typeface.getVariationDesignPosition(coords.data(), axisCount) == axisCount) {
+            key.write(coords.data(), axisCount * sizeof(coords[0]));
+        }
+    }
+
+    sk_sp<SkData> bytes = key.detachAsData();
+    uint64_t hash = hash64(bytes->data(), bytes->size());
+    return hash ? hash : 1;
+}
+
+// desc with its typeface ID, which is only meaningful in this process, cleared.
+static const SkDescriptor* stored_descriptor(const SkDescriptor& desc, SkAutoDescriptor* ad) {
+    ad->reset(desc.getLength());
+    SkDescriptor* stored = ad->getDesc();
+
+    uint32_t size;
+    const void* ptr = desc.findEntry(kRec_SkDescriptorTag, &size);
+    SkScalerContextRec rec;
+    SkASSERT(ptr && size == sizeof(rec));
+    memcpy((void*)&rec, ptr, sizeof(rec));
+    rec.fFontID = 0;
+    stored->addEntry(kRec_SkDescriptorTag, sizeof(rec), &rec);
+
+    if ((ptr = desc.findEntry(kEffects_SkDescriptorTag, &size))) {
+        stored->addEntry(kEffects_SkDescriptorTag, size, ptr);
+    }
+
+    stored->computeChecksum();
+    return stored;
+}
+
+static void write_glyph(const SkGlyph& glyph, Serializer* serializer) {
+    writeGlyph(glyph, serializer);
+
+    const void* image = glyph.setImageHasBeenCalled() ? glyph.image() : nullptr;
+    serializer->write<uint8_t>((image                       ? kHasImage : 0) |
+                               (glyph.setPathHasBeenCalled() ? kHasPath  : 0));
+    if (image) {
+        memcpy(serializer->allocate(glyph.imageSize(), glyph.formatAlignment()),
+               image, glyph.imageSize());
+    }
+    if (glyph.setPathHasBeenCalled()) {
+        const SkPath* path = glyph.path();
+        const size_t pathSize = path ? path->writeToMemory(nullptr) : 0;
+        serializer->write<uint64_t>(pathSize);
+        if (pathSize) {
+            path->writeToMemory(serializer->allocate(pathSize, kPathAlignment));
+        }
+    }
+}
+
+static bool write_store(const SkStrikeCache& cache, const char path[]) {
+    struct Strike {
+        SkStrikeStore::Entry entry;
+        std::vector<uint8_t> data;
+    };
+    std::vector<Strike> strikes;
+
+    cache.forEachStrike([&](const SkStrike& strike) {
+        const SkScalerCache& scalerCache = strike.fScalerCache;
+        const uint64_t fontKey = make_font_key(*scalerCache.getScalerContext()->getTypeface());
+        if (!fontKey) {
+            return;
+        }
+
+        // Serialize the glyphs first, so the count comes before them.
+        std::vector<uint8_t> glyphData;
+        Serializer glyphSerializer(&glyphData);
+        uint64_t glyphCount = 0;
+        scalerCache.forEachGlyph([&](const SkGlyph& glyph) {
+            write_glyph(glyph, &glyphSerializer);
+            glyphCount++;
+        });
+
+        SkAutoDescriptor ad;
+        const SkDescriptor* desc = stored_descriptor(scalerCache.getDescriptor(), &ad);
+
+        Strike stored;
+        Serializer serializer(&stored.data);
+        serializer.writeDescriptor(*desc);
+        serializer.write<SkFontMetrics>(scalerCache.getFontMetrics());
+        serializer.write<uint64_t>(glyphCount);
+        // Nothing in glyphData is aligned to more than 8 bytes, so it can be copied as is.
+        if (!glyphData.empty()) {
+            memcpy(serializer.allocate(glyphData.size(), 8), glyphData.data(), glyphData.size());
+        }
+
+        stored.entry = {fontKey, desc->getChecksum(),
+                        SkOpts::hash(stored.data.data(), stored.data.size()),
+                        0, stored.data.size()};
+        strikes.push_back(std::move(stored));
+    });
+
+    // Data starts after the table, each strike's at an 8 byte aligned offset.
+    uint64_t offset = sizeof(Header) + strikes.size() * sizeof(SkStrikeStore::Entry);
+    std::vector<SkStrikeStore::Entry> table;
+    for (Strike& strike : strikes) {
+        offset = pad(offset, 8);
+        strike.entry.offset = offset;
+        offset += strike.entry.size;
+        table.push_back(strike.entry);
+    }
+
+    Header header = {
+        kStrikeStoreMagic, kStrikeStoreVersion, SK_MILESTONE,
+        sizeof(SkScalerContextRec), sizeof(SkFontMetrics),
+        SkOpts::hash(table.data(), table.size() * sizeof(table[0])), table.size(),
+    };
+
+    SkFILEWStream file(path);
+    if (!file.isValid()) {
+        return false;
+    }
+    bool ok = file.write(&header, sizeof(header)) &&
+              file.write(table.data(), table.size() * sizeof(table[0]));
+    for (const Strike& strike : strikes) {
+        static const uint8_t kZeros[8] = {};
+        ok = ok && file.write(kZeros, strike.entry.offset - file.bytesWritten())
+                && file.write(strike.data.data(), strike.data.size());
+    }
+    return ok;
+}
+
+bool SkStrikeStore::Write(const SkStrikeCache& cache, const char path[]) {
+    // Other processes may have the file at path mapped, so write a new file and move it into
+    // place rather than changing that one under them.
+    SkString tmp = SkStringPrintf("%s.tmp", path);
+    if (!write_store(cache, tmp.c_str())) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    if (std::rename(tmp.c_str(), path) != 0) {
+        // Windows won't rename over an existing file.
+        std::remove(path);
+        return std::rename(tmp.c_str(), path) == 0;
+    }
+    return true;
+}
+
+sk_sp<SkStrikeStore> SkStrikeStore::Make(const char path[]) {
+    // MakeFromFileName() mmaps the file, so strikes that are never used are never paged in.
+    return Make(SkData::MakeFromFileName(path));
+}
+
+sk_sp<SkStrikeStore> SkStrikeStore::Make(sk_sp<SkData> data) {
+    if (!data || data->size() < sizeof(Header)) {
+        return nullptr;
+    }
+
+    Header header;
+    memcpy(&header, data->data(), sizeof(header));
+    if (header.magic       != kStrikeStoreMagic          ||
+        header.version     != kStrikeStoreVersion        ||
+        header.milestone   != SK_MILESTONE               ||
+        header.recSize     != sizeof(SkScalerContextRec) ||
+        header.metricsSize != sizeof(SkFontMetrics)      ||
+        header.count       >  (data->size() - sizeof(header)) / sizeof(Entry)) {
+        return nullptr;
+    }
+
+    std::vector<Entry> entries(header.count);
+    memcpy(entries.data(), data->bytes() + sizeof(header), entries.size() * sizeof(Entry));
+    if (header.tableChecksum != SkOpts::hash(entries.data(), entries.size() * sizeof(Entry))) {
+        return nullptr;
+    }
+    for (const Entry& entry : entries) {
+        if (entry.offset % 8 != 0 ||
+            entry.offset > data->size() || entry.size > data->size() - entry.offset) {
+            return nullptr;
+        }
+    }
+
+    return sk_sp<SkStrikeStore>(new SkStrikeStore(std::move(data), std::move(entries)));
+}
+
+SkStrikeStore::SkStrikeStore(sk_sp<SkData> data, std::vector<Entry> entries)
+        : fData{std::move(data)}
+        , fEntries{std::move(entries)}
+        , fChecked{new std::atomic<uint8_t>[fEntries.size()]} {
+    for (int i = 0; i < this->count(); i++) {
+        fIndex.set(index_key(fEntries[i].fontKey, fEntries[i].descChecksum), i);
+        fChecked[i].store(kUnchecked, std::memory_order_relaxed);
+    }
+}
+
+bool SkStrikeStore::checkData(int index) const {
+    // Checking the same data twice gives the same answer, so threads racing here are harmless.
+    uint8_t checked = fChecked[index].load(std::memory_order_relaxed);
+    if (checked == kUnchecked) {
+        const Entry& entry = fEntries[index];
+        checked = entry.dataChecksum == SkOpts::hash(fData->bytes() + entry.offset, entry.size)
+                ? kGood : kBad;
+        fChecked[index].store(checked, std::memory_order_relaxed);
+    }
+    return checked == kGood;
+}
+
+uint64_t SkStrikeStore::fontKey(const SkTypeface& typeface) const {
+    SkAutoMutexExclusive lock(fFontKeyMutex);
+    if (const uint64_t* key = fFontKeys.find(typeface.uniqueID())) {
+        return *key;
+    }
+    return *fFontKeys.set(typeface.uniqueID(), make_font_key(typeface));
+}
+
+auto SkStrikeStore::find(const SkDescriptor& desc, const SkTypeface& typeface,
+                         SkFontMetrics* metrics) const -> const Entry* {
+    if (fEntries.empty()) {
+        return nullptr;
+    }
+    const uint64_t fontKey = this->fontKey(typeface);
+    if (!fontKey) {
+        return nullptr;
+    }
+
+    SkAutoDescriptor ad;
+    const SkDescriptor* stored = stored_descriptor(desc, &ad);
+    const int* index = fIndex.find(index_key(fontKey, stored->getChecksum()));
+    if (!index) {
+        return nullptr;
+    }
+
+    const Entry& entry = fEntries[*index];
+    const uint8_t* bytes = fData->bytes() + entry.offset;
+    if (entry.fontKey != fontKey || !this->checkData(*index)) {
+        return nullptr;
+    }
+
+    Deserializer deserializer(reinterpret_cast<const volatile char*>(bytes), entry.size);
+    SkAutoDescriptor entryDesc;
+    if (!deserializer.readDescriptor(&entryDesc) ||
+        *entryDesc.getDesc() != *stored ||
+        !deserializer.read<SkFontMetrics>(metrics)) {
+        return nullptr;
+    }
+    return &entry;
+}
+
+size_t SkStrikeStore::loadGlyphs(const Entry* entry, SkScalerCache* cache) const {
+    Deserializer deserializer(
+            reinterpret_cast<const volatile char*>(fData->bytes() + entry->offset), entry->size);
+
+    // find() has already checked these.
+    SkAutoDescriptor desc;
+    SkFontMetrics metrics;
+    uint64_t glyphCount;
+    if (!deserializer.readDescriptor(&desc) ||
+        !deserializer.read<SkFontMetrics>(&metrics) ||
+        !deserializer.read<uint64_t>(&glyphCount)) {
+        return 0;
+    }
+
+    size_t bytesAdded = 0;
+    for (uint64_t i = 0; i < glyphCount; i++) {
+        SkPackedGlyphID glyphID;
+        uint8_t maskFormat, flags;
+        if (!deserializer.read<SkPackedGlyphID>(&glyphID)) { break; }
+        SkGlyph glyph{glyphID};
+        if (!deserializer.read<float>(&glyph.fAdvanceX) ||
+            !deserializer.read<float>(&glyph.fAdvanceY) ||
+            !deserializer.read<uint16_t>(&glyph.fWidth) ||
+            !deserializer.read<uint16_t>(&glyph.fHeight) ||
+            !deserializer.read<int16_t>(&glyph.fTop) ||
+            !deserializer.read<int16_t>(&glyph.fLeft) ||
+            !deserializer.read<uint8_t>(&maskFormat) || !SkMask::IsValidFormat(maskFormat) ||
+            !deserializer.read<uint8_t>(&flags)) {
+            break;
+        }
+        glyph.fMaskFormat = static_cast<SkMask::Format>(maskFormat);
+
+        if (flags & kHasImage) {
+            if (glyph.isEmpty() || glyph.imageTooLarge()) { break; }
+            const volatile void* image =
+                    deserializer.read(glyph.imageSize(), glyph.formatAlignment());
+            if (!image) { break; }
+            glyph.fImage = (void*)image;
+        }
+        auto [merged, glyphBytes] = cache->mergeGlyphAndImage(glyphID, glyph);
+        bytesAdded += glyphBytes;
+
+        if (flags & kHasPath) {
+            uint64_t pathSize;
+            if (!deserializer.read<uint64_t>(&pathSize)) { break; }
+            SkPath path;
+            if (pathSize > 0) {
+                const volatile void* pathData = deserializer.read(pathSize, kPathAlignment);
+                if (!pathData ||
+                    !path.readFromMemory(const_cast<const void*>(pathData), pathSize)) {
+                    break;
+                }
+            }
+            auto [_, pathBytes] = cache->mergePath(merged, pathSize > 0 ? &path : nullptr);
+            bytesAdded += pathBytes;
+        }
+    }
+    return bytesAdded;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkStrikeStore_DEFINED
+#define SkStrikeStore_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkTypes.h"
+#include "include/private/SkMutex.h"
+#include "include/private/SkTHash.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class SkDescriptor;
+class SkScalerCache;
+class SkStrikeCache;
+class SkTypeface;
+struct SkFontMetrics;
+
+// SkStrikeStore is a file of strikes saved from an SkStrikeCache: each strike's descriptor and
+// font metrics, and the metrics, images, and paths of its glyphs. One process writes the file,
+// and any number of processes map it read-only and give it to their SkStrikeCache, which then
+// fills the strikes it creates from the file instead of asking the typeface's scaler for them.
+//
+// A typeface's uniqueID only means something within one process, so strikes are keyed by their
+// descriptor with the typeface ID zeroed, plus a key derived from the font itself. A typeface
+// made from the same font in another process finds them.
+class SkStrikeStore final : public SkNVRefCnt<SkStrikeStore> {
+public:
+    // Writes every strike in cache to path, replacing any file there.
+    static bool Write(const SkStrikeCache& cache, const char path[]);
+
+    // Returns nullptr if the file is missing, truncated, written by a different Skia milestone or
+    // version of this code, or its table of strikes is corrupt. A strike's data is checked
+    // against its checksum the first time it's found, and the strike is ignored if that fails.
+    static sk_sp<SkStrikeStore> Make(const char path[]);
+    static sk_sp<SkStrikeStore> Make(sk_sp<SkData> data);
+
+    int count() const { return SkToInt(fEntries.size()); }
+
+    // A strike's place in the file, as written in the file's table of strikes.
+    struct Entry {
+        uint64_t fontKey;
+        uint32_t descChecksum;
+        uint32_t dataChecksum;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    // Returns the strike stored for desc, which uses typeface, and fills in its font metrics;
+    // or returns nullptr if there is none. This may read the font and the whole strike, so call
+    // it without holding locks other threads need.
+    const Entry* find(const SkDescriptor& desc, const SkTypeface& typeface,
+                      SkFontMetrics* metrics) const;
+
+    // Adds entry's glyphs to cache, which must not have any of them yet, and returns the number
+    // of bytes they added.
+    size_t loadGlyphs(const Entry* entry, SkScalerCache* cache) const;
+
+private:
+    SkStrikeStore(sk_sp<SkData> data, std::vector<Entry> entries);
+
+    uint64_t fontKey(const SkTypeface& typeface) const;
+
+    // Whether fEntries[index]'s data matches its checksum; only hashed the first time.
+    bool checkData(int index) const;
+
+    const sk_sp<SkData>      fData;
+    const std::vector<Entry> fEntries;
+
+    enum : uint8_t { kUnchecked, kGood, kBad };
+    const std::unique_ptr<std::atomic<uint8_t>[]> fChecked;
+
+    // Index into fEntries by the entry's font key and descriptor checksum, combined.
+    SkTHashMap<uint64_t, int> fIndex;
+
+    // Font keys by typeface uniqueID, since making one reads the font.
+    mutable SkMutex                        fFontKeyMutex;
+    mutable SkTHashMap<uint32_t, uint64_t> fFontKeys SK_GUARDED_BY(fFontKeyMutex);
+};
+
+#endif  // SkStrikeStore_DEFINED
@@ -16,6 +16,7 @@
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeSpec.h"
 #include "src/core/SkTextBlobPriv.h"
+#include "src/core/SkTextBlobRasterCache.h"
 #include "src/core/SkWriteBuffer.h"
 
 #include <atomic>
@@ -144,7 +145,8 @@ static int32_t next_id() {
 SkTextBlob::SkTextBlob(const SkRect& bounds)
     : fBounds(bounds)
     , fUniqueID(next_id())
-    , fCacheID(SK_InvalidUniqueID) {}
+    , fCacheID(SK_InvalidUniqueID)
+    , fAddedToRasterCache(false) {}
 
 SkTextBlob::~SkTextBlob() {
 #if SK_SUPPORT_GPU
@@ -152,6 +154,9 @@ SkTextBlob::~SkTextBlob() {
         GrTextBlobCache::PostPurgeBlobMessage(fUniqueID, fCacheID);
     }
 #endif
+    if (fAddedToRasterCache.load()) {
+        SkTextBlobRasterCache::PostPurgeBlobMessage(fUniqueID);
+    }
 
     const auto* run = RunRecord::First(this);
     do {
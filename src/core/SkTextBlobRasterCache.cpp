@@ -0,0 +1,195 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkTextBlobRasterCache.h"
+
+#include "include/core/SkTextBlob.h"
+#include "src/core/SkOpts.h"
+
+// All raster caches get every message; there is only the global one outside of tests.
+static constexpr uint32_t kRasterCacheBusID = 1;
+
+DECLARE_SKMESSAGEBUS_MESSAGE(SkTextBlobRasterCache::PurgeBlobMessage, uint32_t, true)
+DECLARE_SKMESSAGEBUS_MESSAGE(SkTextBlobRasterCache::PurgeStrikeMessage, uint32_t, true)
+
+static inline bool SkShouldPostMessageToBus(
+        const SkTextBlobRasterCache::PurgeBlobMessage&, uint32_t) {
+    return true;
+}
+
+static inline bool SkShouldPostMessageToBus(
+        const SkTextBlobRasterCache::PurgeStrikeMessage&, uint32_t) {
+    return true;
+}
+
+SkTextBlobRasterCache* SkTextBlobRasterCache::GlobalCache() {
+    static auto* cache = new SkTextBlobRasterCache;
+    return cache;
+}
+
+SkTextBlobRasterCache::SkTextBlobRasterCache(size_t glyphBudget)
+        : fGlyphBudget{glyphBudget}
+        , fPurgeBlobInbox{kRasterCacheBusID}
+        , fPurgeStrikeInbox{kRasterCacheBusID} {}
+
+SkTextBlobRasterCache::~SkTextBlobRasterCache() {
+    this->purgeAll();
+}
+
+uint32_t SkTextBlobRasterCache::KeyHash::operator()(const Key& key) const {
+    return SkOpts::hash_fn(&key, sizeof(Key), 0);
+}
+
+sk_sp<SkTextBlobRasterCache::Entry> SkTextBlobRasterCache::find(const Key& key) {
+    SkAutoMutexExclusive lock{fMutex};
+    this->purgeStaleBlobs();
+    this->purgeStaleStrikes();
+    sk_sp<Entry>* found = fEntries.find(key);
+    if (!found) {
+        return nullptr;
+    }
+    Entry* entry = found->get();
+    if (entry != fLRU.head()) {
+        fLRU.remove(entry);
+        fLRU.addToHead(entry);
+    }
+    return *found;
+}
+
+void SkTextBlobRasterCache::add(sk_sp<Entry> entry, const SkTextBlob& blob) {
+    SkASSERT(entry->fKey.fBlobID == blob.uniqueID());
+    SkAutoMutexExclusive lock{fMutex};
+    this->purgeStaleBlobs();
+    this->purgeStaleStrikes();
+    if (entry->fGlyphCount > fGlyphBudget || fEntries.find(entry->fKey)) {
+        return;
+    }
+    // Strikes removed from the strike cache from now on will be purged from this one; strikes
+    // it removed already would never be.
+    for (const Run& run : entry->fRuns) {
+        run.fStrike->fHeldByTextBlobCache = true;
+        if (run.fStrike->fRemoved) {
+            return;
+        }
+    }
+
+    blob.notifyAddedToRasterCache();
+    SkSTArray<1, Key>* keys = fKeysForBlob.find(entry->fKey.fBlobID);
+    if (!keys) {
+        keys = fKeysForBlob.set(entry->fKey.fBlobID, SkSTArray<1, Key>());
+    }
+    keys->push_back(entry->fKey);
+    fGlyphCount += entry->fGlyphCount;
+    fLRU.addToHead(entry.get());
+    const Key key = entry->fKey;
+    fEntries.set(key, std::move(entry));
+    this->purgeAsNeeded();
+}
+
+void SkTextBlobRasterCache::purgeAll() {
+    SkAutoMutexExclusive lock{fMutex};
+    while (Entry* entry = fLRU.tail()) {
+        this->remove(entry);
+    }
+    SkASSERT(fGlyphCount == 0);
+}
+
+void SkTextBlobRasterCache::setGlyphBudget(size_t glyphBudget) {
+    SkAutoMutexExclusive lock{fMutex};
+    fGlyphBudget = glyphBudget;
+    this->purgeAsNeeded();
+}
+
+size_t SkTextBlobRasterCache::getGlyphCount() {
+    SkAutoMutexExclusive lock{fMutex};
+    this->purgeStaleBlobs();
+    this->purgeStaleStrikes();
+    return fGlyphCount;
+}
+
+int SkTextBlobRasterCache::getEntryCount() {
+    SkAutoMutexExclusive lock{fMutex};
+    this->purgeStaleBlobs();
+    this->purgeStaleStrikes();
+    return fEntries.count();
+}
+
+void SkTextBlobRasterCache::PostPurgeBlobMessage(uint32_t blobID) {
+    SkASSERT(blobID != SK_InvalidGenID);
+    SkMessageBus<PurgeBlobMessage, uint32_t>::Post(PurgeBlobMessage(blobID));
+}
+
+void SkTextBlobRasterCache::PostPurgeStrikeMessage(const SkStrike* strike) {
+    SkMessageBus<PurgeStrikeMessage, uint32_t>::Post(PurgeStrikeMessage(strike));
+}
+
+void SkTextBlobRasterCache::purgeStaleBlobs() {
+    SkTArray<PurgeBlobMessage> msgs;
+    fPurgeBlobInbox.poll(&msgs);
+    for (const auto& msg : msgs) {
+        SkSTArray<1, Key>* keys = fKeysForBlob.find(msg.fBlobID);
+        if (!keys) {
+            continue;
+        }
+        // Removing the last entry for the blob also removes its keys.
+        SkSTArray<1, Key> stale = *keys;
+        for (const Key& key : stale) {
+            if (sk_sp<Entry>* entry = fEntries.find(key)) {
+                this->remove(entry->get());
+            }
+        }
+    }
+}
+
+void SkTextBlobRasterCache::purgeStaleStrikes() {
+    SkTArray<PurgeStrikeMessage> msgs;
+    fPurgeStrikeInbox.poll(&msgs);
+    if (msgs.empty()) {
+        return;
+    }
+    SkTHashSet<const SkStrike*> purged;
+    for (const auto& msg : msgs) {
+        purged.add(msg.fStrike);
+    }
+    std::vector<Entry*> stale;
+    fEntries.foreach([&](const Key&, sk_sp<Entry>* entry) {
+        for (const Run& run : (*entry)->fRuns) {
+            if (purged.contains(run.fStrike.get())) {
+                stale.push_back(entry->get());
+                break;
+            }
+        }
+    });
+    for (Entry* entry : stale) {
+        this->remove(entry);
+    }
+}
+
+void SkTextBlobRasterCache::purgeAsNeeded() {
+    while (fGlyphCount > fGlyphBudget) {
+        this->remove(fLRU.tail());
+    }
+}
+
+void SkTextBlobRasterCache::remove(Entry* entry) {
+    const Key key = entry->fKey;
+    if (SkSTArray<1, Key>* keys = fKeysForBlob.find(key.fBlobID)) {
+        for (int i = 0; i < keys->count(); ++i) {
+            if ((*keys)[i] == key) {
+                keys->removeShuffle(i);
+                break;
+            }
+        }
+        if (keys->empty()) {
+            fKeysForBlob.remove(key.fBlobID);
+        }
+    }
+    SkASSERT(fGlyphCount >= entry->fGlyphCount);
+    fGlyphCount -= entry->fGlyphCount;
+    fLRU.remove(entry);
+    fEntries.remove(key);
+}
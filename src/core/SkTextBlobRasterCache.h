@@ -0,0 +1,131 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTextBlobRasterCache_DEFINED
+#define SkTextBlobRasterCache_DEFINED
+
+#include "include/core/SkColor.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRefCnt.h"
+#include "include/private/SkMutex.h"
+#include "include/private/SkTArray.h"
+#include "include/private/SkTHash.h"
+#include "src/core/SkMessageBus.h"
+#include "src/core/SkStrikeCache.h"
+#include "src/core/SkTInternalLList.h"
+
+#include <cstring>
+#include <vector>
+
+class SkGlyph;
+class SkTextBlob;
+
+// The raster counterpart of GrTextBlobCache: the glyphs a text blob drew with, and their device
+// positions, for the blobs drawn most recently. Drawing a blob again with the same key finds
+// them here instead of making strike specs, finding strikes, and looking up each glyph, and only
+// offsets the positions by the integral difference in where the blob lands on the device.
+//
+// Only blobs drawn entirely as masks are kept. Entries hold a ref on their strikes, which keeps
+// those strikes' glyph images alive; an entry is purged when its blob is deleted, or when the
+// strike cache purges one of its strikes, so that it doesn't keep them alive outside that
+// cache's budget.
+class SkTextBlobRasterCache {
+public:
+    static constexpr size_t kDefaultGlyphBudget = 64 * 1024;
+
+    static SkTextBlobRasterCache* GlobalCache();
+
+    explicit SkTextBlobRasterCache(size_t glyphBudget = kDefaultGlyphBudget);
+    ~SkTextBlobRasterCache();
+
+    // Everything, besides the blob itself, that decides which glyphs are drawn and where they
+    // land relative to the blob's origin on the device: the device matrix without its
+    // translation, the sub-pixel part of the blob's origin on the device, and the paint and
+    // device properties that go into the strike spec.
+    struct Key {
+        uint32_t fBlobID;
+        uint32_t fScalerContextFlags;
+        uint32_t fSurfacePropsFlags;
+        uint32_t fPixelGeometry;
+        SkColor  fLuminanceColor;
+        SkScalar fScaleX, fSkewX, fSkewY, fScaleY;
+        SkPoint  fOriginFraction;
+
+        bool operator==(const Key& that) const { return 0 == memcmp(this, &that, sizeof(Key)); }
+    };
+
+    struct Run {
+        sk_sp<SkStrike>        fStrike;
+        std::vector<SkGlyph*>  fGlyphs;
+        std::vector<SkPoint>   fPositions;
+    };
+
+    class Entry : public SkNVRefCnt<Entry> {
+    public:
+        explicit Entry(const Key& key) : fKey{key} {}
+
+        const Key fKey;
+        // Where the blob's origin landed on the device when fRuns were positioned.
+        SkPoint fMappedOrigin{0, 0};
+        std::vector<Run> fRuns;
+        size_t fGlyphCount{0};
+
+    private:
+        friend class SkTextBlobRasterCache;
+        SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
+    };
+
+    sk_sp<Entry> find(const Key& key) SK_EXCLUDES(fMutex);
+
+    // Adds entry, for blob, unless an entry with its key is there already.
+    void add(sk_sp<Entry> entry, const SkTextBlob& blob) SK_EXCLUDES(fMutex);
+
+    void purgeAll() SK_EXCLUDES(fMutex);
+
+    // The budget is in glyphs, since entries are mostly their glyphs and positions. A budget of
+    // zero turns the cache off.
+    void setGlyphBudget(size_t glyphBudget) SK_EXCLUDES(fMutex);
+    size_t getGlyphCount() SK_EXCLUDES(fMutex);
+    int getEntryCount() SK_EXCLUDES(fMutex);
+
+    struct PurgeBlobMessage {
+        PurgeBlobMessage(uint32_t blobID) : fBlobID(blobID) {}
+        uint32_t fBlobID;
+    };
+
+    static void PostPurgeBlobMessage(uint32_t blobID);
+
+    // Only compared with the strikes entries hold, never dereferenced.
+    struct PurgeStrikeMessage {
+        PurgeStrikeMessage(const SkStrike* strike) : fStrike(strike) {}
+        const SkStrike* fStrike;
+    };
+
+    static void PostPurgeStrikeMessage(const SkStrike* strike);
+
+private:
+    struct KeyHash {
+        uint32_t operator()(const Key& key) const;
+    };
+
+    void purgeStaleBlobs() SK_REQUIRES(fMutex);
+    void purgeStaleStrikes() SK_REQUIRES(fMutex);
+    void purgeAsNeeded() SK_REQUIRES(fMutex);
+    void remove(Entry* entry) SK_REQUIRES(fMutex);
+
+    SkMutex fMutex;
+    SkTHashMap<Key, sk_sp<Entry>, KeyHash> fEntries SK_GUARDED_BY(fMutex);
+    // The keys drawn for each blob, so they can be purged with it.
+    SkTHashMap<uint32_t, SkSTArray<1, Key>> fKeysForBlob SK_GUARDED_BY(fMutex);
+    SkTInternalLList<Entry> fLRU SK_GUARDED_BY(fMutex);
+    size_t fGlyphBudget SK_GUARDED_BY(fMutex);
+    size_t fGlyphCount SK_GUARDED_BY(fMutex) {0};
+    SkMessageBus<PurgeBlobMessage, uint32_t>::Inbox fPurgeBlobInbox SK_GUARDED_BY(fMutex);
+    SkMessageBus<PurgeStrikeMessage, uint32_t>::Inbox fPurgeStrikeInbox SK_GUARDED_BY(fMutex);
+};
+
+#endif  // SkTextBlobRasterCache_DEFINED
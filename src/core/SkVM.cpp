@@ -5,21 +5,27 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkData.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
+#include "include/core/SkTime.h"
 #include "include/private/SkChecksum.h"
 #include "include/private/SkHalf.h"
+#include "include/private/SkMutex.h"
 #include "include/private/SkSpinlock.h"
+#include "include/private/SkTHash.h"
 #include "include/private/SkTFitsIn.h"
 #include "include/private/SkThreadID.h"
 #include "include/private/SkVx.h"
 #include "src/core/SkColorSpaceXformSteps.h"
 #include "src/core/SkCpu.h"
 #include "src/core/SkEnumerate.h"
+#include "src/core/SkLRUCache.h"
 #include "src/core/SkOpts.h"
 #include "src/core/SkVM.h"
 #include <algorithm>
 #include <atomic>
+#include <cstdio>
 #include <queue>
 
 #if defined(SKVM_LLVM)
@@ -38,6 +44,7 @@
 
 bool gSkVMAllowJIT{false};
 bool gSkVMJITViaDylib{false};
+bool gSkVMAllowAVX512{true};
 
 #if defined(SKVM_JIT)
     #if defined(SK_BUILD_FOR_WIN)
@@ -1729,6 +1736,58 @@ namespace skvm {
         return vex;
     }
 
+    // The EVEX prefix extends VEX to AVX-512: 512-bit registers, 32 of them, and opmasks.
+    struct EVEX {
+        uint8_t bytes[4];
+    };
+
+    static EVEX evex(bool  W,   // Same as VEX WE.
+                     int   R,   // Top two bits of dst register, dst>>3.
+                     bool  X,   // Same as REX X, or bit 4 of a register y.
+                     bool  B,   // Same as REX B.
+                     int map,   // SSE opcode map selector: 0x0f, 0x380f, 0x3a0f.
+                     int   V,   // 5-bit second operand register.
+                     int   L,   // 0, 1, 2 for 128-, 256-, 512-bit operations.
+                     int  pp,   // SSE mandatory prefix: 0x66, 0xf3, 0xf2, else none.
+                     int aaa,   // Opmask register, 0 meaning no masking.
+                     bool  z) { // Zero inactive lanes rather than merging?
+        map = [map]{
+            switch (map) {
+                case   0x0f: return 0b01;
+                case 0x380f: return 0b10;
+                case 0x3a0f: return 0b11;
+            }
+            SkUNREACHABLE;
+        }();
+
+        pp = [pp]{
+            switch (pp) {
+                case 0x66: return 0b01;
+                case 0xf3: return 0b10;
+                case 0xf2: return 0b11;
+            }
+            return 0b00;
+        }();
+
+        // Like VEX, EVEX stores register extension bits and the second operand inverted.
+        EVEX evex;
+        evex.bytes[0] = 0x62;
+        evex.bytes[1] = (map          &  3) << 0
+                      | (~(R>>1)      &  1) << 4   // R'
+                      | (~(int)B      &  1) << 5
+                      | (~(int)X      &  1) << 6
+                      | (~R           &  1) << 7;
+        evex.bytes[2] = (pp           &  3) << 0
+                      | 1                   << 2   // Fixed 1.
+                      | (~V           & 15) << 3
+                      | (W            &  1) << 7;
+        evex.bytes[3] = (aaa          &  7) << 0
+                      | (~(V>>4)      &  1) << 3   // V'
+                      | (L            &  3) << 5
+                      | (z            &  1) << 7;
+        return evex;
+    }
+
     Assembler::Assembler(void* buf) : fCode((uint8_t*)buf), fSize(0) {}
 
     size_t Assembler::size() const { return fSize; }
@@ -2113,6 +2172,209 @@ namespace skvm {
         this->byte(sib(scale, ix&7, base&7));
     }
 
+    void Assembler::op(int prefix, int map, int opcode, int dst, int x, Operand y, W w, L l,
+                       int disp8, Opmask k, bool zero) {
+        zero = zero && k != k0;  // Zeroing without a mask is reserved.
+        switch (y.kind) {
+            case Operand::REG: {
+                EVEX e = evex(w, dst>>3, y.reg>>4, (y.reg>>3)&1,
+                              map, x, l, prefix, k, zero);
+                this->bytes(e.bytes, 4);
+                this->byte(opcode);
+                this->byte(mod_rm(Mod::Direct, dst&7, y.reg&7));
+            } return;
+
+            case Operand::MEM: {
+                const Mem& m = y.mem;
+                const bool need_SIB = m.base  == rsp
+                                   || m.index != rsp;
+
+                // An 8-bit displacement is implicitly scaled by disp8, so use one only when
+                // m.disp is a small multiple of disp8, and otherwise fall back to 32-bit.
+                Mod md = Mod::Indirect;
+                int disp = m.disp;
+                if (disp != 0) {
+                    md = disp % disp8 == 0 && SkTFitsIn<int8_t>(disp / disp8) ? Mod::OneByteImm
+                                                                              : Mod::FourByteImm;
+                    if (md == Mod::OneByteImm) {
+                        disp /= disp8;
+                    }
+                }
+
+                EVEX e = evex(w, dst>>3, m.index>>3, m.base>>3,
+                              map, x, l, prefix, k, zero);
+                this->bytes(e.bytes, 4);
+                this->byte(opcode);
+                this->byte(mod_rm(md, dst&7, (need_SIB ? rsp : m.base)&7));
+                if (need_SIB) {
+                    this->byte(sib(m.scale, m.index&7, m.base&7));
+                }
+                this->bytes(&disp, imm_bytes(md));
+            } return;
+
+            case Operand::LABEL: {
+                const int rip = rbp;
+
+                EVEX e = evex(w, dst>>3, 0, rip>>3,
+                              map, x, l, prefix, k, zero);
+                this->bytes(e.bytes, 4);
+                this->byte(opcode);
+                this->byte(mod_rm(Mod::Indirect, dst&7, rip&7));
+                this->word(this->disp32(y.label));
+            } return;
+        }
+    }
+
+    void Assembler::vpaddd (Zmm dst, Zmm x, Operand y) { this->op(0x66,  0x0f,0xfe, dst,x,y); }
+    void Assembler::vpsubd (Zmm dst, Zmm x, Operand y) { this->op(0x66,  0x0f,0xfa, dst,x,y); }
+    void Assembler::vpmulld(Zmm dst, Zmm x, Operand y) { this->op(0x66,0x380f,0x40, dst,x,y); }
+
+    void Assembler::vpandd (Zmm dst, Zmm x, Operand y) { this->op(0x66,0x0f,0xdb, dst,x,y); }
+    void Assembler::vpandnd(Zmm dst, Zmm x, Operand y) { this->op(0x66,0x0f,0xdf, dst,x,y); }
+    void Assembler::vpord  (Zmm dst, Zmm x, Operand y) { this->op(0x66,0x0f,0xeb, dst,x,y); }
+    void Assembler::vpxord (Zmm dst, Zmm x, Operand y) { this->op(0x66,0x0f,0xef, dst,x,y); }
+
+    void Assembler::vpternlogd(Zmm dst, Zmm x, Operand y, int imm) {
+        this->op(0x66,0x3a0f,0x25, dst,x,y);
+        this->imm_byte_after_operand(y, imm);
+    }
+
+    void Assembler::vaddps(Zmm dst, Zmm x, Operand y) { this->op(0,0x0f,0x58, dst,x,y); }
+    void Assembler::vsubps(Zmm dst, Zmm x, Operand y) { this->op(0,0x0f,0x5c, dst,x,y); }
+    void Assembler::vmulps(Zmm dst, Zmm x, Operand y) { this->op(0,0x0f,0x59, dst,x,y); }
+    void Assembler::vdivps(Zmm dst, Zmm x, Operand y) { this->op(0,0x0f,0x5e, dst,x,y); }
+    void Assembler::vminps(Zmm dst, Zmm x, Operand y) { this->op(0,0x0f,0x5d, dst,x,y); }
+    void Assembler::vmaxps(Zmm dst, Zmm x, Operand y) { this->op(0,0x0f,0x5f, dst,x,y); }
+
+    void Assembler::vsqrtps(Zmm dst, Operand x) { this->op(0,0x0f,0x51, dst,x); }
+
+    void Assembler::vfmadd132ps(Zmm dst, Zmm x, Operand y) { this->op(0x66,0x380f,0x98, dst,x,y); }
+    void Assembler::vfmadd213ps(Zmm dst, Zmm x, Operand y) { this->op(0x66,0x380f,0xa8, dst,x,y); }
+    void Assembler::vfmadd231ps(Zmm dst, Zmm x, Operand y) { this->op(0x66,0x380f,0xb8, dst,x,y); }
+
+    void Assembler::vfmsub132ps(Zmm dst, Zmm x, Operand y) { this->op(0x66,0x380f,0x9a, dst,x,y); }
+    void Assembler::vfmsub213ps(Zmm dst, Zmm x, Operand y) { this->op(0x66,0x380f,0xaa, dst,x,y); }
+    void Assembler::vfmsub231ps(Zmm dst, Zmm x, Operand y) { this->op(0x66,0x380f,0xba, dst,x,y); }
+
+    void Assembler::vfnmadd132ps(Zmm dst, Zmm x, Operand y) { this->op(0x66,0x380f,0x9c, dst,x,y); }
+    void Assembler::vfnmadd213ps(Zmm dst, Zmm x, Operand y) { this->op(0x66,0x380f,0xac, dst,x,y); }
+    void Assembler::vfnmadd231ps(Zmm dst, Zmm x, Operand y) { this->op(0x66,0x380f,0xbc, dst,x,y); }
+
+    void Assembler::vpcmpeqd(Opmask dst, Zmm x, Operand y) {
+        this->op(0x66,0x0f,0x76, dst,x,y,W0,L512, 64);
+    }
+    void Assembler::vpcmpgtd(Opmask dst, Zmm x, Operand y) {
+        this->op(0x66,0x0f,0x66, dst,x,y,W0,L512, 64);
+    }
+    void Assembler::vcmpps(Opmask dst, Zmm x, Operand y, int imm) {
+        this->op(0,0x0f,0xc2, dst,x,y,W0,L512, 64);
+        this->imm_byte_after_operand(y, imm);
+    }
+
+    void Assembler::vpmovm2d(Zmm dst, Opmask src) {
+        this->op(0xf3,0x380f,0x38, dst,0,src,W0,L512, 64);
+    }
+
+    // As with the VEX shifts, the opcode extension goes in "dst", dst in x, and x in y.
+    void Assembler::vpslld(Zmm dst, Zmm x, int imm) {
+        this->op(0x66,0x0f,0x72,(Zmm)6, dst,x);
+        this->byte(imm);
+    }
+    void Assembler::vpsrld(Zmm dst, Zmm x, int imm) {
+        this->op(0x66,0x0f,0x72,(Zmm)2, dst,x);
+        this->byte(imm);
+    }
+    void Assembler::vpsrad(Zmm dst, Zmm x, int imm) {
+        this->op(0x66,0x0f,0x72,(Zmm)4, dst,x);
+        this->byte(imm);
+    }
+
+    void Assembler::vrndscaleps(Zmm dst, Operand x, Rounding imm) {
+        this->op(0x66,0x3a0f,0x08, dst,x);
+        this->imm_byte_after_operand(x, imm);
+    }
+
+    void Assembler::vmovups(Zmm dst, Operand src, Opmask k) {
+        this->op(0,0x0f,0x10, dst,0,src,W0,L512, 64, k,/*zero=*/true);
+    }
+    void Assembler::vmovups(Operand dst, Zmm src, Opmask k) {
+        this->op(0,0x0f,0x11, src,0,dst,W0,L512, 64, k);
+    }
+
+    void Assembler::vmovdqu8(Xmm dst, Operand src, Opmask k) {
+        this->op(0xf2,0x0f,0x6f, dst,0,src,W0,L128, 16, k,/*zero=*/true);
+    }
+    void Assembler::vmovdqu8(Operand dst, Xmm src, Opmask k) {
+        this->op(0xf2,0x0f,0x7f, src,0,dst,W0,L128, 16, k);
+    }
+    void Assembler::vmovdqu16(Ymm dst, Operand src, Opmask k) {
+        this->op(0xf2,0x0f,0x6f, dst,0,src,W1,L256, 32, k,/*zero=*/true);
+    }
+    void Assembler::vmovdqu16(Operand dst, Ymm src, Opmask k) {
+        this->op(0xf2,0x0f,0x7f, src,0,dst,W1,L256, 32, k);
+    }
+
+    void Assembler::vcvtdq2ps (Zmm dst, Operand x) { this->op(   0,0x0f,0x5b, dst,x); }
+    void Assembler::vcvttps2dq(Zmm dst, Operand x) { this->op(0xf3,0x0f,0x5b, dst,x); }
+    void Assembler::vcvtps2dq (Zmm dst, Operand x) { this->op(0x66,0x0f,0x5b, dst,x); }
+
+    void Assembler::vcvtps2ph(Operand dst, Zmm x, Rounding imm) {
+        this->op(0x66,0x3a0f,0x1d, x,0,dst,W0,L512, 32);
+        this->imm_byte_after_operand(dst, imm);
+    }
+    void Assembler::vcvtph2ps(Zmm dst, Operand x) {
+        this->op(0x66,0x380f,0x13, dst,0,x,W0,L512, 32);
+    }
+
+    void Assembler::vbroadcastss(Zmm dst, Operand y) {
+        this->op(0x66,0x380f,0x18, dst,0,y,W0,L512, 4);
+    }
+    void Assembler::vpbroadcastd(Zmm dst, GP64 src) {
+        this->op(0x66,0x380f,0x7c, dst,0,src,W0,L512, 4);
+    }
+
+    void Assembler::vpmovzxwd(Zmm dst, Operand src) {
+        this->op(0x66,0x380f,0x33, dst,0,src,W0,L512, 32);
+    }
+    void Assembler::vpmovzxbd(Zmm dst, Operand src) {
+        this->op(0x66,0x380f,0x31, dst,0,src,W0,L512, 16);
+    }
+    void Assembler::vpmovdw(Operand dst, Zmm src) {
+        this->op(0xf3,0x380f,0x33, src,0,dst,W0,L512, 32);
+    }
+    void Assembler::vpmovdb(Operand dst, Zmm src) {
+        this->op(0xf3,0x380f,0x31, src,0,dst,W0,L512, 16);
+    }
+
+    void Assembler::vgatherdps(Zmm dst, Scale scale, Zmm ix, GP64 base, Opmask mask) {
+        // As with the AVX2 gather, no aliasing is permitted, and we must use a real mask.
+        SkASSERT(dst != ix);
+        SkASSERT(mask != k0);
+
+        // The index register's top bit rides in V', the rest where an SIB index would go.
+        EVEX e = evex(0, dst>>3, (ix>>3)&1, base>>3,
+                      0x380f, /*V=*/(ix & 16), 2, 0x66, mask, /*z=*/false);
+        this->bytes(e.bytes, 4);
+        this->byte(0x92);
+        this->byte(mod_rm(Mod::Indirect, dst&7, rsp/*use SIB*/));
+        this->byte(sib(scale, ix&7, base&7));
+    }
+
+    // Opmask and BMI2 instructions are VEX encoded, even those working with GP64 registers.
+    void Assembler::kmovw(Opmask dst, GP64 src) {
+        this->op(0,0x0f,0x92, dst,0,src,W0,L128);
+    }
+    void Assembler::kmovw(Opmask dst, Opmask src) {
+        this->op(0,0x0f,0x90, dst,0,src,W0,L128);
+    }
+    void Assembler::kxnorw(Opmask dst, Opmask x, Opmask y) {
+        this->op(0,0x0f,0x46, dst,x,y,W0,L256);
+    }
+
+    void Assembler::bzhi(GP64 dst, Operand x, GP64 ix) {
+        this->op(0,0x380f,0xf5, dst,ix,x,W1,L128);
+    }
+
     // https://static.docs.arm.com/ddi0596/a/DDI_0596_ARM_a64_instruction_set_architecture.pdf
 
     static int operator"" _mask(unsigned long long bits) { return (1<<(int)bits)-1; }
@@ -3004,6 +3266,19 @@ namespace skvm {
 
 #if defined(SKVM_JIT)
 
+#if defined(__x86_64__) || defined(_M_X64)
+    // The AVX-512 backend handles every op but these; programs using them JIT with AVX2.
+    static bool avx512_can_jit(Op op) {
+        switch (op) {
+            case Op::assert_true:
+            case Op::store64: case Op::store128:
+            case Op::load64:  case Op::load128:
+            case Op::gather8: case Op::gather16: return false;
+            default:                             return true;
+        }
+    }
+#endif
+
     bool Program::jit(const std::vector<OptimizedInstruction>& instructions,
                       int* stack_hint,
                       uint32_t* registers_used,
@@ -3033,7 +3308,16 @@ namespace skvm {
         if (!SkCpu::Supports(SkCpu::HSW)) {
             return false;
         }
-        const int K = 8;
+        // With AVX-512 we run 16 lanes at a time in zmm registers, and finish with one masked
+        // trip through the loop rather than a scalar tail.  We still allocate registers as Ymm,
+        // and stick to zmm0-15 so the calling conventions below apply unchanged.
+        const bool avx512 = gSkVMAllowAVX512
+                         && SkCpu::Supports(SkCpu::SKX)
+                         && std::all_of(instructions.begin(), instructions.end(),
+                                        [](const OptimizedInstruction& inst) {
+                                            return avx512_can_jit(inst.op);
+                                        });
+        const int K = avx512 ? 16 : 8;
         using Reg = A::Ymm;
         #if defined(_M_X64)  // Important to check this first; clang-cl defines both.
             const A::GP64 N = A::rcx,
@@ -3137,21 +3421,24 @@ namespace skvm {
         #endif
 
         auto load_from_memory = [&](Reg r, Val v) {
+            A::Operand src = A::Mem{A::rsp, stack_slot[v]*K*4};
             if (instructions[v].op == Op::splat) {
                 if (instructions[v].immA == 0) {
-                    a->vpxor(r,r,r);
-                } else {
-                    a->vmovups(r, constants.find(instructions[v].immA));
+                    a->vpxor(r,r,r);  // VEX zeroes the top of zmm registers too.
+                    return;
                 }
+                src = constants.find(instructions[v].immA);
             } else {
                 SkASSERT(stack_slot[v] != NA);
-                a->vmovups(r, A::Mem{A::rsp, stack_slot[v]*K*4});
             }
+            if (avx512) { a->vmovups((A::Zmm)r, src); }
+            else        { a->vmovups(        r, src); }
         };
         auto store_to_stack = [&](Reg r, Val v) {
             SkASSERT(next_stack_slot < nstack_slots);
             stack_slot[v] = next_stack_slot++;
-            a->vmovups(A::Mem{A::rsp, stack_slot[v]*K*4}, r);
+            if (avx512) { a->vmovups(A::Mem{A::rsp, stack_slot[v]*K*4}, (A::Zmm)r); }
+            else        { a->vmovups(A::Mem{A::rsp, stack_slot[v]*K*4},          r); }
         };
     #elif defined(__aarch64__)
         const int K = 4;
@@ -3390,6 +3677,222 @@ namespace skvm {
             };
         #endif
 
+        #if defined(__x86_64__) || defined(_M_X64)
+            // The AVX-512 backend mirrors AVX2 below, but there's no scalar tail:
+            // instead the k1 opmask marks which lanes of the final masked loop trip are live.
+            // Comparisons produce opmasks we expand back out to skvm's all-bits-set lanes.
+            if (avx512) {
+                auto zr   = [&](Val v)                   { return (A::Zmm)r(v); };
+                auto zdst = [&](Val h1=NA, Val h2=NA)   { return (A::Zmm)dst(h1,h2); };
+                const A::Opmask live = scalar ? A::k1 : A::k0;
+
+                switch (op) {
+                    case Op::splat:
+                        (void)constants[immA];
+                        break;
+
+                    case Op::assert_true:
+                    case Op::store64: case Op::store128:
+                    case Op::load64:  case Op::load128:
+                    case Op::gather8: case Op::gather16:
+                        SkASSERT(!avx512_can_jit(op));
+                        return false;
+
+                    case Op::store8:
+                        if (scalar) {
+                            a->vpmovdb ((A::Xmm)dst(x), zr(x));
+                            a->vmovdqu8(A::Mem{arg[immA]}, (A::Xmm)dst(), A::k1);
+                        } else {
+                            a->vpmovdb(A::Mem{arg[immA]}, zr(x));
+                        } break;
+
+                    case Op::store16:
+                        if (scalar) {
+                            a->vpmovdw  ((A::Ymm)dst(x), zr(x));
+                            a->vmovdqu16(A::Mem{arg[immA]}, (A::Ymm)dst(), A::k1);
+                        } else {
+                            a->vpmovdw(A::Mem{arg[immA]}, zr(x));
+                        } break;
+
+                    case Op::store32: a->vmovups(A::Mem{arg[immA]}, zr(x), live); break;
+
+                    case Op::load8:
+                        if (scalar) {
+                            a->vmovdqu8 ((A::Xmm)dst(), A::Mem{arg[immA]}, A::k1);
+                            a->vpmovzxbd(zdst(), (A::Xmm)dst());
+                        } else {
+                            a->vpmovzxbd(zdst(), A::Mem{arg[immA]});
+                        } break;
+
+                    case Op::load16:
+                        if (scalar) {
+                            a->vmovdqu16((A::Ymm)dst(), A::Mem{arg[immA]}, A::k1);
+                            a->vpmovzxwd(zdst(), (A::Ymm)dst());
+                        } else {
+                            a->vpmovzxwd(zdst(), A::Mem{arg[immA]});
+                        } break;
+
+                    case Op::load32: a->vmovups(zdst(), A::Mem{arg[immA]}, live); break;
+
+                    case Op::gather32:
+                        a->mov(GP0, A::Mem{arg[immA], immB});
+                        if (scalar) { a->kmovw (A::k2, A::k1); }
+                        else        { a->kxnorw(A::k2, A::k2, A::k2); }  // (All lanes enabled.)
+                        a->vgatherdps(zdst(), A::FOUR, zr(x), GP0, A::k2);
+                        break;
+
+                    case Op::uniform32: a->vbroadcastss(zdst(), A::Mem{arg[immA], immB});
+                                        break;
+
+                    case Op::index: a->vpbroadcastd(zdst(), N);
+                                    a->vpsubd(zdst(), zdst(), &iota);
+                                    break;
+
+                    case Op::add_f32:
+                        if (in_reg(x)) { a->vaddps(zdst(x), zr(x), any(y)); }
+                        else           { a->vaddps(zdst(y), zr(y), any(x)); }
+                                         break;
+
+                    case Op::mul_f32:
+                        if (in_reg(x)) { a->vmulps(zdst(x), zr(x), any(y)); }
+                        else           { a->vmulps(zdst(y), zr(y), any(x)); }
+                                         break;
+
+                    case Op::sub_f32: a->vsubps(zdst(x), zr(x), any(y)); break;
+                    case Op::div_f32: a->vdivps(zdst(x), zr(x), any(y)); break;
+                    case Op::min_f32: a->vminps(zdst(y), zr(y), any(x)); break;
+                    case Op::max_f32: a->vmaxps(zdst(y), zr(y), any(x)); break;
+
+                    case Op::fma_f32:
+                        if (try_alias(x)) { a->vfmadd132ps(zdst(x), zr(z), any(y)); } else
+                        if (try_alias(y)) { a->vfmadd213ps(zdst(y), zr(x), any(z)); } else
+                        if (try_alias(z)) { a->vfmadd231ps(zdst(z), zr(x), any(y)); } else
+                                          { a->vmovups    (zdst(), any(x));
+                                            a->vfmadd132ps(zdst(), zr(z), any(y)); }
+                                            break;
+
+                    case Op::fms_f32:
+                        if (try_alias(x)) { a->vfmsub132ps(zdst(x), zr(z), any(y)); } else
+                        if (try_alias(y)) { a->vfmsub213ps(zdst(y), zr(x), any(z)); } else
+                        if (try_alias(z)) { a->vfmsub231ps(zdst(z), zr(x), any(y)); } else
+                                          { a->vmovups    (zdst(), any(x));
+                                            a->vfmsub132ps(zdst(), zr(z), any(y)); }
+                                            break;
+
+                    case Op::fnma_f32:
+                        if (try_alias(x)) { a->vfnmadd132ps(zdst(x), zr(z), any(y)); } else
+                        if (try_alias(y)) { a->vfnmadd213ps(zdst(y), zr(x), any(z)); } else
+                        if (try_alias(z)) { a->vfnmadd231ps(zdst(z), zr(x), any(y)); } else
+                                          { a->vmovups     (zdst(), any(x));
+                                            a->vfnmadd132ps(zdst(), zr(z), any(y)); }
+                                            break;
+
+                    case Op::sqrt_f32:
+                        if (in_reg(x)) { a->vsqrtps(zdst(x),  zr(x)); }
+                        else           { a->vsqrtps(zdst(), any(x)); }
+                                         break;
+
+                    case Op::add_i32:
+                        if (in_reg(x)) { a->vpaddd(zdst(x), zr(x), any(y)); }
+                        else           { a->vpaddd(zdst(y), zr(y), any(x)); }
+                                         break;
+
+                    case Op::mul_i32:
+                        if (in_reg(x)) { a->vpmulld(zdst(x), zr(x), any(y)); }
+                        else           { a->vpmulld(zdst(y), zr(y), any(x)); }
+                                         break;
+
+                    case Op::sub_i32: a->vpsubd(zdst(x), zr(x), any(y)); break;
+
+                    case Op::bit_and:
+                        if (in_reg(x)) { a->vpandd(zdst(x), zr(x), any(y)); }
+                        else           { a->vpandd(zdst(y), zr(y), any(x)); }
+                                         break;
+                    case Op::bit_or:
+                        if (in_reg(x)) { a->vpord(zdst(x), zr(x), any(y)); }
+                        else           { a->vpord(zdst(y), zr(y), any(x)); }
+                                         break;
+                    case Op::bit_xor:
+                        if (in_reg(x)) { a->vpxord(zdst(x), zr(x), any(y)); }
+                        else           { a->vpxord(zdst(y), zr(y), any(x)); }
+                                         break;
+
+                    case Op::bit_clear: a->vpandnd(zdst(y), zr(y), any(x)); break;
+
+                    case Op::select:  // x ? y : z, bitwise, via truth tables for vpternlogd.
+                        if (try_alias(x)) { a->vpternlogd(zdst(x), zr(y), any(z), 0xca); } else
+                        if (try_alias(z)) { a->vpternlogd(zdst(z), zr(x), any(y), 0xb8); } else
+                                          { a->vmovups   (zdst(), any(x));
+                                            a->vpternlogd(zdst(), zr(y), any(z), 0xca); }
+                                            break;
+
+                    case Op::shl_i32: a->vpslld(zdst(x), zr(x), immA); break;
+                    case Op::shr_i32: a->vpsrld(zdst(x), zr(x), immA); break;
+                    case Op::sra_i32: a->vpsrad(zdst(x), zr(x), immA); break;
+
+                    case Op::gt_i32: a->vpcmpgtd(A::k2, zr(x), any(y));
+                                     a->vpmovm2d(zdst(x), A::k2);
+                                     break;
+
+                    case Op::eq_i32:
+                    case Op::eq_f32:
+                    case Op::neq_f32: {
+                        // These are symmetric, so we compare whichever is in a register to any().
+                        const Val lhs = in_reg(x) ? x : y,
+                                  rhs = in_reg(x) ? y : x;
+                        switch (op) {
+                            default: SkUNREACHABLE;
+                            case Op:: eq_i32: a->vpcmpeqd (A::k2, zr(lhs), any(rhs)); break;
+                            case Op:: eq_f32: a->vcmpeqps (A::k2, zr(lhs), any(rhs)); break;
+                            case Op::neq_f32: a->vcmpneqps(A::k2, zr(lhs), any(rhs)); break;
+                        }
+                        a->vpmovm2d(zdst(lhs), A::k2);
+                    } break;
+
+                    case Op:: gt_f32: a->vcmpltps(A::k2, zr(y), any(x));
+                                      a->vpmovm2d(zdst(y), A::k2);
+                                      break;
+                    case Op::gte_f32: a->vcmpleps(A::k2, zr(y), any(x));
+                                      a->vpmovm2d(zdst(y), A::k2);
+                                      break;
+
+                    case Op::ceil:
+                        if (in_reg(x)) { a->vrndscaleps(zdst(x),  zr(x), Assembler::CEIL); }
+                        else           { a->vrndscaleps(zdst(), any(x), Assembler::CEIL); }
+                                         break;
+
+                    case Op::floor:
+                        if (in_reg(x)) { a->vrndscaleps(zdst(x),  zr(x), Assembler::FLOOR); }
+                        else           { a->vrndscaleps(zdst(), any(x), Assembler::FLOOR); }
+                                         break;
+
+                    case Op::to_f32:
+                        if (in_reg(x)) { a->vcvtdq2ps(zdst(x),  zr(x)); }
+                        else           { a->vcvtdq2ps(zdst(), any(x)); }
+                                         break;
+
+                    case Op::trunc:
+                        if (in_reg(x)) { a->vcvttps2dq(zdst(x),  zr(x)); }
+                        else           { a->vcvttps2dq(zdst(), any(x)); }
+                                         break;
+
+                    case Op::round:
+                        if (in_reg(x)) { a->vcvtps2dq(zdst(x),  zr(x)); }
+                        else           { a->vcvtps2dq(zdst(), any(x)); }
+                                         break;
+
+                    case Op::to_fp16:
+                        a->vcvtps2ph((A::Ymm)dst(x), zr(x), A::CURRENT);  // f32 zmm -> f16 ymm
+                        a->vpmovzxwd(zdst(), (A::Ymm)dst());              // f16 ymm -> f16 zmm
+                        break;
+
+                    case Op::from_fp16:
+                        a->vpmovdw  ((A::Ymm)dst(x), zr(x));   // f16 zmm -> f16 ymm
+                        a->vcvtph2ps(zdst(), (A::Ymm)dst());   // f16 ymm -> f32 zmm
+                        break;
+                }
+            } else
+        #endif
             switch (op) {
                 // Make sure splat constants can be found by load_from_memory() or any().
                 case Op::splat:
@@ -4080,19 +4583,35 @@ namespace skvm {
         {
             a->cmp(N, 1);
             jump_if_less(&done);
+        #if defined(__x86_64__) || defined(_M_X64)
+            if (avx512) {
+                // k1 = (1<<N)-1, marking the remaining N < K lanes live.
+                a->mov (GP0, -1);
+                a->bzhi(GP0, GP0, N);
+                a->kmovw(A::k1, GP0);
+            }
+        #endif
             for (Val id = 0; id < (Val)instructions.size(); id++) {
                 if (!instructions[id].can_hoist && !emit(id, /*scalar=*/true)) {
                     return false;
                 }
             }
-            restore_incoming_regs();
-            for (int i = 0; i < (int)fImpl->strides.size(); i++) {
-                if (fImpl->strides[i]) {
-                    add(arg[i], 1*fImpl->strides[i]);
+        #if defined(__x86_64__) || defined(_M_X64)
+            if (avx512) {
+                // That one masked trip handled every remaining lane, so we're done.
+                *stack_hint = std::max(*stack_hint, next_stack_slot);
+            } else
+        #endif
+            {
+                restore_incoming_regs();
+                for (int i = 0; i < (int)fImpl->strides.size(); i++) {
+                    if (fImpl->strides[i]) {
+                        add(arg[i], 1*fImpl->strides[i]);
+                    }
                 }
+                sub(N, 1);
+                jump(&tail);
             }
-            sub(N, 1);
-            jump(&tail);
         }
 
         a->label(&done);
@@ -4131,8 +4650,233 @@ namespace skvm {
         return true;
     }
 
+    // The JIT code cache.  JIT code is position independent (it makes no calls and finds its
+    // constants PC-relative), so cached bytes can be copied into any executable buffer.
+    namespace {
+        // Bump whenever the file format changes.  Changes to the JIT's output are caught by
+        // Program::JITFingerprint(), which each file records.
+        static constexpr uint32_t kJITCacheVersion = 3;
+        static constexpr uint32_t kJITCacheMagic   = SkSetFourByteTag('s','k','v','m');
+
+        // Programs' code is typically a few KB, so this keeps the cache to a few MB.
+        static constexpr int kJITCacheMaxEntries = 1024;
+
+        struct CachedCode {
+            sk_sp<SkData> storage;  // Owns code: either a copy, or a file from load_jit_cache().
+            const void*   code;
+            size_t        size;
+            double        jit_ms;   // How long the JIT originally took to produce this code.
+        };
+
+        struct JITCache {
+            SkMutex                          mutex;
+            SkLRUCache<uint64_t, CachedCode> entries{kJITCacheMaxEntries};
+            JITCacheStats                    stats;
+        };
+
+        JITCache* jit_cache() {
+            static JITCache* cache = new JITCache;
+            return cache;
+        }
+
+        // Cache files are native-endian and only read back on the machine that wrote them.
+        struct JITCacheFileHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t features;
+            uint64_t fingerprint;  // Program::JITFingerprint() of the build that wrote the file.
+            uint64_t count;
+        };
+        struct JITCacheFileEntry {
+            uint64_t key;
+            uint64_t offset;
+            uint64_t size;
+            double   jit_ms;
+            uint32_t checksum;
+            uint32_t pad;
+        };
+    }
+
+    // The same program JITs to different code on CPUs with different features.
+    static uint64_t cpu_features() {
+        uint64_t features = 0;
+        for (int bit = 0; bit < 32; bit++) {
+            if (SkCpu::Supports(1u << bit)) {
+                features |= 1ull << bit;
+            }
+        }
+    #if defined(__aarch64__)
+        features |= 1ull << 63;
+    #endif
+        return features;
+    }
+
+    static uint64_t jit_cache_key(const std::vector<OptimizedInstruction>& instructions,
+                                  const std::vector<int>& strides) {
+        // OptimizedInstruction has padding, so hash its fields rather than its bytes.
+        std::vector<int> words;
+        words.reserve(9*instructions.size() + 2 + strides.size());
+        for (const OptimizedInstruction& inst : instructions) {
+            words.insert(words.end(), {(int)inst.op, inst.x, inst.y, inst.z, inst.w,
+                                       inst.immA, inst.immB, inst.death, (int)inst.can_hoist});
+        }
+        words.push_back((int)strides.size());
+        words.insert(words.end(), strides.begin(), strides.end());
+        words.push_back((int)gSkVMAllowAVX512);  // Toggling this changes the code we JIT.
+
+        uint32_t lo = SkOpts::hash(words.data(), words.size() * sizeof(int), 0),
+                 hi = SkOpts::hash(words.data(), words.size() * sizeof(int), 1);
+        return (uint64_t)lo | (uint64_t)hi << 32;
+    }
+
+    JITCacheStats jit_cache_stats() {
+        JITCache* cache = jit_cache();
+        SkAutoMutexExclusive lock(cache->mutex);
+        return cache->stats;
+    }
+
+    uint64_t Program::JITFingerprint() {
+        // A program using a spread of the ops SkVMBlitter relies on.  It's assembled into a
+        // scratch buffer, not through setupJIT(), so it never touches the cache itself.
+        static const uint64_t fingerprint = [] {
+            Builder b;
+            Ptr dst      = b.varying<int>(),
+                src      = b.varying<uint8_t>(),
+                uniforms = b.uniform();
+            F32 x = b.to_F32(b.load8(src)),
+                y = b.uniformF(uniforms, 0);
+            x = b.mad(x, y, b.sqrt(x));
+            x = b.min(b.max(x, b.div(1.0f, y)), b.splat(1.0f));
+            I32 i = b.select(b.lt(x, y), b.round(x),
+                             b.gather32(uniforms, 4, b.bit_and(b.trunc(x), 3)));
+            b.store32(dst, b.shl(b.shr(i, 1), 2));
+
+            const std::vector<OptimizedInstruction> instructions = b.optimize();
+            const Program probe = b.done("skvm-jit-fingerprint", /*allow_jit=*/false);
+
+            Assembler a{nullptr};
+            int stack_hint = -1;
+            uint32_t registers_used = 0xffff'ffff;
+            if (!probe.jit(instructions, &stack_hint, &registers_used, &a)) {
+                return uint64_t(0);
+            }
+            std::vector<uint8_t> code(a.size());
+            a = Assembler{code.data()};
+            SkAssertResult(probe.jit(instructions, &stack_hint, &registers_used, &a));
+
+            uint32_t lo = SkOpts::hash(code.data(), code.size(), 0),
+                     hi = SkOpts::hash(code.data(), code.size(), 1);
+            return (uint64_t)lo | (uint64_t)hi << 32;
+        }();
+        return fingerprint;
+    }
+
+    static bool write_jit_cache(const char path[]) {
+        SkFILEWStream file(path);
+        if (!file.isValid()) {
+            return false;
+        }
+
+        JITCache* cache = jit_cache();
+        SkAutoMutexExclusive lock(cache->mutex);
+
+        JITCacheFileHeader header = {
+            kJITCacheMagic, kJITCacheVersion, cpu_features(), Program::JITFingerprint(),
+            (uint64_t)cache->entries.count(),
+        };
+        bool ok = file.write(&header, sizeof(header));
+
+        // A table of entries, then each entry's code, in the same order.
+        uint64_t offset = sizeof(header) + header.count * sizeof(JITCacheFileEntry);
+        cache->entries.foreach([&](const uint64_t* key, const CachedCode* cached) {
+            JITCacheFileEntry entry = {
+                *key, offset, cached->size, cached->jit_ms,
+                SkOpts::hash(cached->code, cached->size), 0,
+            };
+            ok = ok && file.write(&entry, sizeof(entry));
+            offset += cached->size;
+        });
+        cache->entries.foreach([&](const uint64_t*, const CachedCode* cached) {
+            ok = ok && file.write(cached->code, cached->size);
+        });
+        return ok;
+    }
+
+    bool save_jit_cache(const char path[]) {
+        // Entries may still point into a file mapped from path by load_jit_cache(),
+        // so write a new file and move it into place rather than truncating that one.
+        SkString tmp = SkStringPrintf("%s.tmp", path);
+        if (!write_jit_cache(tmp.c_str())) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+        if (std::rename(tmp.c_str(), path) != 0) {
+            // Windows won't rename over an existing file.
+            std::remove(path);
+            return std::rename(tmp.c_str(), path) == 0;
+        }
+        return true;
+    }
+
+    bool load_jit_cache(const char path[]) {
+        // MakeFromFileName() mmaps the file, so unused code is never even paged in.
+        sk_sp<SkData> file = SkData::MakeFromFileName(path);
+        if (!file || file->size() < sizeof(JITCacheFileHeader)) {
+            return false;
+        }
+
+        JITCacheFileHeader header;
+        memcpy(&header, file->data(), sizeof(header));
+        if (header.magic       != kJITCacheMagic             ||
+            header.version     != kJITCacheVersion           ||
+            header.features    != cpu_features()             ||
+            header.fingerprint != Program::JITFingerprint()  ||
+            header.count       >  (file->size() - sizeof(header)) / sizeof(JITCacheFileEntry)) {
+            return false;
+        }
+
+        JITCache* cache = jit_cache();
+        SkAutoMutexExclusive lock(cache->mutex);
+
+        const uint8_t* bytes = file->bytes();
+        for (uint64_t i = 0; i < header.count; i++) {
+            JITCacheFileEntry entry;
+            memcpy(&entry, bytes + sizeof(header) + i*sizeof(entry), sizeof(entry));
+            if (entry.offset > file->size() || entry.size > file->size() - entry.offset) {
+                return false;
+            }
+            const void* code = bytes + entry.offset;
+            if (entry.checksum != SkOpts::hash(code, entry.size)) {
+                return false;
+            }
+            if (!cache->entries.find(entry.key)) {
+                cache->entries.insert(entry.key, {file, code, (size_t)entry.size, entry.jit_ms});
+            }
+        }
+        return true;
+    }
+
     void Program::setupJIT(const std::vector<OptimizedInstruction>& instructions,
                            const char* debug_name) {
+        JITCache* cache = jit_cache();
+        const uint64_t cache_key = jit_cache_key(instructions, fImpl->strides);
+        if (!gSkVMJITViaDylib) {
+            SkAutoMutexExclusive lock(cache->mutex);
+            if (const CachedCode* cached = cache->entries.find(cache_key)) {
+                fImpl->jit_size = cached->size;
+                void* jit_entry = alloc_jit_buffer(&fImpl->jit_size);
+                memcpy(jit_entry, cached->code, cached->size);
+                remap_as_executable(jit_entry, fImpl->jit_size);
+                fImpl->jit_entry.store(jit_entry);
+
+                notify_vtune(debug_name, jit_entry, fImpl->jit_size);
+                cache->stats.hits++;
+                cache->stats.saved_ms += cached->jit_ms;
+                return;
+            }
+        }
+        const double start_ms = SkTime::GetMSecs();
+
         // Assemble with no buffer to determine a.size() (the number of bytes we'll assemble)
         // and stack_hint/registers_used to feed forward into the next jit() call.
         Assembler a{nullptr};
@@ -4156,6 +4900,17 @@ namespace skvm {
 
         notify_vtune(debug_name, jit_entry, fImpl->jit_size);
 
+        {
+            const double jit_ms = SkTime::GetMSecs() - start_ms;
+            sk_sp<SkData> copy = SkData::MakeWithCopy(jit_entry, a.size());
+            SkAutoMutexExclusive lock(cache->mutex);
+            cache->stats.misses++;
+            cache->stats.jit_ms += jit_ms;
+            // Another thread may have JITted the same program meanwhile.
+            cache->entries.insert_or_update(cache_key,
+                                            {copy, copy->data(), copy->size(), jit_ms});
+        }
+
     #if !defined(SK_BUILD_FOR_WIN)
         // For profiling and debugging, it's helpful to have this code loaded
         // dynamically rather than just jumping info fImpl->jit_entry.
@@ -4185,6 +4940,11 @@ namespace skvm {
         }
     #endif
     }
+#else
+    uint64_t Program::JITFingerprint() { return 0; }
+    JITCacheStats jit_cache_stats() { return {}; }
+    bool save_jit_cache(const char[]) { return false; }
+    bool load_jit_cache(const char[]) { return false; }
 #endif
 
 }  // namespace skvm
@@ -48,7 +48,8 @@ namespace skvm {
 
         size_t size() const;
 
-        // Order matters... GP64, Xmm, Ymm values match 4-bit register encoding for each.
+        // Order matters... GP64, Xmm, Ymm values match 4-bit register encoding for each,
+        // Zmm the 5-bit encoding, and Opmask the 3-bit encoding.
         enum GP64 {
             rax, rcx, rdx, rbx, rsp, rbp, rsi, rdi,
             r8 , r9 , r10, r11, r12, r13, r14, r15,
@@ -61,6 +62,13 @@ namespace skvm {
             ymm0, ymm1, ymm2 , ymm3 , ymm4 , ymm5 , ymm6 , ymm7 ,
             ymm8, ymm9, ymm10, ymm11, ymm12, ymm13, ymm14, ymm15,
         };
+        enum Zmm {
+            zmm0 , zmm1 , zmm2 , zmm3 , zmm4 , zmm5 , zmm6 , zmm7 ,
+            zmm8 , zmm9 , zmm10, zmm11, zmm12, zmm13, zmm14, zmm15,
+            zmm16, zmm17, zmm18, zmm19, zmm20, zmm21, zmm22, zmm23,
+            zmm24, zmm25, zmm26, zmm27, zmm28, zmm29, zmm30, zmm31,
+        };
+        enum Opmask { k0, k1, k2, k3, k4, k5, k6, k7 };
 
         // X and V values match 5-bit encoding for each (nothing tricky).
         enum X {
@@ -115,6 +123,8 @@ namespace skvm {
             Operand(GP64   r) : reg  (r), kind(REG  ) {}
             Operand(Xmm    r) : reg  (r), kind(REG  ) {}
             Operand(Ymm    r) : reg  (r), kind(REG  ) {}
+            Operand(Zmm    r) : reg  (r), kind(REG  ) {}
+            Operand(Opmask r) : reg  (r), kind(REG  ) {}
             Operand(Mem    m) : mem  (m), kind(MEM  ) {}
             Operand(Label* l) : label(l), kind(LABEL) {}
         };
@@ -237,6 +247,94 @@ namespace skvm {
         // mask = 0;
         void vgatherdps(Ymm dst, Scale scale, Ymm ix, GP64 base, Ymm mask);
 
+        // AVX-512.  Comparisons write an Opmask, one bit per 32-bit lane.  Ops taking an Opmask
+        // only touch the lanes whose bits are set; k0 means all lanes.  Masked loads zero the
+        // inactive lanes of dst, and masked memory operands never fault in inactive lanes.
+        void vpaddd (Zmm dst, Zmm x, Operand y);
+        void vpsubd (Zmm dst, Zmm x, Operand y);
+        void vpmulld(Zmm dst, Zmm x, Operand y);
+
+        void vpandd (Zmm dst, Zmm x, Operand y);
+        void vpandnd(Zmm dst, Zmm x, Operand y);
+        void vpord  (Zmm dst, Zmm x, Operand y);
+        void vpxord (Zmm dst, Zmm x, Operand y);
+
+        // dst = imm[ (dst<<2) | (x<<1) | y ], bitwise, so e.g. 0xca is dst ? x : y.
+        void vpternlogd(Zmm dst, Zmm x, Operand y, int imm);
+
+        void vaddps(Zmm dst, Zmm x, Operand y);
+        void vsubps(Zmm dst, Zmm x, Operand y);
+        void vmulps(Zmm dst, Zmm x, Operand y);
+        void vdivps(Zmm dst, Zmm x, Operand y);
+        void vminps(Zmm dst, Zmm x, Operand y);
+        void vmaxps(Zmm dst, Zmm x, Operand y);
+
+        void vsqrtps(Zmm dst, Operand x);
+
+        void vfmadd132ps(Zmm dst, Zmm x, Operand y);
+        void vfmadd213ps(Zmm dst, Zmm x, Operand y);
+        void vfmadd231ps(Zmm dst, Zmm x, Operand y);
+
+        void vfmsub132ps(Zmm dst, Zmm x, Operand y);
+        void vfmsub213ps(Zmm dst, Zmm x, Operand y);
+        void vfmsub231ps(Zmm dst, Zmm x, Operand y);
+
+        void vfnmadd132ps(Zmm dst, Zmm x, Operand y);
+        void vfnmadd213ps(Zmm dst, Zmm x, Operand y);
+        void vfnmadd231ps(Zmm dst, Zmm x, Operand y);
+
+        void vpcmpeqd(Opmask dst, Zmm x, Operand y);
+        void vpcmpgtd(Opmask dst, Zmm x, Operand y);
+
+        void vcmpps   (Opmask dst, Zmm x, Operand y, int imm);
+        void vcmpeqps (Opmask dst, Zmm x, Operand y) { this->vcmpps(dst,x,y,0); }
+        void vcmpltps (Opmask dst, Zmm x, Operand y) { this->vcmpps(dst,x,y,1); }
+        void vcmpleps (Opmask dst, Zmm x, Operand y) { this->vcmpps(dst,x,y,2); }
+        void vcmpneqps(Opmask dst, Zmm x, Operand y) { this->vcmpps(dst,x,y,4); }
+
+        void vpmovm2d(Zmm dst, Opmask src);  // dst = src ? ~0 : 0, per 32-bit lane
+
+        void vpslld(Zmm dst, Zmm x, int imm);
+        void vpsrld(Zmm dst, Zmm x, int imm);
+        void vpsrad(Zmm dst, Zmm x, int imm);
+
+        void vrndscaleps(Zmm dst, Operand x, Rounding);
+
+        void vmovups(Zmm dst, Operand src, Opmask = k0);
+        void vmovups(Operand dst, Zmm src, Opmask = k0);
+
+        void vmovdqu8 (Xmm dst, Operand src, Opmask);  // 16x  8-bit lanes
+        void vmovdqu8 (Operand dst, Xmm src, Opmask);
+        void vmovdqu16(Ymm dst, Operand src, Opmask);  // 16x 16-bit lanes
+        void vmovdqu16(Operand dst, Ymm src, Opmask);
+
+        void vcvtdq2ps (Zmm dst, Operand x);
+        void vcvttps2dq(Zmm dst, Operand x);
+        void vcvtps2dq (Zmm dst, Operand x);
+
+        void vcvtps2ph(Operand dst, Zmm x, Rounding);
+        void vcvtph2ps(Zmm dst, Operand x);
+
+        void vbroadcastss(Zmm dst, Operand y);
+        void vpbroadcastd(Zmm dst, GP64 src);   // dst = src, 32-bit, in every lane
+
+        void vpmovzxwd(Zmm dst, Operand src);   // dst = src, 256-bit, uint16_t -> int
+        void vpmovzxbd(Zmm dst, Operand src);   // dst = src, 128-bit, uint8_t  -> int
+        void vpmovdw  (Operand dst, Zmm src);   // dst = src, 256-bit, int -> uint16_t, truncating
+        void vpmovdb  (Operand dst, Zmm src);   // dst = src, 128-bit, int -> uint8_t,  truncating
+
+        // if (mask & (1<<i)) {
+        //     dst[i] = base[scale*ix[i]];
+        // }
+        // mask = 0;
+        void vgatherdps(Zmm dst, Scale scale, Zmm ix, GP64 base, Opmask mask);
+
+        void kmovw (Opmask dst, GP64 src);      // dst = src, low 16 bits
+        void kmovw (Opmask dst, Opmask src);
+        void kxnorw(Opmask dst, Opmask x, Opmask y);
+
+        void bzhi(GP64 dst, Operand x, GP64 ix);  // dst = x & ((1<<ix)-1), BMI2
+
 
         void label(Label*);
 
@@ -391,7 +489,7 @@ namespace skvm {
 
         // x86-64
         enum W { W0, W1 };      // Are the lanes 64-bit (W1) or default (W0)?  Intel Vol 2A 2.3.5.5
-        enum L { L128, L256 };  // Is this a 128- or 256-bit operation?        Intel Vol 2A 2.3.6.2
+        enum L { L128, L256, L512 };  // 128-, 256-, or (EVEX only) 512-bit?  Intel Vol 2A 2.3.6.2
 
         // Helpers for vector instructions.
         void op(int prefix, int map, int opcode, int dst, int x, Operand y, W,L);
@@ -400,6 +498,18 @@ namespace skvm {
         void op(int p, int m, int o, Xmm d, Xmm x, Operand y, W w=W0) { op(p,m,o, d,x,y,w,L128); }
         void op(int p, int m, int o, Xmm d,        Operand y, W w=W0) { op(p,m,o, d,0,y,w,L128); }
 
+        // EVEX helper.  EVEX scales 8-bit memory displacements by the size of the memory operand,
+        // disp8, usually the full vector width but smaller for broadcasts or narrowing ops.
+        // Masking zeroes inactive lanes when zero is set, otherwise merges (stores must merge).
+        void op(int prefix, int map, int opcode, int dst, int x, Operand y, W,L,
+                int disp8, Opmask = k0, bool zero = false);
+        void op(int p, int m, int o, Zmm d, Zmm x, Operand y, W w=W0) {
+            op(p,m,o, d,x,y,w,L512, 64);
+        }
+        void op(int p, int m, int o, Zmm d,        Operand y, W w=W0) {
+            op(p,m,o, d,0,y,w,L512, 64);
+        }
+
         // Helpers for GP64 instructions.
         void op(int opcode, Operand dst, GP64 x);
         void op(int opcode, int opcode_ext, Operand dst, int imm);
@@ -985,6 +1095,10 @@ namespace skvm {
 
         bool hasJIT() const;  // Has this Program been JITted?
 
+        // A hash of the code this build's JIT assembles for a fixed reference program, or 0
+        // without a JIT.  It changes with any change to how the JIT translates that program's ops.
+        static uint64_t JITFingerprint();
+
         void dump(SkWStream* = nullptr) const;
 
     private:
@@ -1003,6 +1117,21 @@ namespace skvm {
         std::unique_ptr<Impl> fImpl;
     };
 
+    // Machine code from Program's JIT is cached process-wide, keyed by a hash of the program and
+    // the CPU features it was compiled for.  That cache can be saved to a file, and a file can be
+    // loaded (mmapped) back into a later process, letting it skip JIT compilation of any program
+    // it shares with the one that saved it.  A file is only loaded when this build JITs a reference
+    // program (Program::JITFingerprint()) to the same code as the build that wrote it did.
+    struct JITCacheStats {
+        int    hits     = 0;  // Programs whose code came from the cache.
+        int    misses   = 0;  // Programs JIT-compiled from scratch.
+        double jit_ms   = 0;  // Time spent JIT-compiling misses.
+        double saved_ms = 0;  // Time it originally took to compile the hits.
+    };
+    JITCacheStats jit_cache_stats();
+    bool load_jit_cache(const char path[]);
+    bool save_jit_cache(const char path[]);
+
     // TODO: control flow
     // TODO: 64-bit values?
 
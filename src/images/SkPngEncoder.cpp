@@ -9,6 +9,7 @@
 
 #ifdef SK_ENCODE_PNG
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
 #include "include/encode/SkPngEncoder.h"
@@ -16,10 +17,12 @@
 #include "src/codec/SkColorTable.h"
 #include "src/codec/SkPngPriv.h"
 #include "src/core/SkMSAN.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/images/SkImageEncoderFns.h"
 #include <vector>
 
 #include "png.h"
+#include "zlib.h"
 
 static_assert(PNG_FILTER_NONE  == (int)SkPngEncoder::FilterFlag::kNone,  "Skia libpng filter err.");
 static_assert(PNG_FILTER_SUB   == (int)SkPngEncoder::FilterFlag::kSub,   "Skia libpng filter err.");
@@ -59,6 +62,9 @@ public:
     bool writeInfo(const SkImageInfo& srcInfo);
     void chooseProc(const SkImageInfo& srcInfo);
 
+    bool canWriteRowsInParallel(const SkPixmap& src) const;
+    bool writeRowsInParallel(const SkPixmap& src, const SkPngEncoder::Options& options);
+
     png_structp pngPtr() { return fPngPtr; }
     png_infop infoPtr() { return fInfoPtr; }
     int pngBytesPerPixel() const { return fPngBytesPerPixel; }
@@ -78,6 +84,8 @@ private:
     png_structp             fPngPtr;
     png_infop               fInfoPtr;
     int                     fPngBytesPerPixel;
+    int                     fFilters;
+    int                     fZLibLevel;
     transform_scanline_proc fProc;
 };
 
@@ -197,10 +205,12 @@ bool SkPngEncoderMgr::setHeader(const SkImageInfo& srcInfo, const SkPngEncoder::
     int filters = (int)options.fFilterFlags & (int)SkPngEncoder::FilterFlag::kAll;
     SkASSERT(filters == (int)options.fFilterFlags);
     png_set_filter(fPngPtr, PNG_FILTER_TYPE_BASE, filters);
+    fFilters = filters;
 
     int zlibLevel = std::min(std::max(0, options.fZLibLevel), 9);
     SkASSERT(zlibLevel == options.fZLibLevel);
     png_set_compression_level(fPngPtr, zlibLevel);
+    fZLibLevel = zlibLevel;
 
     // Set comments in tEXt chunk
     const sk_sp<SkDataTable>& comments = options.fComments;
@@ -392,6 +402,205 @@ void SkPngEncoderMgr::chooseProc(const SkImageInfo& srcInfo) {
     fProc = choose_proc(srcInfo);
 }
 
+// When encoding in parallel, rows are split into bands of roughly this many unfiltered bytes.
+// Each band is filtered and deflated on its own, seeded with the tail of the previous band as
+// the deflate dictionary (like pigz), and the raw deflate streams are concatenated into IDAT.
+static constexpr size_t kParallelBandBytes = 128 * 1024;
+static constexpr size_t kDeflateWindowBytes = 32 * 1024;
+
+static inline uint8_t paeth_predictor(int a, int b, int c) {
+    int p  = a + b - c,
+        pa = std::abs(p - a),
+        pb = std::abs(p - b),
+        pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Writes the filter type byte followed by the filtered row to dst.  prev is the unfiltered
+// previous row, which is all zeros for the first row of the image.
+static void filter_row(int filter, const uint8_t* row, const uint8_t* prev, size_t len, int bpp,
+                       uint8_t* dst) {
+    for (size_t i = 0; i < len; i++) {
+        int a = i >= (size_t)bpp ? row[i - bpp] : 0,
+            b = prev[i],
+            c = i >= (size_t)bpp ? prev[i - bpp] : 0;
+        switch (filter) {
+            case PNG_FILTER_VALUE_NONE:  dst[i + 1] = row[i];                               break;
+            case PNG_FILTER_VALUE_SUB:   dst[i + 1] = row[i] - a;                           break;
+            case PNG_FILTER_VALUE_UP:    dst[i + 1] = row[i] - b;                           break;
+            case PNG_FILTER_VALUE_AVG:   dst[i + 1] = row[i] - ((a + b) >> 1);              break;
+            case PNG_FILTER_VALUE_PAETH: dst[i + 1] = row[i] - paeth_predictor(a, b, c);    break;
+        }
+    }
+    dst[0] = filter;
+}
+
+// Picks a filter for the row the same way libpng does: if more than one filter is allowed,
+// choose the one minimizing the sum of the filtered bytes interpreted as signed values.
+static void filter_row_best(int filters, const uint8_t* row, const uint8_t* prev, size_t len,
+                            int bpp, uint8_t* dst, uint8_t* scratch) {
+    static constexpr struct { int flag, value; } kFilters[] = {
+        { PNG_FILTER_NONE,  PNG_FILTER_VALUE_NONE  },
+        { PNG_FILTER_SUB,   PNG_FILTER_VALUE_SUB   },
+        { PNG_FILTER_UP,    PNG_FILTER_VALUE_UP    },
+        { PNG_FILTER_AVG,   PNG_FILTER_VALUE_AVG   },
+        { PNG_FILTER_PAETH, PNG_FILTER_VALUE_PAETH },
+    };
+
+    if (filters == PNG_FILTER_NONE || filters == 0) {
+        filter_row(PNG_FILTER_VALUE_NONE, row, prev, len, bpp, dst);
+        return;
+    }
+
+    uint64_t bestSum = UINT64_MAX;
+    for (auto f : kFilters) {
+        if (!(filters & f.flag)) {
+            continue;
+        }
+        filter_row(f.value, row, prev, len, bpp, scratch);
+        uint64_t sum = 0;
+        for (size_t i = 1; i <= len; i++) {
+            sum += scratch[i] < 128 ? scratch[i] : 256 - scratch[i];
+        }
+        if (sum < bestSum) {
+            bestSum = sum;
+            memcpy(dst, scratch, len + 1);
+        }
+    }
+}
+
+bool SkPngEncoderMgr::canWriteRowsInParallel(const SkPixmap& src) const {
+    // libpng may repack our rows (e.g. png_set_filler() for opaque F16), in which case the
+    // transformed rows are not what ends up in IDAT and we must let libpng write them.
+    const size_t rowBytes = (size_t)fPngBytesPerPixel * src.width();
+    return fProc &&
+           png_get_rowbytes(fPngPtr, fInfoPtr) == rowBytes &&
+           (size_t)src.height() * rowBytes >= 2 * kParallelBandBytes;
+}
+
+bool SkPngEncoderMgr::writeRowsInParallel(const SkPixmap& src,
+                                          const SkPngEncoder::Options& options) {
+    SkASSERT(options.fExecutor);
+    SkASSERT(this->canWriteRowsInParallel(src));
+
+    const int    bpp       = fPngBytesPerPixel;
+    const size_t rowBytes  = (size_t)bpp * src.width();
+    const int    bandRows  = std::max<int>(1, kParallelBandBytes / rowBytes);
+    const int    bandCount = (src.height() + bandRows - 1) / bandRows;
+
+    struct Band {
+        std::vector<uint8_t> fFiltered;
+        std::vector<uint8_t> fDeflated;
+        uLong                fAdler;
+        bool                 fOk;
+    };
+    std::vector<Band> bands(bandCount);
+
+    SkTaskGroup taskGroup(*options.fExecutor);
+
+    // Transform and filter each band.  The row above a band is re-transformed so that bands
+    // don't depend on each other.
+    taskGroup.batch(bandCount, [&](int i) {
+        const int top    = i * bandRows,
+                  bottom = std::min(top + bandRows, src.height());
+        std::vector<uint8_t> rows(2 * rowBytes, 0), scratch(rowBytes + 1);
+        uint8_t* prev = rows.data();
+        uint8_t* curr = rows.data() + rowBytes;
+        if (top > 0) {
+            fProc((char*)prev, (const char*)src.addr(0, top - 1), src.width(),
+                  SkColorTypeBytesPerPixel(src.colorType()));
+        }
+
+        Band& band = bands[i];
+        band.fFiltered.resize((bottom - top) * (rowBytes + 1));
+        uint8_t* dst = band.fFiltered.data();
+        for (int y = top; y < bottom; y++) {
+            const void* srcRow = src.addr(0, y);
+            sk_msan_assert_initialized(
+                    srcRow, (const uint8_t*)srcRow + (src.width() << src.shiftPerPixel()));
+            fProc((char*)curr, (const char*)srcRow, src.width(),
+                  SkColorTypeBytesPerPixel(src.colorType()));
+            filter_row_best(fFilters, curr, prev, rowBytes, bpp, dst, scratch.data());
+            std::swap(prev, curr);
+            dst += rowBytes + 1;
+        }
+        band.fAdler = adler32(adler32(0L, Z_NULL, 0), band.fFiltered.data(),
+                              band.fFiltered.size());
+    });
+    taskGroup.wait();
+
+    // Deflate each band as raw deflate data, ending all but the last band on a byte boundary.
+    taskGroup.batch(bandCount, [&](int i) {
+        Band& band = bands[i];
+        band.fOk = false;
+
+        z_stream z;
+        memset(&z, 0, sizeof(z));
+        const int strategy = fFilters == PNG_FILTER_NONE ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+        if (deflateInit2(&z, fZLibLevel, Z_DEFLATED, -MAX_WBITS, 8, strategy) != Z_OK) {
+            return;
+        }
+        if (i > 0) {
+            const std::vector<uint8_t>& prev = bands[i - 1].fFiltered;
+            const size_t dictSize = std::min(prev.size(), kDeflateWindowBytes);
+            deflateSetDictionary(&z, prev.data() + prev.size() - dictSize, dictSize);
+        }
+
+        const bool last = i == bandCount - 1;
+        // Room for the zlib header, the Z_SYNC_FLUSH marker, and the adler32 trailer.
+        band.fDeflated.resize(deflateBound(&z, band.fFiltered.size()) + 16);
+        const size_t headerBytes = i == 0 ? 2 : 0;
+        z.next_in   = band.fFiltered.data();
+        z.avail_in  = band.fFiltered.size();
+        z.next_out  = band.fDeflated.data() + headerBytes;
+        z.avail_out = band.fDeflated.size() - headerBytes;
+        int result = deflate(&z, last ? Z_FINISH : Z_SYNC_FLUSH);
+        band.fOk = last ? result == Z_STREAM_END
+                        : result == Z_OK && z.avail_in == 0 && z.avail_out > 0;
+        band.fDeflated.resize(z.total_out + headerBytes);
+        deflateEnd(&z);
+    });
+    taskGroup.wait();
+
+    uLong adler = bands[0].fAdler;
+    for (int i = 0; i < bandCount; i++) {
+        if (!bands[i].fOk) {
+            return false;
+        }
+        if (i > 0) {
+            adler = adler32_combine(adler, bands[i].fAdler, bands[i].fFiltered.size());
+        }
+    }
+
+    // zlib header for a 32K window; FLEVEL mirrors what deflate() itself would write.
+    const int flevel = fZLibLevel < 2 ? 0 : fZLibLevel < 6 ? 1 : fZLibLevel == 6 ? 2 : 3;
+    uint16_t header = (0x78 << 8) | (flevel << 6);
+    header += 31 - (header % 31);
+    bands.front().fDeflated[0] = header >> 8;
+    bands.front().fDeflated[1] = header & 0xFF;
+
+    std::vector<uint8_t>& tail = bands.back().fDeflated;
+    tail.push_back((adler >> 24) & 0xFF);
+    tail.push_back((adler >> 16) & 0xFF);
+    tail.push_back((adler >>  8) & 0xFF);
+    tail.push_back((adler >>  0) & 0xFF);
+
+    if (setjmp(png_jmpbuf(fPngPtr))) {
+        return false;
+    }
+
+    static constexpr png_byte kIDAT[5] = { 'I', 'D', 'A', 'T', '\0' };
+    static constexpr png_byte kIEND[5] = { 'I', 'E', 'N', 'D', '\0' };
+    for (const Band& band : bands) {
+        png_write_chunk(fPngPtr, kIDAT, band.fDeflated.data(), band.fDeflated.size());
+    }
+    png_write_chunk(fPngPtr, kIEND, nullptr, 0);
+    return true;
+}
+
 std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkPixmap& src,
                                               const Options& options) {
     if (!SkPixmapIsValid(src)) {
@@ -456,7 +665,17 @@ bool SkPngEncoder::onEncodeRows(int numRows) {
 
 bool SkPngEncoder::Encode(SkWStream* dst, const SkPixmap& src, const Options& options) {
     auto encoder = SkPngEncoder::Make(dst, src, options);
-    return encoder.get() && encoder->encodeRows(src.height());
+    if (!encoder) {
+        return false;
+    }
+
+    if (options.fExecutor) {
+        SkPngEncoderMgr* encoderMgr = static_cast<SkPngEncoder*>(encoder.get())->fEncoderMgr.get();
+        if (encoderMgr->canWriteRowsInParallel(src)) {
+            return encoderMgr->writeRowsInParallel(src, options);
+        }
+    }
+    return encoder->encodeRows(src.height());
 }
 
 #endif
@@ -0,0 +1,300 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBlur_opts_DEFINED
+#define SkBlur_opts_DEFINED
+
+#include "include/private/SkVx.h"
+#include "src/core/SkBlurEngine.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <immintrin.h>
+#endif
+
+// The three box blur of SkBlurEngine, run over several scanlines at once: each lane of the sums
+// is one channel of one scanline. The three boxes are summed in a single pass, keeping the
+// trailing edges of each in circular buffers; see blur_rows() for the details.
+
+namespace SK_OPTS_NS {
+
+    namespace blur {
+
+        using VecU32 = skvx::Vec<SkBlurPass::kLanes, uint32_t>;
+        using U8     = skvx::Vec<SkBlurPass::kLanes, uint8_t>;
+
+    #if !defined(SKNX_NO_SIMD) && (defined(__clang__) || defined(__GNUC__))
+        // GCC keeps 256-bit skvx::Vecs in memory between operations, so the sums are native
+        // vectors where there are any.
+        using U32 = skvx::VExt<SkBlurPass::kLanes, uint32_t>;
+    #else
+        using U32 = VecU32;
+    #endif
+
+        static inline U32 load(const uint32_t* p) {
+            U32 v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+        static inline void store(uint32_t* p, const U32& v) {
+            memcpy(p, &v, sizeof(v));
+        }
+
+        // skvx::cast() is only vectorized when building with Clang, and these run for every
+        // pixel, so they spell out the conversions and the 32x32->64 bit multiply for x86.
+        static inline U32 widen(const U8& v) {
+        #if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+            return skvx::bit_pun<U32>(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)&v)));
+        #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+            __m128i zero   = _mm_setzero_si128(),
+                    shorts = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)&v), zero),
+                    lo     = _mm_unpacklo_epi16(shorts, zero),
+                    hi     = _mm_unpackhi_epi16(shorts, zero);
+            U32 wide;
+            memcpy((char*)&wide,      &lo, 16);
+            memcpy((char*)&wide + 16, &hi, 16);
+            return wide;
+        #else
+            return skvx::bit_pun<U32>(skvx::cast<uint32_t>(v));
+        #endif
+        }
+
+        // Every lane of v is at most 255.
+        static inline U8 narrow(const U32& v) {
+        #if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+            __m128i lo, hi;
+            memcpy(&lo, (const char*)&v,      16);
+            memcpy(&hi, (const char*)&v + 16, 16);
+            __m128i shorts = _mm_packs_epi32(lo, hi);
+            U8 bytes;
+            _mm_storel_epi64((__m128i*)&bytes, _mm_packus_epi16(shorts, shorts));
+            return bytes;
+        #else
+            return skvx::cast<uint8_t>(skvx::bit_pun<VecU32>(v));
+        #endif
+        }
+
+        // (x * y) >> 32, lane by lane.
+        static inline U32 mul_hi(const U32& x, uint32_t y) {
+        #if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+            __m256i X = skvx::bit_pun<__m256i>(x),
+                    Y = _mm256_set1_epi32(y);
+            __m256i evens = _mm256_srli_epi64(_mm256_mul_epu32(X, Y), 32),
+                    odds  = _mm256_mul_epu32(_mm256_srli_epi64(X, 32), Y);
+            return skvx::bit_pun<U32>(_mm256_blend_epi32(evens, odds, 0xAA));
+        #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+            const __m128i Y    = _mm_set1_epi32(y),
+                          mask = _mm_set_epi32(-1, 0, -1, 0);
+            auto mul_hi4 = [&](__m128i X) {
+                __m128i evens = _mm_srli_epi64(_mm_mul_epu32(X, Y), 32),
+                        odds  = _mm_mul_epu32(_mm_srli_epi64(X, 32), Y);
+                return _mm_or_si128(evens, _mm_and_si128(odds, mask));
+            };
+            __m128i lo, hi;
+            memcpy(&lo, (const char*)&x,      16);
+            memcpy(&hi, (const char*)&x + 16, 16);
+            lo = mul_hi4(lo);
+            hi = mul_hi4(hi);
+            U32 result;
+            memcpy((char*)&result,      &lo, 16);
+            memcpy((char*)&result + 16, &hi, 16);
+            return result;
+        #else
+            auto wide = skvx::cast<uint64_t>(skvx::bit_pun<VecU32>(x));
+            return skvx::bit_pun<U32>(skvx::cast<uint32_t>((wide * y) >> 32));
+        #endif
+        }
+
+        // Two 8888 scanlines, four channels each.
+        struct Rows_8888 {
+            using Type = uint32_t;
+            static constexpr int kRows = SkBlurPass::kLanes / 4;
+
+            static U32 Load(const uint32_t* const rows[], int x) {
+                uint32_t px[kRows];
+                for (int i = 0; i < kRows; ++i) {
+                    px[i] = rows[i][x];
+                }
+                return widen(U8::Load(px));
+            }
+            static void Store(uint32_t* dst, const U32& v, int n) {
+                U8 px = narrow(v);
+                if (n == kRows) {
+                    px.store(dst);
+                } else {
+                    memcpy(dst, &px, n * sizeof(uint32_t));
+                }
+            }
+        };
+
+        // Eight A8 scanlines.
+        struct Rows_A8 {
+            using Type = uint8_t;
+            static constexpr int kRows = SkBlurPass::kLanes;
+
+            static U32 Load(const uint8_t* const rows[], int x) {
+                uint8_t px[kRows];
+                for (int i = 0; i < kRows; ++i) {
+                    px[i] = rows[i][x];
+                }
+                return widen(U8::Load(px));
+            }
+            static void Store(uint8_t* dst, const U32& v, int n) {
+                U8 px = narrow(v);
+                if (n == kRows) {
+                    px.store(dst);
+                } else {
+                    memcpy(dst, &px, n * sizeof(uint8_t));
+                }
+            }
+        };
+
+        // The three running sums of a group of scanlines, and the trailing edges of each.
+        class Sums {
+        public:
+            Sums(const SkBlurPass& pass, uint32_t* scratch)
+                : fSum2{U32{} + pass.fHalf}
+                , fWeight{pass.fWeight}
+                , fBuffer0{scratch}
+                , fBuffer1{fBuffer0 + pass.fPass0Size * SkBlurPass::kLanes}
+                , fBuffer2{fBuffer1 + pass.fPass1Size * SkBlurPass::kLanes}
+                , fPass01Size{pass.fPass0Size}
+                , fPass2Size{pass.fPass2Size} {
+                SkASSERT(pass.fPass0Size == pass.fPass1Size);
+            }
+
+            // Move the window ahead using the leading edge, returning the blurred value.
+            SK_ALWAYS_INLINE U32 next(const U32& leadingEdge) {
+                constexpr int L = SkBlurPass::kLanes;
+                fSum0 += leadingEdge;
+                fSum1 += fSum0;
+                fSum2 += fSum1;
+
+                U32 value = mul_hi(fSum2, fWeight);
+
+                fSum2 -= load(fBuffer2 + fCursor2 * L);
+                store(fBuffer2 + fCursor2 * L, fSum1);
+                fCursor2 = fCursor2 + 1 < fPass2Size ? fCursor2 + 1 : 0;
+
+                fSum1 -= load(fBuffer1 + fCursor01 * L);
+                store(fBuffer1 + fCursor01 * L, fSum0);
+                fSum0 -= load(fBuffer0 + fCursor01 * L);
+                store(fBuffer0 + fCursor01 * L, leadingEdge);
+                fCursor01 = fCursor01 + 1 < fPass01Size ? fCursor01 + 1 : 0;
+
+                return value;
+            }
+
+        private:
+            U32 fSum0 = {},
+                fSum1 = {},
+                fSum2;
+            const uint32_t fWeight;
+            uint32_t* const fBuffer0;
+            uint32_t* const fBuffer1;
+            uint32_t* const fBuffer2;
+            const int fPass01Size,
+                      fPass2Size;
+            int fCursor01 = 0,
+                fCursor2  = 0;
+        };
+
+        // Blurs rows scanlines of src, srcRB bytes apart, along their length, and writes them
+        // transposed: dst pixel d of src scanline y goes to column y of dst row d.
+        //
+        // In general, a window sum has the form:
+        //    sum_n+1 = sum_n + leading_edge - trailing_edge.
+        // The three boxes are stacked, so the leading edge of box 1 is the sum of box 0, and the
+        // leading edge of box 2 is the sum of box 1:
+        //    sum0_n+1 = sum0_n + leading edge
+        //    sum1_n+1 = sum1_n + sum0_n+1
+        //    sum2_n+1 = sum2_n + sum1_n+1
+        // and sum2_n+1 / (the sum of the weights) is the dst value. Each sum is then reduced by
+        // its trailing edge, kept in a circular buffer, ready for the next pixel. No rounding
+        // happens between the boxes.
+        //
+        // scratch holds kLanes uint32_ts for each of the fPass{0,1,2}Size trailing edges.
+        template <typename R>
+        static void blur_rows(const SkBlurPass& pass,
+                              const typename R::Type* src, size_t srcRB, int rows,
+                              typename R::Type* dst, size_t dstRB, uint32_t* scratch) {
+            using T = typename R::Type;
+            constexpr int K = R::kRows;
+
+            auto dstAt = [&](int d, int y) { return (T*)((char*)dst + d * dstRB) + y; };
+
+            const int srcStart = pass.fSrcLeft - pass.fBorder,
+                      srcEnd   = srcStart + pass.fSrcWidth,
+                      dstEnd   = pass.fDstWidth;
+
+            for (int y = 0; y < rows; y += K) {
+                // The last group may be short; its missing scanlines repeat the last one, and
+                // their results are dropped.
+                const int n = std::min(K, rows - y);
+                const T* srcRows[K];
+                for (int i = 0; i < K; ++i) {
+                    srcRows[i] = (const T*)((const char*)src + (y + std::min(i, n - 1)) * srcRB);
+                }
+
+                if (pass.fWindow == 1) {
+                    for (int d = 0; d < dstEnd; ++d) {
+                        int x = d - pass.fSrcLeft;
+                        R::Store(dstAt(d, y),
+                                 0 <= x && x < pass.fSrcWidth ? R::Load(srcRows, x) : U32{}, n);
+                    }
+                    continue;
+                }
+
+                memset(scratch, 0, pass.scratchSize() * sizeof(uint32_t));
+                Sums sums{pass, scratch};
+                auto processValue = [&](const U32& leadingEdge) { return sums.next(leadingEdge); };
+
+                int srcIdx = srcStart,
+                    dstIdx = 0,
+                    x      = 0;
+
+                // These dst pixels are too far from src to be affected by it.
+                for (; dstIdx < std::min(srcIdx, dstEnd); ++dstIdx) {
+                    R::Store(dstAt(dstIdx, y), U32{}, n);
+                }
+
+                // src starts before dst; run the sums up to the first dst pixel.
+                for (; srcIdx < dstIdx; ++srcIdx, ++x) {
+                    (void)processValue(srcIdx < srcEnd ? R::Load(srcRows, x) : U32{});
+                }
+
+                // dstIdx and srcIdx are in sync now.
+                for (const int loopEnd = std::min(dstEnd, srcEnd); dstIdx < loopEnd; ++dstIdx) {
+                    R::Store(dstAt(dstIdx, y), processValue(R::Load(srcRows, x++)), n);
+                }
+
+                // The leading edge is past the end of src.
+                for (; dstIdx < dstEnd; ++dstIdx) {
+                    R::Store(dstAt(dstIdx, y), processValue(U32{}), n);
+                }
+            }
+        }
+
+    }  // namespace blur
+
+    /*not static*/ inline void blur_rows_8888(const SkBlurPass& pass,
+                                              const uint32_t* src, size_t srcRB, int rows,
+                                              uint32_t* dst, size_t dstRB, uint32_t* scratch) {
+        blur::blur_rows<blur::Rows_8888>(pass, src, srcRB, rows, dst, dstRB, scratch);
+    }
+
+    /*not static*/ inline void blur_rows_a8(const SkBlurPass& pass,
+                                            const uint8_t* src, size_t srcRB, int rows,
+                                            uint8_t* dst, size_t dstRB, uint32_t* scratch) {
+        blur::blur_rows<blur::Rows_A8>(pass, src, srcRB, rows, dst, dstRB, scratch);
+    }
+
+}  // namespace SK_OPTS_NS
+
+#endif//SkBlur_opts_DEFINED
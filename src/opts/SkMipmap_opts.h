@@ -0,0 +1,223 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMipmap_opts_DEFINED
+#define SkMipmap_opts_DEFINED
+
+#include "include/private/SkVx.h"
+
+#include <utility>
+
+// Vectorized versions of the 2x2 box and 3x3 triangle filters SkMipmap uses to halve even and
+// odd sized levels, for the most common color types. Each filters a row of N dst pixels at a
+// time, with each channel of those pixels in its own lane, and uses the same arithmetic as the
+// portable filters in SkMipmap.cpp. The integer formats match them exactly; F16 may round
+// differently where the hardware converts halfs.
+
+namespace SK_OPTS_NS {
+
+    namespace mipmap {
+
+        // Splits the 2N pixels starting at p into p[0], p[2], ..., p[2N-2] and p[1], ..., p[2N-1].
+        template <int N, typename T, int... Ix>
+        static inline void load_pairs(const T* p, skvx::Vec<N,T>* even, skvx::Vec<N,T>* odd,
+                                      std::integer_sequence<int, Ix...>) {
+            auto v = skvx::Vec<2*N,T>::Load(p);
+            *even = skvx::shuffle<(2*Ix    )...>(v);
+            *odd  = skvx::shuffle<(2*Ix + 1)...>(v);
+        }
+        template <int N, typename T>
+        static inline void load_pairs(const T* p, skvx::Vec<N,T>* even, skvx::Vec<N,T>* odd) {
+            load_pairs<N>(p, even, odd, std::make_integer_sequence<int, N>{});
+        }
+
+        // Just p[0], p[2], ..., p[2N-2], though this reads p[2N-1] too unless N is 1.
+        template <int N, typename T>
+        static inline skvx::Vec<N,T> load_even(const T* p) {
+            if constexpr (N == 1) {
+                return skvx::Vec<1,T>::Load(p);
+            } else {
+                skvx::Vec<N,T> even, odd;
+                load_pairs<N>(p, &even, &odd);
+                return even;
+            }
+        }
+
+        template <int kN>
+        struct Filter_8888 {
+            static constexpr int N = kN;
+            using Type = uint32_t;
+            static skvx::Vec<4*N,uint16_t> Expand(const skvx::Vec<N,uint32_t>& x) {
+                return skvx::cast<uint16_t>(skvx::bit_pun<skvx::Vec<4*N,uint8_t>>(x));
+            }
+            static skvx::Vec<N,uint32_t> Compact(const skvx::Vec<4*N,uint16_t>& x) {
+                return skvx::bit_pun<skvx::Vec<N,uint32_t>>(skvx::cast<uint8_t>(x));
+            }
+        };
+
+        template <int kN>
+        struct Filter_8 {
+            static constexpr int N = kN;
+            using Type = uint8_t;
+            static skvx::Vec<N,uint16_t> Expand(const skvx::Vec<N,uint8_t>& x) {
+                return skvx::cast<uint16_t>(x);
+            }
+            static skvx::Vec<N,uint8_t> Compact(const skvx::Vec<N,uint16_t>& x) {
+                return skvx::cast<uint8_t>(x);
+            }
+        };
+
+        template <int kN>
+        struct Filter_RGBA_F16 {
+            static constexpr int N = kN;
+            using Type = uint64_t;  // SkHalf x4
+            static skvx::Vec<4*N,float> Expand(const skvx::Vec<N,uint64_t>& x) {
+                return skvx::from_half(skvx::bit_pun<skvx::Vec<4*N,uint16_t>>(x));
+            }
+            static skvx::Vec<N,uint64_t> Compact(const skvx::Vec<4*N,float>& x) {
+                return skvx::bit_pun<skvx::Vec<N,uint64_t>>(skvx::to_half(x));
+            }
+        };
+
+        // Like ColorTypeFilter_1010102, each channel gets 20 bits of a 64-bit lane.
+        template <int kN>
+        struct Filter_1010102 {
+            static constexpr int N = kN;
+            using Type = uint32_t;
+            static skvx::Vec<N,uint64_t> Expand(const skvx::Vec<N,uint32_t>& x) {
+                auto w = skvx::cast<uint64_t>(x);
+                return (((w      ) & 0x3ff)      ) |
+                       (((w >> 10) & 0x3ff) << 20) |
+                       (((w >> 20) & 0x3ff) << 40) |
+                       (((w >> 30) & 0x3  ) << 60);
+            }
+            static skvx::Vec<N,uint32_t> Compact(const skvx::Vec<N,uint64_t>& x) {
+                return skvx::cast<uint32_t>((((x      ) & 0x3ff)      ) |
+                                            (((x >> 20) & 0x3ff) << 10) |
+                                            (((x >> 40) & 0x3ff) << 20) |
+                                            (((x >> 60) & 0x3  ) << 30));
+            }
+        };
+
+        template <int N, typename T>
+        static inline skvx::Vec<N,T> shift_right(const skvx::Vec<N,T>& x, int bits) {
+            return x >> bits;
+        }
+        template <int N>
+        static inline skvx::Vec<N,float> shift_right(const skvx::Vec<N,float>& x, int bits) {
+            return x * (1.0f / (1 << bits));
+        }
+
+        template <typename F>
+        static inline void filter_2_2(typename F::Type* d, const typename F::Type* p0,
+                                      const typename F::Type* p1) {
+            constexpr int N = F::N;
+            skvx::Vec<N,typename F::Type> x0, x1, y0, y1;
+            load_pairs<N>(p0, &x0, &x1);
+            load_pairs<N>(p1, &y0, &y1);
+            auto c00 = F::Expand(x0),
+                 c01 = F::Expand(x1),
+                 c10 = F::Expand(y0),
+                 c11 = F::Expand(y1);
+            F::Compact(shift_right(c00 + c10 + c01 + c11, 2)).store(d);
+        }
+
+        template <typename F>
+        static inline void filter_3_3(typename F::Type* d, const typename F::Type* p0,
+                                      const typename F::Type* p1, const typename F::Type* p2) {
+            constexpr int N = F::N;
+            skvx::Vec<N,typename F::Type> a0, a1, a2, b0, b1, b2;
+            load_pairs<N>(p0, &a0, &b0);
+            load_pairs<N>(p1, &a1, &b1);
+            load_pairs<N>(p2, &a2, &b2);
+            auto add_121 = [](auto x, auto y, auto z) { return x + y + y + z; };
+            auto a = add_121(F::Expand(a0), F::Expand(a1), F::Expand(a2)),
+                 b = add_121(F::Expand(b0), F::Expand(b1), F::Expand(b2)),
+                 c = add_121(F::Expand(load_even<N>(p0 + 2)),
+                             F::Expand(load_even<N>(p1 + 2)),
+                             F::Expand(load_even<N>(p2 + 2)));
+            F::Compact(shift_right(a + (b + b) + c, 4)).store(d);
+        }
+
+        // The N=1 versions of the filters finish off each row, reading no further than the
+        // portable filters in SkMipmap.cpp do.
+        template <template <int> class Filter, int N>
+        static inline void downsample_2_2(void* dst, const void* src, size_t srcRB, int count) {
+            using T = typename Filter<N>::Type;
+            auto p0 = static_cast<const T*>(src);
+            auto p1 = (const T*)((const char*)p0 + srcRB);
+            auto d  = static_cast<T*>(dst);
+
+            int i = 0;
+            for (; i + N <= count; i += N) {
+                filter_2_2<Filter<N>>(d + i, p0 + 2*i, p1 + 2*i);
+            }
+            for (; i < count; ++i) {
+                filter_2_2<Filter<1>>(d + i, p0 + 2*i, p1 + 2*i);
+            }
+        }
+
+        template <template <int> class Filter, int N>
+        static inline void downsample_3_3(void* dst, const void* src, size_t srcRB, int count) {
+            using T = typename Filter<N>::Type;
+            auto p0 = static_cast<const T*>(src);
+            auto p1 = (const T*)((const char*)p0 + srcRB);
+            auto p2 = (const T*)((const char*)p1 + srcRB);
+            auto d  = static_cast<T*>(dst);
+
+            // The third column of N pixels reads p[2i+2N+1], one past what it uses, so the wide
+            // loop stops while there is at least one more dst pixel to the right.
+            int i = 0;
+            for (; i + N < count; i += N) {
+                filter_3_3<Filter<N>>(d + i, p0 + 2*i, p1 + 2*i, p2 + 2*i);
+            }
+            for (; i < count; ++i) {
+                filter_3_3<Filter<1>>(d + i, p0 + 2*i, p1 + 2*i, p2 + 2*i);
+            }
+        }
+
+    }  // namespace mipmap
+
+    /*not static*/ inline void downsample_2_2_8888(void* dst, const void* src, size_t srcRB,
+                                                   int count) {
+        mipmap::downsample_2_2<mipmap::Filter_8888, 8>(dst, src, srcRB, count);
+    }
+    /*not static*/ inline void downsample_3_3_8888(void* dst, const void* src, size_t srcRB,
+                                                   int count) {
+        mipmap::downsample_3_3<mipmap::Filter_8888, 8>(dst, src, srcRB, count);
+    }
+
+    /*not static*/ inline void downsample_2_2_a8(void* dst, const void* src, size_t srcRB,
+                                                 int count) {
+        mipmap::downsample_2_2<mipmap::Filter_8, 16>(dst, src, srcRB, count);
+    }
+    /*not static*/ inline void downsample_3_3_a8(void* dst, const void* src, size_t srcRB,
+                                                 int count) {
+        mipmap::downsample_3_3<mipmap::Filter_8, 16>(dst, src, srcRB, count);
+    }
+
+    /*not static*/ inline void downsample_2_2_f16(void* dst, const void* src, size_t srcRB,
+                                                  int count) {
+        mipmap::downsample_2_2<mipmap::Filter_RGBA_F16, 2>(dst, src, srcRB, count);
+    }
+    /*not static*/ inline void downsample_3_3_f16(void* dst, const void* src, size_t srcRB,
+                                                  int count) {
+        mipmap::downsample_3_3<mipmap::Filter_RGBA_F16, 2>(dst, src, srcRB, count);
+    }
+
+    /*not static*/ inline void downsample_2_2_1010102(void* dst, const void* src, size_t srcRB,
+                                                      int count) {
+        mipmap::downsample_2_2<mipmap::Filter_1010102, 4>(dst, src, srcRB, count);
+    }
+    /*not static*/ inline void downsample_3_3_1010102(void* dst, const void* src, size_t srcRB,
+                                                      int count) {
+        mipmap::downsample_3_3<mipmap::Filter_1010102, 4>(dst, src, srcRB, count);
+    }
+
+}  // namespace SK_OPTS_NS
+
+#endif//SkMipmap_opts_DEFINED
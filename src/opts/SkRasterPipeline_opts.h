@@ -3847,6 +3847,88 @@ STAGE_PP(emboss, const SkRasterPipeline_EmbossCtx* ctx) {
     b = min(div255(b*mul) + add, a);
 }
 
+// ~~~~~~ Image sampling stages ~~~~~~ //
+
+// These all match their highp counterparts, tiling in float and clamping in ix_and_ptr().
+SI F exclusive_repeat(F v, const SkRasterPipeline_TileCtx* ctx) {
+    return v - floor_(v*ctx->invScale)*ctx->scale;
+}
+SI F exclusive_mirror(F v, const SkRasterPipeline_TileCtx* ctx) {
+    auto limit = ctx->scale;
+    auto invLimit = ctx->invScale;
+    return abs_( (v-limit) - (limit+limit)*floor_((v-limit)*(invLimit*0.5f)) - limit );
+}
+STAGE_GG(repeat_x, const SkRasterPipeline_TileCtx* ctx) { x = exclusive_repeat(x, ctx); }
+STAGE_GG(repeat_y, const SkRasterPipeline_TileCtx* ctx) { y = exclusive_repeat(y, ctx); }
+STAGE_GG(mirror_x, const SkRasterPipeline_TileCtx* ctx) { x = exclusive_mirror(x, ctx); }
+STAGE_GG(mirror_y, const SkRasterPipeline_TileCtx* ctx) { y = exclusive_mirror(y, ctx); }
+
+SI F tile(F v, SkTileMode mode, float limit, float invLimit) {
+    switch (mode) {
+        case SkTileMode::kDecal:
+        case SkTileMode::kClamp:  return v;
+        case SkTileMode::kRepeat: return v - floor_(v*invLimit)*limit;
+        case SkTileMode::kMirror:
+            return abs_( (v-limit) - (limit+limit)*floor_((v-limit)*(invLimit*0.5f)) - limit );
+    }
+    SkUNREACHABLE;
+}
+
+// Bilinear weights are quantized to [0,256], so each lerp fits in 16 bits: 255*256 + 128 < 65536.
+// The quantized result stays within 1 (of 255) of exact bilinear filtering.
+SI U16 bilerp_weight(F f) { return cast<U16>(f*256.0f + 0.5f); }
+SI U16 lerp_256(U16 from, U16 to, U16 t) { return (from*(256-t) + to*t + 128) >> 8; }
+
+// Sample the 2x2 8888 pixels around (cx,cy), lerping first along x and then along y.
+template <typename TileFn>
+SI void bilerp_8888(const SkRasterPipeline_GatherCtx* ctx, F cx, F cy, TileFn&& tileXY,
+                    U16* r, U16* g, U16* b, U16* a) {
+    U16 wx = bilerp_weight(fract(cx + 0.5f)),
+        wy = bilerp_weight(fract(cy + 0.5f));
+
+    auto sample = [&](float dx, float dy, U16* R, U16* G, U16* B, U16* A) {
+        F x = cx + dx,
+          y = cy + dy;
+        tileXY(&x, &y);
+
+        const uint32_t* ptr;
+        U32 ix = ix_and_ptr(&ptr, ctx, x,y);
+        from_8888(gather<U32>(ptr, ix), R,G,B,A);
+    };
+    auto sample_row = [&](float dy, U16* R, U16* G, U16* B, U16* A) {
+        U16 lr,lg,lb,la, rr,rg,rb,ra;
+        sample(-0.5f, dy, &lr,&lg,&lb,&la);
+        sample(+0.5f, dy, &rr,&rg,&rb,&ra);
+        *R = lerp_256(lr, rr, wx);
+        *G = lerp_256(lg, rg, wx);
+        *B = lerp_256(lb, rb, wx);
+        *A = lerp_256(la, ra, wx);
+    };
+
+    U16 tr,tg,tb,ta;
+    sample_row(-0.5f, &tr,&tg,&tb,&ta);
+    sample_row(+0.5f,   r,  g,  b,  a);
+    *r = lerp_256(tr, *r, wy);
+    *g = lerp_256(tg, *g, wy);
+    *b = lerp_256(tb, *b, wy);
+    *a = lerp_256(ta, *a, wy);
+}
+
+STAGE_GP(bilerp_clamp_8888, const SkRasterPipeline_GatherCtx* ctx) {
+    bilerp_8888(ctx, x,y, [](F*, F*) {}, &r,&g,&b,&a);
+}
+
+// SkRasterPipeline::append() only lets this run for 8888 images, falling back to highp otherwise.
+STAGE_GP(bilinear, const SkRasterPipeline_SamplerCtx2* ctx) {
+    bilerp_8888(ctx, x,y, [ctx](F* sx, F* sy) {
+        *sx = tile(*sx, ctx->tileX, ctx->width , ctx->invWidth );
+        *sy = tile(*sy, ctx->tileY, ctx->height, ctx->invHeight);
+    }, &r,&g,&b,&a);
+    if (ctx->ct == kBGRA_8888_SkColorType) {
+        std::swap(r,b);
+    }
+}
+
 
 // ~~~~~~ Gradient stages ~~~~~~ //
 
@@ -4094,13 +4176,7 @@ STAGE_PP(swizzle, void* ctx) {
     NOT_IMPLEMENTED(rgb_to_hsl)
     NOT_IMPLEMENTED(hsl_to_rgb)
     NOT_IMPLEMENTED(gauss_a_to_rgba)
-    NOT_IMPLEMENTED(mirror_x)
-    NOT_IMPLEMENTED(repeat_x)
-    NOT_IMPLEMENTED(mirror_y)
-    NOT_IMPLEMENTED(repeat_y)
     NOT_IMPLEMENTED(negate_x)
-    NOT_IMPLEMENTED(bilinear)
-    NOT_IMPLEMENTED(bilerp_clamp_8888)
     NOT_IMPLEMENTED(bicubic)
     NOT_IMPLEMENTED(bicubic_clamp_8888)
     NOT_IMPLEMENTED(bilinear_nx)
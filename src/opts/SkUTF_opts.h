@@ -0,0 +1,105 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkUTF_opts_DEFINED
+#define SkUTF_opts_DEFINED
+
+#include "include/private/SkTo.h"
+#include "include/private/SkVx.h"
+#include "src/utils/SkUTF.h"
+
+// Text is mostly ASCII (for UTF-8) or free of surrogates (for UTF-16), so these check a vector
+// of code units at a time and widen them straight to SkUnichars when they are. Any other vector
+// is handled one code point at a time by SkUTF, with the same results as SkUTF.
+
+namespace SK_OPTS_NS {
+
+#if defined(SK_CPU_SSE_LEVEL) && SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    static constexpr int kUTFBytesPerVec = 32;
+#else
+    static constexpr int kUTFBytesPerVec = 16;
+#endif
+
+    /*not static*/ inline int count_utf8(const char* utf8, size_t byteLength) {
+        if (!utf8) {
+            return -1;
+        }
+        constexpr int N = kUTFBytesPerVec;
+        const char* ptr = utf8;
+        const char* end = utf8 + byteLength;
+        int count = 0;
+        while (end - ptr >= N) {
+            if (!any(skvx::Vec<N,uint8_t>::Load(ptr) >= 0x80)) {
+                ptr   += N;
+                count += N;
+                continue;
+            }
+            // Step over the vector, plus the rest of the code point it ends in.
+            for (const char* stop = ptr + N; ptr < stop; ++count) {
+                if (SkUTF::NextUTF8(&ptr, end) < 0) {
+                    return -1;
+                }
+            }
+        }
+        for (; ptr < end; ++count) {
+            if (SkUTF::NextUTF8(&ptr, end) < 0) {
+                return -1;
+            }
+        }
+        return count;
+    }
+
+    /*not static*/ inline int utf8_to_utf32(const char* utf8, size_t byteLength, SkUnichar dst[]) {
+        constexpr int N = kUTFBytesPerVec;
+        const char* ptr = utf8;
+        const char* end = utf8 + byteLength;
+        SkUnichar* out = dst;
+        while (end - ptr >= N) {
+            auto bytes = skvx::Vec<N,uint8_t>::Load(ptr);
+            if (!any(bytes >= 0x80)) {
+                skvx::cast<int32_t>(bytes).store(out);
+                ptr += N;
+                out += N;
+                continue;
+            }
+            for (const char* stop = ptr + N; ptr < stop;) {
+                *out++ = SkUTF::NextUTF8(&ptr, end);
+            }
+        }
+        while (ptr < end) {
+            *out++ = SkUTF::NextUTF8(&ptr, end);
+        }
+        return SkToInt(out - dst);
+    }
+
+    /*not static*/ inline int utf16_to_utf32(const uint16_t* utf16, size_t byteLength,
+                                             SkUnichar dst[]) {
+        constexpr int N = kUTFBytesPerVec / 2;
+        const uint16_t* ptr = utf16;
+        const uint16_t* end = utf16 + (byteLength >> 1);
+        SkUnichar* out = dst;
+        while (end - ptr >= N) {
+            auto units = skvx::Vec<N,uint16_t>::Load(ptr);
+            if (!any((units & 0xF800) == 0xD800)) {
+                skvx::cast<int32_t>(units).store(out);
+                ptr += N;
+                out += N;
+                continue;
+            }
+            for (const uint16_t* stop = ptr + N; ptr < stop;) {
+                *out++ = SkUTF::NextUTF16(&ptr, end);
+            }
+        }
+        while (ptr < end) {
+            *out++ = SkUTF::NextUTF16(&ptr, end);
+        }
+        return SkToInt(out - dst);
+    }
+
+}  // namespace SK_OPTS_NS
+
+#endif//SkUTF_opts_DEFINED
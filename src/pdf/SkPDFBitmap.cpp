@@ -138,9 +138,11 @@ static void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndir
 static void do_deflated_image(const SkPixmap& pm,
                               SkPDFDocument* doc,
                               bool isOpaque,
-                              SkPDFIndirectReference ref) {
-    SkPDFIndirectReference sMask;
-    if (!isOpaque) {
+                              SkPDFIndirectReference ref,
+                              SkPDFIndirectReference sMask) {
+    if (isOpaque) {
+        sMask = SkPDFIndirectReference();
+    } else if (!sMask) {
         sMask = doc->reserveRef();
     }
     SkDynamicMemoryWStream buffer;
@@ -247,17 +249,20 @@ static SkBitmap to_pixels(const SkImage* image) {
     return bm;
 }
 
-void serialize_image(const SkImage* img,
-                     int encodingQuality,
-                     SkPDFDocument* doc,
-                     SkPDFIndirectReference ref) {
+// Returns true if the image used sMask for its alpha.  If sMask is not set, one is reserved as
+// needed.
+static bool serialize_image(const SkImage* img,
+                            int encodingQuality,
+                            SkPDFDocument* doc,
+                            SkPDFIndirectReference ref,
+                            SkPDFIndirectReference sMask) {
     SkASSERT(img);
     SkASSERT(doc);
     SkASSERT(encodingQuality >= 0);
     SkISize dimensions = img->dimensions();
     sk_sp<SkData> data = img->refEncodedData();
     if (data && do_jpeg(std::move(data), doc, dimensions, ref)) {
-        return;
+        return false;
     }
     SkBitmap bm = to_pixels(img);
     const SkPixmap& pm = bm.pixmap();
@@ -265,10 +270,11 @@ void serialize_image(const SkImage* img,
     if (encodingQuality <= 100 && isOpaque) {
         sk_sp<SkData> data = img->encodeToData(SkEncodedImageFormat::kJPEG, encodingQuality);
         if (data && do_jpeg(std::move(data), doc, dimensions, ref)) {
-            return;
+            return false;
         }
     }
-    do_deflated_image(pm, doc, isOpaque, ref);
+    do_deflated_image(pm, doc, isOpaque, ref, sMask);
+    return !isOpaque;
 }
 
 SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
@@ -277,16 +283,26 @@ SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
     SkASSERT(img);
     SkASSERT(doc);
     SkPDFIndirectReference ref = doc->reserveRef();
-    if (SkExecutor* executor = doc->executor()) {
+    if (doc->executor()) {
+        // Reserve the soft mask up front so object numbers don't depend on job scheduling.
+        SkPDFIndirectReference sMask;
+        std::vector<SkPDFIndirectReference> refs = {ref};
+        if (!img->isOpaque()) {
+            sMask = doc->reserveRef();
+            refs.push_back(sMask);
+        }
+        size_t approxBytes = img->imageInfo().computeMinByteSize();
         SkRef(img);
-        doc->incrementJobCount();
-        executor->add([img, encodingQuality, doc, ref]() {
-            serialize_image(img, encodingQuality, doc, ref);
+        doc->executeJob(std::move(refs), approxBytes, [img, encodingQuality, doc, ref, sMask]() {
+            if (!serialize_image(img, encodingQuality, doc, ref, sMask) &&
+                sMask != SkPDFIndirectReference()) {
+                // The image turned out to be opaque; keep the cross-reference table complete.
+                doc->emit(SkPDFDict(), sMask);
+            }
             SkSafeUnref(img);
-            doc->signalJobComplete();
         });
         return ref;
     }
-    serialize_image(img, encodingQuality, doc, ref);
+    serialize_image(img, encodingQuality, doc, ref, SkPDFIndirectReference());
     return ref;
 }
@@ -10,7 +10,9 @@
 
 #include "include/core/SkStream.h"
 #include "include/docs/SkPDFDocument.h"
+#include "include/core/SkExecutor.h"
 #include "include/private/SkTo.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/pdf/SkPDFDevice.h"
 #include "src/pdf/SkPDFFont.h"
 #include "src/pdf/SkPDFGradientShader.h"
@@ -102,12 +104,16 @@ static void serializeHeader(SkPDFOffsetMap* offsetMap, SkWStream* wStream) {
 }
 #undef SKPDF_MAGIC
 
+static void write_object_header(SkPDFIndirectReference ref, SkWStream* s) {
+    s->writeDecAsText(ref.fValue);
+    s->writeText(" 0 obj\n");  // Generation number is always 0.
+}
+
 static void begin_indirect_object(SkPDFOffsetMap* offsetMap,
                                   SkPDFIndirectReference ref,
                                   SkWStream* s) {
     offsetMap->markStartOfObject(ref.fValue, s);
-    s->writeDecAsText(ref.fValue);
-    s->writeText(" 0 obj\n");  // Generation number is always 0.
+    write_object_header(ref, s);
 }
 
 static void end_indirect_object(SkWStream* s) { s->writeText("\nendobj\n"); }
@@ -135,68 +141,102 @@ static void serialize_footer(const SkPDFOffsetMap& offsetMap,
     wStream->writeText("\n%%EOF");
 }
 
+// PDF wants a tree describing all the pages in the document.  We arbitrary
+// choose 8 (kPageTreeNodeSize) as the number of allowed children.  The internal
+// nodes have type "Pages" with an array of children, a parent pointer, and
+// the number of leaves below the node as "Count."  The leaves have type "Page"
+// and need a parent pointer.
+static constexpr size_t kPageTreeNodeSize = 8;
+
+namespace {
+struct PageTreeNode {
+    std::unique_ptr<SkPDFDict> fNode;
+    SkPDFIndirectReference fReservedRef;
+    int fPageObjectDescendantCount;
+
+    static std::vector<PageTreeNode> Layer(std::vector<PageTreeNode> vec, SkPDFDocument* doc) {
+        std::vector<PageTreeNode> result;
+        const size_t n = vec.size();
+        SkASSERT(n >= 1);
+        const size_t result_len = (n - 1) / kPageTreeNodeSize + 1;
+        SkASSERT(result_len >= 1);
+        SkASSERT(n == 1 || result_len < n);
+        result.reserve(result_len);
+        size_t index = 0;
+        for (size_t i = 0; i < result_len; ++i) {
+            if (n != 1 && index + 1 == n) {  // No need to create a new node.
+                result.push_back(std::move(vec[index++]));
+                continue;
+            }
+            SkPDFIndirectReference parent = doc->reserveRef();
+            auto kids_list = SkPDFMakeArray();
+            int descendantCount = 0;
+            for (size_t j = 0; j < kPageTreeNodeSize && index < n; ++j) {
+                PageTreeNode& node = vec[index++];
+                node.fNode->insertRef("Parent", parent);
+                kids_list->appendRef(doc->emit(*node.fNode, node.fReservedRef));
+                descendantCount += node.fPageObjectDescendantCount;
+            }
+            auto next = SkPDFMakeDict("Pages");
+            next->insertInt("Count", descendantCount);
+            next->insertObject("Kids", std::move(kids_list));
+            result.push_back(PageTreeNode{std::move(next), parent, descendantCount});
+        }
+        return result;
+    }
+
+    // Builds the rest of the tree bottom up, skipping internal nodes that would
+    // have only one child.
+    static SkPDFIndirectReference EmitRoot(std::vector<PageTreeNode> layer, SkPDFDocument* doc) {
+        while (layer.size() > 1) {
+            layer = PageTreeNode::Layer(std::move(layer), doc);
+        }
+        SkASSERT(layer.size() == 1);
+        const PageTreeNode& root = layer[0];
+        return doc->emit(*root.fNode, root.fReservedRef);
+    }
+};
+}  // namespace
+
 static SkPDFIndirectReference generate_page_tree(
         SkPDFDocument* doc,
         std::vector<std::unique_ptr<SkPDFDict>> pages,
         const std::vector<SkPDFIndirectReference>& pageRefs) {
-    // PDF wants a tree describing all the pages in the document.  We arbitrary
-    // choose 8 (kNodeSize) as the number of allowed children.  The internal
-    // nodes have type "Pages" with an array of children, a parent pointer, and
-    // the number of leaves below the node as "Count."  The leaves are passed
-    // into the method, have type "Page" and need a parent pointer. This method
-    // builds the tree bottom up, skipping internal nodes that would have only
-    // one child.
     SkASSERT(pages.size() > 0);
-    struct PageTreeNode {
-        std::unique_ptr<SkPDFDict> fNode;
-        SkPDFIndirectReference fReservedRef;
-        int fPageObjectDescendantCount;
-
-        static std::vector<PageTreeNode> Layer(std::vector<PageTreeNode> vec, SkPDFDocument* doc) {
-            std::vector<PageTreeNode> result;
-            static constexpr size_t kMaxNodeSize = 8;
-            const size_t n = vec.size();
-            SkASSERT(n >= 1);
-            const size_t result_len = (n - 1) / kMaxNodeSize + 1;
-            SkASSERT(result_len >= 1);
-            SkASSERT(n == 1 || result_len < n);
-            result.reserve(result_len);
-            size_t index = 0;
-            for (size_t i = 0; i < result_len; ++i) {
-                if (n != 1 && index + 1 == n) {  // No need to create a new node.
-                    result.push_back(std::move(vec[index++]));
-                    continue;
-                }
-                SkPDFIndirectReference parent = doc->reserveRef();
-                auto kids_list = SkPDFMakeArray();
-                int descendantCount = 0;
-                for (size_t j = 0; j < kMaxNodeSize && index < n; ++j) {
-                    PageTreeNode& node = vec[index++];
-                    node.fNode->insertRef("Parent", parent);
-                    kids_list->appendRef(doc->emit(*node.fNode, node.fReservedRef));
-                    descendantCount += node.fPageObjectDescendantCount;
-                }
-                auto next = SkPDFMakeDict("Pages");
-                next->insertInt("Count", descendantCount);
-                next->insertObject("Kids", std::move(kids_list));
-                result.push_back(PageTreeNode{std::move(next), parent, descendantCount});
-            }
-            return result;
-        }
-    };
     std::vector<PageTreeNode> currentLayer;
     currentLayer.reserve(pages.size());
     SkASSERT(pages.size() == pageRefs.size());
     for (size_t i = 0; i < pages.size(); ++i) {
         currentLayer.push_back(PageTreeNode{std::move(pages[i]), pageRefs[i], 1});
     }
+    // The root is always a "Pages" node, even for a single page.
     currentLayer = PageTreeNode::Layer(std::move(currentLayer), doc);
-    while (currentLayer.size() > 1) {
-        currentLayer = PageTreeNode::Layer(std::move(currentLayer), doc);
+    return PageTreeNode::EmitRoot(std::move(currentLayer), doc);
+}
+
+// In streaming mode the pages have already been written, each with its parent
+// set to the group of kPageTreeNodeSize pages it belongs to.
+static SkPDFIndirectReference generate_streamed_page_tree(
+        SkPDFDocument* doc,
+        const std::vector<SkPDFIndirectReference>& groupRefs,
+        const std::vector<SkPDFIndirectReference>& pageRefs) {
+    SkASSERT(groupRefs.size() == (pageRefs.size() - 1) / kPageTreeNodeSize + 1);
+    std::vector<PageTreeNode> currentLayer;
+    currentLayer.reserve(groupRefs.size());
+    for (size_t i = 0; i < groupRefs.size(); ++i) {
+        size_t first = i * kPageTreeNodeSize;
+        size_t last = std::min(first + kPageTreeNodeSize, pageRefs.size());
+        auto kids_list = SkPDFMakeArray();
+        kids_list->reserve(SkToInt(last - first));
+        for (size_t j = first; j < last; ++j) {
+            kids_list->appendRef(pageRefs[j]);
+        }
+        auto group = SkPDFMakeDict("Pages");
+        group->insertInt("Count", SkToInt(last - first));
+        group->insertObject("Kids", std::move(kids_list));
+        currentLayer.push_back(PageTreeNode{std::move(group), groupRefs[i], SkToInt(last - first)});
     }
-    SkASSERT(currentLayer.size() == 1);
-    const PageTreeNode& root = currentLayer[0];
-    return doc->emit(*root.fNode, root.fReservedRef);
+    return PageTreeNode::EmitRoot(std::move(currentLayer), doc);
 }
 
 template<typename T, typename... Args>
@@ -235,20 +275,91 @@ SkPDFIndirectReference SkPDFDocument::emit(const SkPDFObject& object, SkPDFIndir
 }
 
 SkWStream* SkPDFDocument::beginObject(SkPDFIndirectReference ref) SK_REQUIRES(fMutex) {
-    begin_indirect_object(&fOffsetMap, ref, this->getStream());
-    return this->getStream();
+    SkASSERT(!fCurrentPending);
+    if (PendingObjects** pending = fPendingForRef.find(ref.fValue)) {
+        fCurrentPending = *pending;
+    } else if (!fPending.empty()) {
+        // Jobs queued earlier haven't been written yet, so this object has to wait its turn.
+        fPending.push_back(std::make_unique<PendingObjects>());
+        fCurrentPending = fPending.back().get();
+        fCurrentPending->fDone = true;
+    } else {
+        begin_indirect_object(&fOffsetMap, ref, this->getStream());
+        return this->getStream();
+    }
+    fCurrentRef = ref;
+    SkASSERT(fPendingStream.bytesWritten() == 0);
+    write_object_header(ref, &fPendingStream);
+    return &fPendingStream;
 };
 
 void SkPDFDocument::endObject() SK_REQUIRES(fMutex) {
-    end_indirect_object(this->getStream());
+    if (!fCurrentPending) {
+        end_indirect_object(this->getStream());
+        return;
+    }
+    end_indirect_object(&fPendingStream);
+    sk_sp<SkData> object = fPendingStream.detachAsData();
+    fCurrentPending->fBytes += object->size();
+    fPendingBytes += object->size();
+    fCurrentPending->fObjects.emplace_back(fCurrentRef, std::move(object));
+    fCurrentPending = nullptr;
+    this->writePendingObjects();
 };
 
+void SkPDFDocument::writePendingObjects() SK_REQUIRES(fMutex) {
+    while (!fPending.empty() && fPending.front()->fDone) {
+        std::unique_ptr<PendingObjects> pending = std::move(fPending.front());
+        fPending.pop_front();
+        for (const auto& [ref, object] : pending->fObjects) {
+            fOffsetMap.markStartOfObject(ref.fValue, this->getStream());
+            this->getStream()->write(object->data(), object->size());
+        }
+        for (SkPDFIndirectReference ref : pending->fRefs) {
+            fPendingForRef.remove(ref.fValue);
+        }
+        fPendingBytes -= pending->fBytes;
+    }
+}
+
+void SkPDFDocument::executeJob(std::vector<SkPDFIndirectReference> refs,
+                               size_t approxBytes,
+                               std::function<void()> job) {
+    SkASSERT(fExecutor);
+    const size_t budget = fMetadata.fExecutorMemoryBudget;
+    while (budget > 0 && fPendingBytes > budget && this->waitForJob()) {}
+
+    auto pending = std::make_unique<PendingObjects>();
+    PendingObjects* pendingPtr = pending.get();
+    pending->fBytes = approxBytes;
+    {
+        SkAutoMutexExclusive lock(fMutex);
+        for (SkPDFIndirectReference ref : refs) {
+            fPendingForRef.set(ref.fValue, pendingPtr);
+        }
+        pending->fRefs = std::move(refs);
+        fPending.push_back(std::move(pending));
+    }
+    fPendingBytes += approxBytes;
+
+    fJobCount++;
+    fExecutor->add([this, pendingPtr, job = std::move(job)]() {
+        job();
+        {
+            SkAutoMutexExclusive lock(fMutex);
+            pendingPtr->fDone = true;
+            this->writePendingObjects();
+        }
+        fSemaphore.signal();
+    });
+}
+
 static SkSize operator*(SkISize u, SkScalar s) { return SkSize{u.width() * s, u.height() * s}; }
 static SkSize operator*(SkSize u, SkScalar s) { return SkSize{u.width() * s, u.height() * s}; }
 
 SkCanvas* SkPDFDocument::onBeginPage(SkScalar width, SkScalar height) {
     SkASSERT(fCanvas.imageInfo().dimensions().isZero());
-    if (fPages.empty()) {
+    if (fPageRefs.empty()) {
         // if this is the first page if the document.
         {
             SkAutoMutexExclusive autoMutexAcquire(fMutex);
@@ -375,7 +486,18 @@ void SkPDFDocument::onEndPage() {
     // The StructParents unique identifier for each page is just its
     // 0-based page index.
     page->insertInt("StructParents", SkToInt(this->currentPageIndex()));
-    fPages.emplace_back(std::move(page));
+    if (!this->isStreaming()) {
+        fPages.emplace_back(std::move(page));
+        return;
+    }
+    if (this->currentPageIndex() % kPageTreeNodeSize == 0) {
+        fPageTreeGroups.push_back(this->reserveRef());
+    }
+    page->insertRef("Parent", fPageTreeGroups.back());
+    this->emit(*page, fPageRefs.back());
+    if (this->approxRetainedBytes() > fMetadata.fStreamingMemoryBudget) {
+        this->flushRetainedState();
+    }
 }
 
 void SkPDFDocument::onAbort() {
@@ -547,9 +669,77 @@ static std::vector<const SkPDFFont*> get_fonts(const SkPDFDocument& canon) {
     return fonts;
 }
 
+void SkPDFDocument::emitFonts() {
+    std::vector<const SkPDFFont*> fonts = get_fonts(*this);
+    if (fExecutor) {
+        // Subsetting dominates the cost of emitting fonts, so do it for all fonts at once.
+        std::vector<const SkPDFFont*> subsettable;
+        for (const SkPDFFont* f : fonts) {
+            if (f->canSubset(this)) {
+                subsettable.push_back(f);
+            }
+        }
+        std::vector<sk_sp<SkData>> subsets(subsettable.size());
+        SkTaskGroup taskGroup(*fExecutor);
+        taskGroup.batch(SkToInt(subsettable.size()), [&](int i) {
+            subsets[i] = subsettable[i]->makeSubset(this);
+        });
+        taskGroup.wait();
+        for (size_t i = 0; i < subsettable.size(); ++i) {
+            fFontSubsets.set(subsettable[i]->indirectReference().fValue, std::move(subsets[i]));
+        }
+    }
+    for (const SkPDFFont* f : fonts) {
+        f->emitSubset(this);
+    }
+    fFontSubsets.reset();
+}
+
+size_t SkPDFDocument::approxRetainedBytes() const {
+    size_t bytes = fFontMap.approxBytesUsed()
+                 + fTypefaceMetrics.approxBytesUsed()
+                 + fToUnicodeMap.approxBytesUsed()
+                 + fType1GlyphNames.approxBytesUsed()
+                 + fPDFBitmapMap.approxBytesUsed()
+                 + fImageShaderMap.approxBytesUsed()
+                 + fGradientPatternMap.approxBytesUsed()
+                 + fStrokeGSMap.approxBytesUsed()
+                 + fFillGSMap.approxBytesUsed();
+    for (const auto& [unused, font] : fFontMap) {
+        bytes += (font.lastGlyphID() - font.firstGlyphID() + 2) / 8;
+    }
+    for (const auto& [unused, metrics] : fTypefaceMetrics) {
+        bytes += metrics ? sizeof(SkAdvancedTypefaceMetrics) : 0;
+    }
+    for (const auto& [unused, unicodes] : fToUnicodeMap) {
+        bytes += unicodes.capacity() * sizeof(SkUnichar);
+    }
+    for (const auto& [unused, names] : fType1GlyphNames) {
+        bytes += names.capacity() * sizeof(SkString);
+    }
+    return bytes;
+}
+
+void SkPDFDocument::flushRetainedState() {
+    // Every page written so far refers only to fonts in fFontMap, so their subsets are
+    // final.  Later pages start new fonts.
+    this->emitFonts();
+    fFontMap.reset();
+    fTypefaceMetrics.reset();
+    fToUnicodeMap.reset();
+    fType1GlyphNames.reset();
+    // Font descriptors and the shared graphic states have already been written and are
+    // small, so those keep being shared.
+    fPDFBitmapMap.reset();
+    fImageShaderMap.reset();
+    fGradientPatternMap.reset();
+    fStrokeGSMap.reset();
+    fFillGSMap.reset();
+}
+
 void SkPDFDocument::onClose(SkWStream* stream) {
     SkASSERT(fCanvas.imageInfo().dimensions().isZero());
-    if (fPages.empty()) {
+    if (fPageRefs.empty()) {
         this->waitForJobs();
         return;
     }
@@ -562,7 +752,9 @@ void SkPDFDocument::onClose(SkWStream* stream) {
         docCatalog->insertObject("OutputIntents", make_srgb_output_intents(this));
     }
 
-    docCatalog->insertRef("Pages", generate_page_tree(this, std::move(fPages), fPageRefs));
+    docCatalog->insertRef("Pages", this->isStreaming()
+                                   ? generate_streamed_page_tree(this, fPageTreeGroups, fPageRefs)
+                                   : generate_page_tree(this, std::move(fPages), fPageRefs));
 
     if (!fNamedDestinations.empty()) {
         docCatalog->insertRef("Dests", append_destinations(this, fNamedDestinations));
@@ -580,9 +772,7 @@ void SkPDFDocument::onClose(SkWStream* stream) {
 
     auto docCatalogRef = this->emit(*docCatalog);
 
-    for (const SkPDFFont* f : get_fonts(*this)) {
-        f->emitSubset(this);
-    }
+    this->emitFonts();
 
     this->waitForJobs();
     {
@@ -591,16 +781,19 @@ void SkPDFDocument::onClose(SkWStream* stream) {
     }
 }
 
-void SkPDFDocument::incrementJobCount() { fJobCount++; }
-
-void SkPDFDocument::signalJobComplete() { fSemaphore.signal(); }
+bool SkPDFDocument::waitForJob() {
+    if (fJobCount == 0) {
+        return false;
+    }
+    fSemaphore.wait();
+    --fJobCount;
+    return true;
+}
 
 void SkPDFDocument::waitForJobs() {
      // fJobCount can increase while we wait.
-     while (fJobCount > 0) {
-         fSemaphore.wait();
-         --fJobCount;
-     }
+     while (this->waitForJob()) {}
+     SkASSERT(fPending.empty());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
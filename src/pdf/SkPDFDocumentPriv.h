@@ -16,6 +16,8 @@
 #include "src/pdf/SkPDFTag.h"
 
 #include <atomic>
+#include <deque>
+#include <functional>
 #include <vector>
 #include <memory>
 
@@ -130,9 +132,15 @@ public:
     SkPDFIndirectReference reserveRef() { return SkPDFIndirectReference{fNextObjectNumber++}; }
 
     SkExecutor* executor() const { return fExecutor; }
-    void incrementJobCount();
-    void signalJobComplete();
-    size_t currentPageIndex() { return fPages.size(); }
+
+    /** Run job on the executor.  Objects the job emits for refs are buffered and written in
+        the order jobs were queued, so the output does not depend on the number of threads.
+        approxBytes is the job's share of Metadata::fExecutorMemoryBudget; this waits for
+        earlier jobs to be written while queued work is over budget. */
+    void executeJob(std::vector<SkPDFIndirectReference> refs,
+                    size_t approxBytes,
+                    std::function<void()> job);
+    size_t currentPageIndex() { return SkASSERT(!fPageRefs.empty()), fPageRefs.size() - 1; }
     size_t pageCount() { return fPageRefs.size(); }
 
     const SkMatrix& currentPageTransform() const;
@@ -148,6 +156,7 @@ public:
     SkTHashMap<uint32_t, SkPDFIndirectReference> fFontDescriptors;
     SkTHashMap<uint32_t, SkPDFIndirectReference> fType3FontDescriptors;
     SkTHashMap<uint64_t, SkPDFFont> fFontMap;
+    SkTHashMap<int, sk_sp<SkData>> fFontSubsets;  // Keyed by font reference; see onClose().
     SkTHashMap<SkPDFStrokeGraphicState, SkPDFIndirectReference> fStrokeGSMap;
     SkTHashMap<SkPDFFillGraphicState, SkPDFIndirectReference> fFillGSMap;
     SkPDFIndirectReference fInvertFunction;
@@ -160,6 +169,9 @@ private:
     SkCanvas fCanvas;
     std::vector<std::unique_ptr<SkPDFDict>> fPages;
     std::vector<SkPDFIndirectReference> fPageRefs;
+    // In streaming mode pages are written as they end, so only the refs of their parents in
+    // the page tree are kept; fPages stays empty.
+    std::vector<SkPDFIndirectReference> fPageTreeGroups;
 
     sk_sp<SkPDFDevice> fPageDevice;
     std::atomic<int> fNextObjectNumber = {1};
@@ -178,7 +190,28 @@ private:
     SkMutex fMutex;
     SkSemaphore fSemaphore;
 
+    // Objects emitted while any job is queued are held here until everything queued before
+    // them has been written.
+    struct PendingObjects {
+        std::vector<SkPDFIndirectReference> fRefs;  // Refs owned by a job.
+        std::vector<std::pair<SkPDFIndirectReference, sk_sp<SkData>>> fObjects;
+        size_t fBytes = 0;
+        bool fDone = false;
+    };
+    std::deque<std::unique_ptr<PendingObjects>> fPending;
+    SkTHashMap<int, PendingObjects*> fPendingForRef;
+    PendingObjects* fCurrentPending = nullptr;
+    SkPDFIndirectReference fCurrentRef;
+    SkDynamicMemoryWStream fPendingStream;
+    std::atomic<size_t> fPendingBytes = {0};
+
+    bool isStreaming() const { return fMetadata.fStreamingMemoryBudget > 0; }
+    size_t approxRetainedBytes() const;
+    void emitFonts();
+    void flushRetainedState();
     void waitForJobs();
+    bool waitForJob();
+    void writePendingObjects();
     SkWStream* beginObject(SkPDFIndirectReference);
     void endObject();
 };
@@ -308,10 +308,16 @@ static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
                 if (!SkToBool(metrics.fFlags &
                               SkAdvancedTypefaceMetrics::kNotSubsettable_FontFlag)) {
                     SkASSERT(font.firstGlyphID() == 1);
-                    sk_sp<SkData> subsetFontData = SkPDFSubsetFont(
-                            stream_to_data(std::move(fontAsset)), font.glyphUsage(),
-                            doc->metadata().fSubsetter,
-                            metrics.fFontName.c_str(), ttcIndex);
+                    sk_sp<SkData> subsetFontData;
+                    if (sk_sp<SkData>* prepared =
+                                doc->fFontSubsets.find(font.indirectReference().fValue)) {
+                        subsetFontData = std::move(*prepared);
+                    } else {
+                        subsetFontData = SkPDFSubsetFont(
+                                stream_to_data(std::move(fontAsset)), font.glyphUsage(),
+                                doc->metadata().fSubsetter,
+                                metrics.fFontName.c_str(), ttcIndex);
+                    }
                     if (subsetFontData) {
                         std::unique_ptr<SkPDFDict> tmp = SkPDFMakeDict();
                         tmp->insertInt("Length1", SkToInt(subsetFontData->size()));
@@ -681,6 +687,27 @@ void SkPDFFont::emitSubset(SkPDFDocument* doc) const {
     }
 }
 
+bool SkPDFFont::canSubset(SkPDFDocument* doc) const {
+    if (fFontType != SkAdvancedTypefaceMetrics::kTrueType_Font) {
+        return false;
+    }
+    const SkAdvancedTypefaceMetrics* metrics = SkPDFFont::GetMetrics(this->typeface(), doc);
+    return metrics && !SkToBool(metrics->fFlags &
+                                SkAdvancedTypefaceMetrics::kNotSubsettable_FontFlag);
+}
+
+sk_sp<SkData> SkPDFFont::makeSubset(SkPDFDocument* doc) const {
+    SkASSERT(doc->fTypefaceMetrics.find(this->typeface()->uniqueID()));
+    const SkAdvancedTypefaceMetrics* metrics = SkPDFFont::GetMetrics(this->typeface(), doc);
+    int ttcIndex;
+    std::unique_ptr<SkStreamAsset> fontAsset = this->typeface()->openStream(&ttcIndex);
+    if (!metrics || !fontAsset || fontAsset->getLength() == 0) {
+        return nullptr;
+    }
+    return SkPDFSubsetFont(stream_to_data(std::move(fontAsset)), this->glyphUsage(),
+                           doc->metadata().fSubsetter, metrics->fFontName.c_str(), ttcIndex);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 bool SkPDFFont::CanEmbedTypeface(SkTypeface* typeface, SkPDFDocument* doc) {
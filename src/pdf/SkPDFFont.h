@@ -108,6 +108,16 @@ public:
 
     void emitSubset(SkPDFDocument*) const;
 
+    /** Returns true if emitSubset() will subset this font's program with SkPDFSubsetFont().
+     */
+    bool canSubset(SkPDFDocument*) const;
+
+    /** Subset this font's program.  The typeface's metrics must already be cached in the
+     *  document, so this only reads from it and may run on the document's executor.
+     *  Returns nullptr if subsetting fails.
+     */
+    sk_sp<SkData> makeSubset(SkPDFDocument*) const;
+
     /**
      *  Return false iff the typeface has its NotEmbeddable flag set.
      *  typeface is not nullptr
@@ -269,6 +269,11 @@ private:
 
 struct SkFaceRec;
 
+// f_t_mutex() guards the shared FT_Library and the list of open faces: creating, finding, and
+// destroying SkFaceRecs. Using an open face is guarded by that face's own SkFaceRec::fMutex,
+// so different faces can load and render glyphs concurrently. FreeType allows this as long as
+// each FT_Face (and its FT_Sizes) is only used by one thread at a time.
+// When both are needed, f_t_mutex() must be acquired first.
 static SkMutex& f_t_mutex() {
     static SkMutex& mutex = *(new SkMutex);
     return mutex;
@@ -311,6 +316,7 @@ static void unref_ft_library() {
 
 struct SkFaceRec {
     SkFaceRec* fNext;
+    SkMutex fMutex;  // Guards all use of fFace and its FT_Sizes.
     SkUniqueFTFace fFace;
     FT_StreamRec fFTStream;
     std::unique_ptr<SkStreamAsset> fSkStream;
@@ -497,17 +503,25 @@ extern /*static*/ void unref_ft_face(SkFaceRec* faceRec) {
 class AutoFTAccess {
 public:
     AutoFTAccess(const SkTypeface_FreeType* tf) : fFaceRec(nullptr) {
-        f_t_mutex().acquire();
-        SkASSERT_RELEASE(ref_ft_library());
-        fFaceRec = ref_ft_face(tf);
+        {
+            SkAutoMutexExclusive ac(f_t_mutex());
+            SkASSERT_RELEASE(ref_ft_library());
+            fFaceRec = ref_ft_face(tf);
+        }
+        if (fFaceRec) {
+            fFaceRec->fMutex.acquire();
+        }
     }
 
     ~AutoFTAccess() {
+        if (fFaceRec) {
+            fFaceRec->fMutex.release();
+        }
+        SkAutoMutexExclusive ac(f_t_mutex());
         if (fFaceRec) {
             unref_ft_face(fFaceRec);
         }
         unref_ft_library();
-        f_t_mutex().release();
     }
 
     FT_Face face() { return fFaceRec ? fFaceRec->fFace.get() : nullptr; }
@@ -567,9 +581,9 @@ private:
     void getBBoxForCurrentGlyph(const SkGlyph* glyph, FT_BBox* bbox,
                                 bool snapToPixelBoundary = false);
     bool getCBoxForLetter(char letter, FT_BBox* bbox);
-    // Caller must lock f_t_mutex() before calling this function.
+    // Caller must lock fFaceRec->fMutex before calling this function.
     void updateGlyphIfLCD(SkGlyph* glyph);
-    // Caller must lock f_t_mutex() before calling this function.
+    // Caller must lock fFaceRec->fMutex before calling this function.
     // update FreeType2 glyph slot with glyph emboldened
     void emboldenIfNeeded(FT_Face face, FT_GlyphSlot glyph, SkGlyphID gid);
     bool shouldSubpixelBitmap(const SkGlyph&, const SkMatrix&);
@@ -966,6 +980,7 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType> ty
         LOG_INFO("Could not create FT_Face.\n");
         return;
     }
+    SkAutoMutexExclusive  faceLock(fFaceRec->fMutex);
 
     fLCDIsVert = SkToBool(fRec.fFlags & SkScalerContext::kLCD_Vertical_Flag);
 
@@ -1137,6 +1152,7 @@ SkScalerContext_FreeType::~SkScalerContext_FreeType() {
     SkAutoMutexExclusive  ac(f_t_mutex());
 
     if (fFTSize != nullptr) {
+        SkAutoMutexExclusive  faceLock(fFaceRec->fMutex);
         FT_Done_Size(fFTSize);
     }
 
@@ -1149,7 +1165,7 @@ SkScalerContext_FreeType::~SkScalerContext_FreeType() {
     this face with other context (at different sizes).
 */
 FT_Error SkScalerContext_FreeType::setupSize() {
-    f_t_mutex().assertHeld();
+    fFaceRec->fMutex.assertHeld();
     FT_Error err = FT_Activate_Size(fFTSize);
     if (err != 0) {
         return err;
@@ -1166,7 +1182,7 @@ bool SkScalerContext_FreeType::generateAdvance(SkGlyph* glyph) {
         return false;
     }
 
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(fFaceRec->fMutex);
 
     if (this->setupSize()) {
         glyph->zeroMetrics();
@@ -1271,7 +1287,7 @@ bool SkScalerContext_FreeType::shouldSubpixelBitmap(const SkGlyph& glyph, const
 }
 
 void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(fFaceRec->fMutex);
 
     glyph->fMaskFormat = fRec.fMaskFormat;
 
@@ -1488,7 +1504,7 @@ void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
 }
 
 void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(fFaceRec->fMutex);
 
     if (this->setupSize()) {
         sk_bzero(glyph.fImage, glyph.imageSize());
@@ -1521,7 +1537,7 @@ void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
 bool SkScalerContext_FreeType::generatePath(SkGlyphID glyphID, SkPath* path) {
     SkASSERT(path);
 
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(fFaceRec->fMutex);
 
     // FT_IS_SCALABLE is documented to mean the face contains outline glyphs.
     if (!FT_IS_SCALABLE(fFace) || this->setupSize()) {
@@ -1562,7 +1578,7 @@ void SkScalerContext_FreeType::generateFontMetrics(SkFontMetrics* metrics) {
         return;
     }
 
-    SkAutoMutexExclusive ac(f_t_mutex());
+    SkAutoMutexExclusive ac(fFaceRec->fMutex);
 
     if (this->setupSize()) {
         sk_bzero(metrics, sizeof(*metrics));
@@ -1756,14 +1772,7 @@ void SkTypeface_FreeType::onCharsToGlyphs(const SkUnichar uni[], int count,
 
     SkAutoMutexExclusive ama(fC2GCacheMutex);
 
-    int i;
-    for (i = 0; i < count; ++i) {
-        int index = fC2GCache.findGlyphIndex(uni[i]);
-        if (index < 0) {
-            break;
-        }
-        glyphs[i] = SkToU16(index);
-    }
+    int i = fC2GCache.findGlyphs(uni, count, glyphs);
     if (i == count) {
         // we're done, no need to access the freetype objects
         return;
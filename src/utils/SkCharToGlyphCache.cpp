@@ -6,6 +6,7 @@
  */
 
 #include "include/private/SkTFitsIn.h"
+#include "include/private/SkTo.h"
 #include "src/utils/SkCharToGlyphCache.h"
 
 SkCharToGlyphCache::SkCharToGlyphCache() {
@@ -25,6 +26,8 @@ void SkCharToGlyphCache::reset() {
     *fK32.append() = 0x7FFFFFFF;    *fV16.append() = 0;
 
     fDenom = 0;
+
+    sk_bzero(fASCIIKnown, sizeof(fASCIIKnown));
 }
 
 // Determined experimentally. For N much larger, the slope technique is faster.
@@ -94,6 +97,11 @@ static int find_with_slope(const SkUnichar base[], int count, SkUnichar value, d
 }
 
 int SkCharToGlyphCache::findGlyphIndex(SkUnichar unichar) const {
+    SkGlyphID glyph;
+    if (this->findASCII(unichar, &glyph)) {
+        return glyph;
+    }
+
     const int count = fK32.count();
     int index;
     if (count <= kSmallCountLimit) {
@@ -107,6 +115,25 @@ int SkCharToGlyphCache::findGlyphIndex(SkUnichar unichar) const {
     return index;
 }
 
+int SkCharToGlyphCache::findGlyphs(const SkUnichar uni[], int count, SkGlyphID glyphs[]) const {
+    int i = 0;
+    while (i < count) {
+        // Runs of ASCII never reach the sorted keys.
+        while (i < count && this->findASCII(uni[i], &glyphs[i])) {
+            ++i;
+        }
+        if (i == count) {
+            break;
+        }
+        int index = this->findGlyphIndex(uni[i]);
+        if (index < 0) {
+            break;
+        }
+        glyphs[i++] = SkToU16(index);
+    }
+    return i;
+}
+
 void SkCharToGlyphCache::insertCharAndGlyph(int index, SkUnichar unichar, SkGlyphID glyph) {
     SkASSERT(fK32.size() == fV16.size());
     SkASSERT((unsigned)index < fK32.size());
@@ -115,6 +142,11 @@ void SkCharToGlyphCache::insertCharAndGlyph(int index, SkUnichar unichar, SkGlyp
     *fK32.insert(index) = unichar;
     *fV16.insert(index) = glyph;
 
+    if ((uint32_t)unichar < kASCIICount) {
+        fASCIIKnown[unichar >> 6] |= uint64_t{1} << (unichar & 63);
+        fASCIIGlyphs[unichar] = glyph;
+    }
+
     // if we've changed the first [1] or last [count-2] entry, recompute our slope
     const int count = fK32.count();
     if (count >= kMinCountForSlope && (index == 1 || index == count - 2)) {
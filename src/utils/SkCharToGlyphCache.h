@@ -37,6 +37,12 @@ public:
      */
     int findGlyphIndex(SkUnichar c) const;
 
+    /**
+     *  Look up the glyphIDs of uni[] in order, stopping at the first unichar not in the cache.
+     *  Returns how many glyphs[] were filled in; glyphs[i] for i past that are left alone.
+     */
+    int findGlyphs(const SkUnichar uni[], int count, SkGlyphID glyphs[]) const;
+
     /**
      *  Insert a new char/glyph pair into the cache at the specified index.
      *  See charToGlyph() for how to compute the bit-not of the index.
@@ -54,9 +60,23 @@ public:
     }
 
 private:
+    static constexpr int kASCIICount = 128;
+
+    bool findASCII(SkUnichar c, SkGlyphID* glyph) const {
+        if ((uint32_t)c < kASCIICount && (fASCIIKnown[c >> 6] >> (c & 63) & 1)) {
+            *glyph = fASCIIGlyphs[c];
+            return true;
+        }
+        return false;
+    }
+
     SkTDArray<int32_t>   fK32;
     SkTDArray<uint16_t>  fV16;
     double               fDenom;
+
+    // Most text is mostly ASCII, so those glyphs are also kept in a table indexed by unichar.
+    uint64_t             fASCIIKnown[kASCIICount / 64];
+    uint16_t             fASCIIGlyphs[kASCIICount];
 };
 
 #endif
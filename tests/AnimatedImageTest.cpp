@@ -12,8 +12,10 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkData.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPicture.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkString.h"
@@ -469,3 +471,67 @@ DEF_TEST(AnimatedImage, r) {
         }
     }
 }
+
+DEF_TEST(AnimatedImage_shared, r) {
+    if (GetResourcePath().isEmpty()) {
+        return;
+    }
+    for (const char* file : { "images/alphabetAnim.gif",
+                              "images/colorTables.gif",
+                              "images/stoplight.webp",
+                              "images/required.webp",
+                              }) {
+        auto data = GetResourceAsData(file);
+        if (!data) {
+            ERRORF(r, "Could not get %s", file);
+            continue;
+        }
+
+        // Each instance decodes its own copy of the bytes, as separate views would.
+        auto copy = [&data]() { return SkData::MakeWithCopy(data->data(), data->size()); };
+        auto reference = SkAnimatedImage::Make(SkAndroidCodec::MakeFromData(copy()));
+        auto first = SkAnimatedImage::MakeShared(copy());
+        if (!reference || !first) {
+            ERRORF(r, "Could not create animated images for %s", file);
+            continue;
+        }
+        const int frameCount = reference->getFrameCount();
+
+        // Copies the current frame into bm, returning the address of the frame's own pixels.
+        auto pixels_of = [](const sk_sp<SkAnimatedImage>& image, SkBitmap* bm) -> const void* {
+            sk_sp<SkImage> frame = image->getCurrentFrame();
+            SkPixmap pm;
+            if (!frame || !frame->peekPixels(&pm) || !bm->tryAllocPixels(pm.info())
+                    || !bm->writePixels(pm)) {
+                return nullptr;
+            }
+            return pm.addr();
+        };
+
+        // The first instance decodes (and publishes) every frame.
+        std::vector<const void*> firstPixels(frameCount);
+        for (int i = 0; i < frameCount; i++) {
+            SkBitmap bm;
+            firstPixels[i] = pixels_of(first, &bm);
+            first->decodeNextFrame();
+        }
+
+        // A second instance should pick those frames up rather than decode them,
+        // and still match an unshared instance.
+        auto second = SkAnimatedImage::MakeShared(copy());
+        int sharedFrames = 0;
+        for (int i = 0; i < frameCount; i++) {
+            SkBitmap expected, actual;
+            pixels_of(reference, &expected);
+            const void* pixels = pixels_of(second, &actual);
+            compare_bitmaps(r, file, i, expected, actual);
+            if (pixels == firstPixels[i]) {
+                sharedFrames++;
+            }
+            REPORTER_ASSERT(r, reference->currentFrameDuration() == second->currentFrameDuration());
+            reference->decodeNextFrame();
+            second->decodeNextFrame();
+        }
+        REPORTER_ASSERT(r, sharedFrames > 0, "%s shared no frames", file);
+    }
+}
@@ -11,6 +11,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorPriv.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMaskFilter.h"
 #include "include/core/SkMath.h"
@@ -30,6 +31,8 @@
 #include "include/gpu/GrDirectContext.h"
 #include "include/private/SkFloatBits.h"
 #include "include/private/SkTPin.h"
+#include "include/utils/SkRandom.h"
+#include "src/core/SkBlurEngine.h"
 #include "src/core/SkBlurMask.h"
 #include "src/core/SkGpuBlurUtils.h"
 #include "src/core/SkMask.h"
@@ -573,3 +576,145 @@ DEF_TEST(zero_blur, reporter) {
     SkIPoint offset;
     bitmap.extractAlpha(&alpha, &paint, nullptr, &offset);
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////
+
+DEF_TEST(BlurEngine, reporter) {
+    SkRandom rand;
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    auto equal = [](const SkPixmap& a, const SkPixmap& b) {
+        for (int y = 0; y < a.height(); ++y) {
+            if (0 != memcmp(a.addr(0, y), b.addr(0, y), a.info().minRowBytes())) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Odd sizes leave the SIMD lanes partly full; the big one is split into several stripes.
+    const SkISize sizes[] = {{37, 29}, {1, 5}, {301, 257}};
+    const int windows[] = {1, 4, 7, 10};
+    for (SkISize size : sizes) {
+        SkBitmap src, srcA8;
+        src.allocN32Pixels(size.width(), size.height());
+        srcA8.allocPixels(SkImageInfo::MakeA8(size.width(), size.height()));
+        for (int y = 0; y < size.height(); ++y) {
+            for (int x = 0; x < size.width(); ++x) {
+                U8CPU a = rand.nextULessThan(256),
+                      c = rand.nextULessThan(a + 1);
+                *src.getAddr32(x, y) = SkPackARGB32(a, c, a - c, c / 2);
+                *srcA8.getAddr8(x, y) = a;
+            }
+        }
+
+        for (int windowX : windows)
+        for (int windowY : windows) {
+            int borderX = SkBlurEngine::BorderForWindow(windowX),
+                borderY = SkBlurEngine::BorderForWindow(windowY);
+            SkIPoint offset = {borderX, borderY};
+            int dstW = size.width()  + 2 * borderX,
+                dstH = size.height() + 2 * borderY;
+
+            SkBitmap serial, striped, a8;
+            serial.allocN32Pixels(dstW, dstH);
+            striped.allocN32Pixels(dstW, dstH);
+            a8.allocPixels(SkImageInfo::MakeA8(dstW, dstH));
+
+            REPORTER_ASSERT(reporter, SkBlurEngine::Blur(src.pixmap(), offset, windowX, windowY,
+                                                         serial.pixmap(), nullptr));
+            REPORTER_ASSERT(reporter, SkBlurEngine::Blur(src.pixmap(), offset, windowX, windowY,
+                                                         striped.pixmap(), executor.get()));
+            REPORTER_ASSERT(reporter, SkBlurEngine::Blur(srcA8.pixmap(), offset, windowX, windowY,
+                                                         a8.pixmap(), nullptr));
+
+            // Threads do not change the results.
+            REPORTER_ASSERT(reporter, equal(serial.pixmap(), striped.pixmap()));
+
+            bool ok = true;
+            for (int y = 0; y < dstH; ++y) {
+                for (int x = 0; x < dstW; ++x) {
+                    SkPMColor c = *serial.getAddr32(x, y);
+                    // The channels are independent of each other.
+                    ok &= SkGetPackedA32(c) == *a8.getAddr8(x, y);
+                    // A blur of premul colors stays premul.
+                    ok &= SkGetPackedR32(c) <= SkGetPackedA32(c);
+                    // A window of 1 is a plain copy.
+                    if (windowX == 1 && windowY == 1) {
+                        SkIPoint p = {x - borderX, y - borderY};
+                        ok &= c == (SkIRect::MakeSize(size).contains(p.x(), p.y())
+                                            ? *src.getAddr32(p.x(), p.y()) : 0);
+                    }
+                }
+            }
+            REPORTER_ASSERT(reporter, ok, "windows %d, %d, size %dx%d",
+                            windowX, windowY, size.width(), size.height());
+        }
+    }
+
+    // An opaque area stays opaque away from its edges, and does not spread past the border.
+    SkBitmap opaque, blurred;
+    opaque.allocPixels(SkImageInfo::MakeA8(64, 64));
+    opaque.eraseColor(SK_ColorBLACK);
+    int window = SkBlurEngine::WindowForSigma(5),
+        border = SkBlurEngine::BorderForWindow(window);
+    blurred.allocPixels(SkImageInfo::MakeA8(64 + 2 * border + 2, 64 + 2 * border + 2));
+    REPORTER_ASSERT(reporter, SkBlurEngine::Blur(opaque.pixmap(), {border + 1, border + 1},
+                                                 window, window, blurred.pixmap()));
+    REPORTER_ASSERT(reporter, *blurred.getAddr8(border + 32, border + 32) == 0xFF);
+    REPORTER_ASSERT(reporter, *blurred.getAddr8(0, border + 32) == 0);
+    REPORTER_ASSERT(reporter, *blurred.getAddr8(border + 1, border + 32) > 0);
+    REPORTER_ASSERT(reporter, *blurred.getAddr8(border + 1, border + 32) < 0xFF);
+}
+
+DEF_TEST(BlurEngine_Downsample, reporter) {
+    REPORTER_ASSERT(reporter, SkBlurEngine::DownsampleForSigma(100, 0) == 1);
+    REPORTER_ASSERT(reporter, SkBlurEngine::DownsampleForSigma(10, 2) == 1);
+    REPORTER_ASSERT(reporter, SkBlurEngine::DownsampleForSigma(100, 2) > 1);
+    REPORTER_ASSERT(reporter, SkBlurEngine::DownsampleForSigma(100, 4) >
+                              SkBlurEngine::DownsampleForSigma(100, 2));
+    REPORTER_ASSERT(reporter, SkBlurEngine::ScaledSigma(30, 1) == 30);
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    // Hard edges are where blurring at reduced resolution is furthest off.
+    SkBitmap src;
+    src.allocPixels(SkImageInfo::MakeA8(203, 150));
+    src.eraseColor(SK_ColorTRANSPARENT);
+    src.erase(SK_ColorBLACK, SkIRect::MakeLTRB(40, 30, 121, 97));
+
+    for (double sigma : {50.0, 120.0}) {
+        int border = SkBlurEngine::BorderForWindow(SkBlurEngine::WindowForSigma(sigma));
+        // An offset that is not a multiple of the scale.
+        SkIPoint offset = {border - 3, border - 5};
+        SkImageInfo dstInfo = SkImageInfo::MakeA8(src.width() + 2 * border - 3,
+                                                  src.height() + 2 * border - 5);
+        for (float maxError : {1.0f, 2.0f, 4.0f, 8.0f}) {
+            SkBitmap full, serial, striped;
+            full.allocPixels(dstInfo);
+            serial.allocPixels(dstInfo);
+            striped.allocPixels(dstInfo);
+            REPORTER_ASSERT(reporter, SkBlurEngine::GaussianBlur(src.pixmap(), offset, sigma, sigma,
+                                                                 full.pixmap(), nullptr, 0));
+            REPORTER_ASSERT(reporter, SkBlurEngine::GaussianBlur(src.pixmap(), offset, sigma, sigma,
+                                                                 serial.pixmap(), nullptr,
+                                                                 maxError));
+            REPORTER_ASSERT(reporter, SkBlurEngine::GaussianBlur(src.pixmap(), offset, sigma, sigma,
+                                                                 striped.pixmap(), executor.get(),
+                                                                 maxError));
+
+            int worst = 0;
+            bool same = true;
+            for (int y = 0; y < dstInfo.height(); ++y) {
+                for (int x = 0; x < dstInfo.width(); ++x) {
+                    worst = std::max(worst, std::abs(*full.getAddr8(x, y) -
+                                                     *serial.getAddr8(x, y)));
+                    same &= *serial.getAddr8(x, y) == *striped.getAddr8(x, y);
+                }
+            }
+            REPORTER_ASSERT(reporter, worst <= maxError, "sigma %g error %g: off by %d",
+                            sigma, maxError, worst);
+            REPORTER_ASSERT(reporter, same);
+        }
+    }
+}
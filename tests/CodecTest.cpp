@@ -19,6 +19,7 @@
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
 #include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageEncoder.h"
 #include "include/core/SkImageGenerator.h"
@@ -52,6 +53,7 @@
 #include "png.h"
 
 #include <setjmp.h>
+#include <atomic>
 #include <cstring>
 #include <initializer_list>
 #include <memory>
@@ -1839,3 +1841,65 @@ DEF_TEST(Codec_noConversion, r) {
         REPORTER_ASSERT(r, bm.getColor(0, 0) == rec.color);
     }
 }
+
+namespace {
+// Counts the tasks added, to tell whether a decode went through the executor at all.
+class CountingExecutor final : public SkExecutor {
+public:
+    void add(std::function<void(void)> work) override {
+        fTaskCount++;
+        fPool->add(std::move(work));
+    }
+    void borrow() override { fPool->borrow(); }
+
+    int taskCount() const { return fTaskCount.load(); }
+    void resetTaskCount() { fTaskCount = 0; }
+
+private:
+    std::unique_ptr<SkExecutor> fPool = SkExecutor::MakeFIFOThreadPool(4);
+    std::atomic<int> fTaskCount{0};
+};
+}  // namespace
+
+// icc-v2-gbr.jpg has a restart marker after every MCU row, so SkJpegCodec can decode it in
+// stripes on an executor.  That must match the serial decode exactly.
+DEF_TEST(Codec_jpeg_parallel, r) {
+    sk_sp<SkData> data = GetResourceAsData("images/icc-v2-gbr.jpg");
+    if (!data) {
+        return;
+    }
+    auto executor = std::make_unique<CountingExecutor>();
+
+    auto decode = [&](const SkImageInfo& info, SkExecutor* exec, SkBitmap* bm) {
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+        SkCodec::Options options;
+        options.fExecutor = exec;
+        bm->allocPixels(info);
+        return codec->getPixels(info, bm->getPixels(), bm->rowBytes(), &options);
+    };
+
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+    for (float scale : {1.0f, 0.5f}) {
+        const SkISize size = codec->getScaledDimensions(scale);
+        for (SkColorType colorType : {kRGBA_8888_SkColorType, kBGRA_8888_SkColorType,
+                                      kRGB_565_SkColorType, kRGBA_F16_SkColorType}) {
+            for (sk_sp<SkColorSpace> colorSpace : {sk_sp<SkColorSpace>(nullptr),
+                                                   SkColorSpace::MakeSRGB()}) {
+                SkImageInfo info = codec->getInfo().makeDimensions(size)
+                                                   .makeColorType(colorType)
+                                                   .makeColorSpace(colorSpace);
+                SkBitmap serial, parallel;
+                if (decode(info, nullptr, &serial) != SkCodec::kSuccess) {
+                    continue;
+                }
+                executor->resetTaskCount();
+                REPORTER_ASSERT(r, decode(info, executor.get(), &parallel) == SkCodec::kSuccess);
+                REPORTER_ASSERT(r, md5(serial) == md5(parallel));
+                // Otherwise this only compared two serial decodes.
+                REPORTER_ASSERT(r, executor->taskCount() >= 2,
+                                "scale %g, color type %d: decoded in %d stripes",
+                                scale, colorType, executor->taskCount());
+            }
+        }
+    }
+}
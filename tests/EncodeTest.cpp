@@ -12,6 +12,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColorPriv.h"
 #include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
@@ -332,6 +333,45 @@ DEF_TEST(Encode_PngOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm0, bm2, 0));
 }
 
+DEF_TEST(Encode_PngParallel, r) {
+    SkBitmap bitmap;
+    if (!GetResourceAsBitmap("images/mandrill_512.png", &bitmap)) {
+        return;
+    }
+    SkPixmap src;
+    REPORTER_ASSERT(r, bitmap.peekPixels(&src));
+
+    SkDynamicMemoryWStream serialDst;
+    SkPngEncoder::Options options;
+    REPORTER_ASSERT(r, SkPngEncoder::Encode(&serialDst, src, options));
+    sk_sp<SkData> serialData = serialDst.detachAsData();
+
+    SkBitmap serialBitmap;
+    SkImage::MakeFromEncoded(serialData)->asLegacyBitmap(&serialBitmap);
+
+    sk_sp<SkData> firstData;
+    for (int threads : {1, 4}) {
+        auto executor = SkExecutor::MakeFIFOThreadPool(threads);
+        options.fExecutor = executor.get();
+
+        SkDynamicMemoryWStream dst;
+        REPORTER_ASSERT(r, SkPngEncoder::Encode(&dst, src, options));
+        sk_sp<SkData> data = dst.detachAsData();
+
+        // The output must not depend on the number of threads...
+        if (firstData) {
+            REPORTER_ASSERT(r, data->equals(firstData.get()));
+        } else {
+            firstData = data;
+        }
+
+        // ... and must decode to the same pixels as the serial encoder.
+        SkBitmap bm;
+        SkImage::MakeFromEncoded(data)->asLegacyBitmap(&bm);
+        REPORTER_ASSERT(r, almost_equals(serialBitmap, bm, 0));
+    }
+}
+
 #ifndef SK_BUILD_FOR_GOOGLE3
 DEF_TEST(Encode_WebpQuality, r) {
     SkBitmap bm;
@@ -8,13 +8,17 @@
 #include "tests/Test.h"
 
 #include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
 #include "include/core/SkColorFilter.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkMatrix.h"
+#include "include/core/SkPoint3.h"
 #include "include/effects/SkImageFilters.h"
 #include "src/core/SkImageFilterCache.h"
+#include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkSpecialImage.h"
+#include "src/core/SkSpecialSurface.h"
 
 SK_USE_FLUENT_IMAGE_FILTER_TYPES
 
@@ -154,6 +158,74 @@ static void test_explicit_purging(skiatest::Reporter* reporter,
     REPORTER_ASSERT(reporter, !cache->get(key2, &foundImage));
 }
 
+// In kRegions mode, results are also found for other clip bounds and, when the filter doesn't read
+// its source, for layer matrices translated by whole pixels.
+static void test_find_regions(skiatest::Reporter* reporter, const sk_sp<SkSpecialImage>& image) {
+    static const size_t kCacheSize = 1000000;
+    sk_sp<SkImageFilterCache> cache(
+            SkImageFilterCache::Create(kCacheSize, SkImageFilterCache::Mode::kRegions));
+
+    SkIRect clip = SkIRect::MakeWH(100, 100);
+    SkIRect noSubset = SkIRect::MakeWH(0, 0);
+    SkImageFilterCacheKey srcKey(0, SkMatrix::I(), clip, image->uniqueID(), image->subset());
+    SkImageFilterCacheKey noSrcKey(1, SkMatrix::Translate(0.5f, 0), clip, 0, noSubset);
+
+    SkIPoint offset = SkIPoint::Make(3, 4);
+    auto filter = make_filter();
+    cache->set(srcKey, filter.get(),
+               skif::FilterResult<For::kOutput>(image, skif::LayerSpace<SkIPoint>(offset)));
+    cache->set(noSrcKey, filter.get(),
+               skif::FilterResult<For::kOutput>(image, skif::LayerSpace<SkIPoint>(offset)));
+
+    skif::FilterResult<For::kOutput> foundImage;
+    skif::LayerSpace<SkIRect> validBounds;
+    auto valid = [&] { return static_cast<const SkIRect&>(validBounds); };
+
+    // A clip within the cached one is covered by it...
+    SkImageFilterCacheKey inside(0, SkMatrix::I(), SkIRect::MakeLTRB(10, 10, 50, 50),
+                                 image->uniqueID(), image->subset());
+    REPORTER_ASSERT(reporter, cache->find(inside, &foundImage, &validBounds));
+    REPORTER_ASSERT(reporter, valid() == clip);
+    REPORTER_ASSERT(reporter, offset == SkIPoint(foundImage.layerOrigin()));
+
+    // ... and one overlapping it is partly covered, though get() only finds identical keys.
+    SkImageFilterCacheKey overlap(0, SkMatrix::I(), SkIRect::MakeLTRB(50, 50, 150, 150),
+                                  image->uniqueID(), image->subset());
+    REPORTER_ASSERT(reporter, cache->find(overlap, &foundImage, &validBounds));
+    REPORTER_ASSERT(reporter, valid() == clip);
+    REPORTER_ASSERT(reporter, !cache->get(overlap, &foundImage));
+
+    SkImageFilterCacheKey disjoint(0, SkMatrix::I(), SkIRect::MakeLTRB(100, 0, 200, 100),
+                                   image->uniqueID(), image->subset());
+    REPORTER_ASSERT(reporter, !cache->find(disjoint, &foundImage, &validBounds));
+
+    // The source doesn't move with the matrix...
+    SkImageFilterCacheKey moved(0, SkMatrix::Translate(0, 10), clip,
+                                image->uniqueID(), image->subset());
+    REPORTER_ASSERT(reporter, !cache->find(moved, &foundImage, &validBounds));
+
+    // ... but without one the whole result does.
+    SkImageFilterCacheKey scrolled(1, SkMatrix::Translate(0.5f, -10), clip, 0, noSubset);
+    REPORTER_ASSERT(reporter, cache->find(scrolled, &foundImage, &validBounds));
+    REPORTER_ASSERT(reporter, valid() == SkIRect::MakeLTRB(0, -10, 100, 90));
+    REPORTER_ASSERT(reporter, SkIPoint::Make(3, -6) == SkIPoint(foundImage.layerOrigin()));
+
+    SkImageFilterCacheKey subpixel(1, SkMatrix::Translate(0.25f, -10), clip, 0, noSubset);
+    REPORTER_ASSERT(reporter, !cache->find(subpixel, &foundImage, &validBounds));
+
+    SkImageFilterCache::Stats stats = cache->stats();
+    REPORTER_ASSERT(reporter, stats.fHits == 1);
+    REPORTER_ASSERT(reporter, stats.fPartialHits == 2);
+    REPORTER_ASSERT(reporter, stats.fMisses == 3);
+    REPORTER_ASSERT(reporter, stats.fBytes == 2 * image->getSize());
+
+    // None of that happens in the default mode.
+    cache->setMode(SkImageFilterCache::Mode::kExact);
+    REPORTER_ASSERT(reporter, cache->find(srcKey, &foundImage, &validBounds));
+    REPORTER_ASSERT(reporter, !cache->find(inside, &foundImage, &validBounds));
+    REPORTER_ASSERT(reporter, !cache->find(scrolled, &foundImage, &validBounds));
+}
+
 DEF_TEST(ImageFilterCache_RasterBacked, reporter) {
     SkBitmap srcBM = create_bm();
 
@@ -170,6 +242,71 @@ DEF_TEST(ImageFilterCache_RasterBacked, reporter) {
     test_dont_find_if_diff_key(reporter, fullImg, subsetImg);
     test_internal_purge(reporter, fullImg);
     test_explicit_purging(reporter, fullImg, subsetImg);
+    test_find_regions(reporter, fullImg);
+}
+
+// Scrolling a filter that doesn't read its source only filters the newly exposed rows, and gives
+// the same results as filtering from scratch. That includes lighting, which takes one-sided
+// normals along the edges of its output, so the edges of the old and new clip bounds differ.
+DEF_TEST(ImageFilterCache_RegionsScroll, reporter) {
+    SkBitmap contentBM;
+    contentBM.allocN32Pixels(64, 256);
+    for (int y = 0; y < contentBM.height(); ++y) {
+        for (int x = 0; x < contentBM.width(); ++x) {
+            *contentBM.getAddr32(x, y) = ((x / 4 + y / 8) & 1) ? 0xFF204080 : 0x80800000;
+        }
+    }
+    sk_sp<SkImageFilter> content =
+            SkImageFilters::Image(contentBM.asImage(), SkSamplingOptions());
+    sk_sp<SkImageFilter> filters[] = {
+        SkImageFilters::Blur(2, 3, content),
+        SkImageFilters::DistantLitDiffuse(SkPoint3::Make(1, 2, 3), SK_ColorWHITE, 2, 1,
+                                          SkImageFilters::Dilate(1, 2, content)),
+    };
+
+    sk_sp<SkSpecialSurface> srcSurface(SkSpecialSurface::MakeRaster(
+            SkImageInfo::MakeN32Premul(1, 1), SkSurfaceProps()));
+    sk_sp<SkSpecialImage> src = srcSurface->makeImageSnapshot();
+
+    const SkIRect clip = SkIRect::MakeWH(48, 40);
+    for (const sk_sp<SkImageFilter>& filter : filters) {
+        static const size_t kCacheSize = 1000000;
+        sk_sp<SkImageFilterCache> cache(
+                SkImageFilterCache::Create(kCacheSize, SkImageFilterCache::Mode::kRegions));
+
+        auto filterAt = [&](SkImageFilterCache* cache, int scroll) {
+            skif::Context ctx(SkMatrix::Translate(0, -scroll), clip, cache, kN32_SkColorType,
+                              nullptr, src.get());
+            SkIPoint offset;
+            sk_sp<SkSpecialImage> result =
+                    as_IFB(filter)->filterImage(ctx).imageAndOffset(&offset);
+
+            SkBitmap bm;
+            bm.allocN32Pixels(clip.width(), clip.height());
+            bm.eraseColor(SK_ColorTRANSPARENT);
+            if (result) {
+                SkCanvas canvas(bm);
+                result->draw(&canvas, offset.fX, offset.fY);
+            }
+            return bm;
+        };
+
+        for (int scroll : {0, 5, 17, 30, 30, 31, 200}) {
+            SkBitmap cached = filterAt(cache.get(), scroll),
+                     fresh  = filterAt(nullptr, scroll);
+            for (int y = 0; y < clip.height(); ++y) {
+                if (memcmp(cached.getAddr32(0, y), fresh.getAddr32(0, y), clip.width() * 4)) {
+                    ERRORF(reporter, "%s, scroll %d, row %d differs",
+                           filter->getTypeName(), scroll, y);
+                    break;
+                }
+            }
+        }
+
+        SkImageFilterCache::Stats stats = cache->stats();
+        REPORTER_ASSERT(reporter, stats.fPartialHits > 0);
+        REPORTER_ASSERT(reporter, stats.fHits > 0);
+    }
 }
 
 
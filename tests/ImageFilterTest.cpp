@@ -7,6 +7,7 @@
 
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
@@ -1190,6 +1191,77 @@ DEF_GPUTEST_FOR_RENDERING_CONTEXTS(ImageFilterMatrixConvolutionBigKernel_Gpu,
     test_big_kernel(reporter, ctxInfo.directContext());
 }
 
+// Filtering in tiles, including tiles cut short by the clip, matches filtering all at once, for
+// chains of filters that read their inputs' neighbors and treat their edges specially, including
+// one too deep to be tiled.
+DEF_TEST(ImageFilterInTiles, reporter) {
+    SkBitmap srcBM;
+    srcBM.allocN32Pixels(300, 300);
+    for (int y = 0; y < srcBM.height(); ++y) {
+        for (int x = 0; x < srcBM.width(); ++x) {
+            U8CPU a = (x * 7 + y * 13) & 0xFF;
+            *srcBM.getAddr32(x, y) = ((x / 5 + y / 3) & 1) ? SkPreMultiplyARGB(a, 0x20, 0x80, a)
+                                                           : SkPreMultiplyARGB(0xFF, a, 0, 0x40);
+        }
+    }
+    sk_sp<SkSpecialImage> src(SkSpecialImage::MakeFromRaster(SkIRect::MakeWH(300, 300), srcBM,
+                                                             SkSurfaceProps()));
+
+    const SkScalar kernel[9] = {
+        1, 2, 1,
+        0, 1, 0,
+        -1, 1, -1,
+    };
+    sk_sp<SkImageFilter> deep;
+    for (int i = 0; i < 20; ++i) {
+        deep = SkImageFilters::DistantLitDiffuse(SkPoint3::Make(1, -2, 3), SK_ColorWHITE, 2, 1,
+                                                 std::move(deep));
+    }
+    sk_sp<SkImageFilter> filters[] = {
+        SkImageFilters::DistantLitDiffuse(
+                SkPoint3::Make(1, -2, 3), SK_ColorWHITE, 2, 1,
+                SkImageFilters::Dilate(2, 1, SkImageFilters::MatrixConvolution(
+                        SkISize::Make(3, 3), kernel, 0.25f, 0, SkIPoint::Make(1, 1),
+                        SkTileMode::kDecal, true, nullptr))),
+        std::move(deep),
+    };
+
+    const SkIRect clip = SkIRect::MakeXYWH(10, 7, 280, 270);
+    auto filterImage = [&](SkImageFilter* filter, bool tiled, SkExecutor* executor) {
+        SkImageFilter_Base::Context ctx(SkMatrix::I(), clip, nullptr, kN32_SkColorType, nullptr,
+                                        src.get());
+        SkIPoint offset;
+        sk_sp<SkSpecialImage> result =
+                (tiled ? as_IFB(filter)->filterImageInTiles(ctx, executor, 128)
+                       : as_IFB(filter)->filterImage(ctx)).imageAndOffset(&offset);
+
+        SkBitmap bm;
+        bm.allocN32Pixels(clip.width(), clip.height());
+        bm.eraseColor(SK_ColorTRANSPARENT);
+        if (result) {
+            SkCanvas canvas(bm);
+            canvas.clipIRect(SkIRect::MakeWH(clip.width(), clip.height()));
+            result->draw(&canvas, offset.fX - clip.fLeft, offset.fY - clip.fTop);
+        }
+        return bm;
+    };
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (size_t i = 0; i < SK_ARRAY_COUNT(filters); ++i) {
+        SkBitmap whole = filterImage(filters[i].get(), false, nullptr);
+        for (SkExecutor* e : {(SkExecutor*)nullptr, executor.get()}) {
+            SkBitmap tiled = filterImage(filters[i].get(), true, e);
+            for (int y = 0; y < clip.height(); ++y) {
+                if (memcmp(whole.getAddr32(0, y), tiled.getAddr32(0, y), clip.width() * 4)) {
+                    ERRORF(reporter, "filter %zu, %s, row %d differs", i,
+                           e ? "threaded" : "serial", y);
+                    break;
+                }
+            }
+        }
+    }
+}
+
 DEF_TEST(ImageFilterCropRect, reporter) {
     test_cropRects(reporter, nullptr);
 }
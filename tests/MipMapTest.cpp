@@ -6,6 +6,7 @@
  */
 
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "include/utils/SkRandom.h"
 #include "src/core/SkMipmap.h"
 #include "tests/Test.h"
@@ -211,6 +212,106 @@ DEF_TEST(MipMap_F16, reporter) {
     sk_sp<SkMipmap> mipmap(SkMipmap::Build(bmp, nullptr));
 }
 
+// The vectorized 2x2 and 3x3 filters must give the same results as filtering each channel of
+// each pixel on its own.
+static void fill_random(SkBitmap* bm, SkRandom* rand) {
+    for (int y = 0; y < bm->height(); ++y) {
+        auto row = (uint8_t*)bm->getAddr(0, y);
+        for (size_t i = 0; i < bm->info().minRowBytes(); ++i) {
+            row[i] = (uint8_t)rand->nextU();
+        }
+    }
+}
+
+static uint32_t filter_channel(const SkPixmap& src, int dstX, int dstY, int shift, int bits) {
+    static const int kWeights2[] = {1, 1},
+                     kWeights3[] = {1, 2, 1};
+    const int* wx = (src.width()  & 1) ? kWeights3 : kWeights2;
+    const int* wy = (src.height() & 1) ? kWeights3 : kWeights2;
+    const int nx = (src.width()  & 1) ? 3 : 2,
+              ny = (src.height() & 1) ? 3 : 2;
+
+    uint32_t sum = 0;
+    for (int y = 0; y < ny; ++y)
+    for (int x = 0; x < nx; ++x) {
+        uint32_t pixel = src.info().bytesPerPixel() == 1 ? *src.addr8(2*dstX + x, 2*dstY + y)
+                                                         : *src.addr32(2*dstX + x, 2*dstY + y);
+        sum += wx[x] * wy[y] * ((pixel >> shift) & ((1 << bits) - 1));
+    }
+    // The weights add up to 4, 8, or 16.
+    return sum >> ((nx - 1) + (ny - 1));
+}
+
+DEF_TEST(MipMap_Filters, reporter) {
+    struct {
+        SkColorType fColorType;
+        int         fChannelBits[4];
+    } gTests[] = {
+        { kRGBA_8888_SkColorType,    { 8,  8,  8, 8} },
+        { kBGRA_8888_SkColorType,    { 8,  8,  8, 8} },
+        { kAlpha_8_SkColorType,      { 8,  0,  0, 0} },
+        { kRGBA_1010102_SkColorType, {10, 10, 10, 2} },
+    };
+    // Even and odd sizes, and sizes that do and don't fill whole vectors.
+    const SkISize kSizes[] = { {64, 48}, {65, 49}, {38, 6}, {35, 7}, {130, 3} };
+
+    SkRandom rand;
+    for (const auto& test : gTests) {
+        for (SkISize size : kSizes) {
+            SkBitmap bm;
+            bm.allocPixels(SkImageInfo::Make(size, test.fColorType, kPremul_SkAlphaType));
+            fill_random(&bm, &rand);
+            sk_sp<SkMipmap> mm(SkMipmap::Build(bm, nullptr));
+
+            SkMipmap::Level level;
+            REPORTER_ASSERT(reporter, mm && mm->getLevel(0, &level));
+            const SkPixmap& dst = level.fPixmap;
+            for (int y = 0; y < dst.height(); ++y)
+            for (int x = 0; x < dst.width(); ++x) {
+                uint32_t expected = 0;
+                for (int c = 0, shift = 0; c < 4 && test.fChannelBits[c]; ++c) {
+                    expected |= filter_channel(bm.pixmap(), x, y, shift, test.fChannelBits[c])
+                             << shift;
+                    shift += test.fChannelBits[c];
+                }
+                uint32_t actual = dst.info().bytesPerPixel() == 1 ? *dst.addr8(x, y)
+                                                                  : *dst.addr32(x, y);
+                if (actual != expected) {
+                    ERRORF(reporter, "color type %d, %dx%d: (%d,%d) is %08x, expected %08x",
+                           test.fColorType, size.width(), size.height(), x, y, actual, expected);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+DEF_TEST(MipMap_Executor, reporter) {
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    SkRandom rand;
+    for (SkColorType ct : {kN32_SkColorType, kAlpha_8_SkColorType, kRGBA_F16_SkColorType}) {
+        SkBitmap bm;
+        bm.allocPixels(SkImageInfo::Make(1031, 777, ct, kPremul_SkAlphaType));
+        bm.eraseColor(SK_ColorBLUE);
+        bm.erase(SK_ColorRED, SkIRect::MakeXYWH(rand.nextULessThan(1000),
+                                                rand.nextULessThan(700), 20, 50));
+
+        sk_sp<SkMipmap> serial(SkMipmap::Build(bm.pixmap(), nullptr)),
+                        striped(SkMipmap::Build(bm.pixmap(), nullptr, true, executor.get()));
+        REPORTER_ASSERT(reporter, serial->countLevels() == striped->countLevels());
+        for (int i = 0; i < serial->countLevels(); ++i) {
+            SkMipmap::Level a, b;
+            serial->getLevel(i, &a);
+            striped->getLevel(i, &b);
+            for (int y = 0; y < a.fPixmap.height(); ++y) {
+                REPORTER_ASSERT(reporter, 0 == memcmp(a.fPixmap.addr(0, y), b.fPixmap.addr(0, y),
+                                                      a.fPixmap.info().minRowBytes()));
+            }
+        }
+    }
+}
+
 #include "include/core/SkCanvas.h"
 #include "include/core/SkSurface.h"
 #include "src/core/SkMipmapBuilder.h"
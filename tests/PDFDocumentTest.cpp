@@ -256,3 +256,93 @@ DEF_TEST(SkPDF_abort_jobs, rep) {
     doc->abort();
 }
 
+
+// Work done on the executor must not change the output, whatever the number of threads.
+DEF_TEST(SkPDF_executor_reproducible, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_executor_reproducible, r);
+    SkBitmap opaque, translucent;
+    opaque.allocN32Pixels(200, 100);
+    opaque.eraseColor(0xFF4F9643);
+    translucent.allocN32Pixels(100, 200);
+    translucent.eraseColor(0x804F9643);
+
+    auto make_pdf = [&](int threads) {
+        SkPDF::Metadata metadata;
+        metadata.fCreation = {0, 2021, 6, 1, 1, 0, 0, 0};
+        std::unique_ptr<SkExecutor> executor;
+        if (threads > 0) {
+            executor = SkExecutor::MakeFIFOThreadPool(threads);
+            metadata.fExecutor = executor.get();
+            // A small budget makes the document wait on its jobs.
+            metadata.fExecutorMemoryBudget = 64 * 1024;
+        }
+        SkDynamicMemoryWStream stream;
+        auto doc = SkPDF::MakeDocument(&stream, metadata);
+        for (int i = 0; i < 20; ++i) {
+            SkCanvas* canvas = doc->beginPage(612, 792);
+            canvas->drawImage(opaque.asImage(), 10, 10);
+            canvas->drawImage(translucent.asImage(), 300, 10);
+            canvas->drawString("Hello, PDF", 20, 400,
+                               SkFont(ToolUtils::create_portable_typeface(), 24), SkPaint());
+            doc->endPage();
+        }
+        doc->close();
+        return stream.detachAsData();
+    };
+
+    sk_sp<SkData> oneThread = make_pdf(1);
+    REPORTER_ASSERT(r, oneThread->size() > 0);
+    REPORTER_ASSERT(r, oneThread->equals(make_pdf(4).get()));
+    REPORTER_ASSERT(r, oneThread->equals(make_pdf(8).get()));
+}
+
+static int count(const SkData& data, const char expectation[]) {
+    const uint8_t* bytes = data.bytes();
+    size_t len = strlen(expectation);
+    int n = 0;
+    for (size_t i = 0; i + len <= data.size(); ++i) {
+        n += 0 == memcmp(bytes + i, expectation, len);
+    }
+    return n;
+}
+
+// In streaming mode each page is written when it ends, and fonts are flushed once the
+// document holds more than fStreamingMemoryBudget bytes between pages.
+DEF_TEST(SkPDF_streaming, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_streaming, r);
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(200, 100);
+    bitmap.eraseColor(0xFF4F9643);
+    sk_sp<SkImage> image = bitmap.asImage();
+
+    auto make_pdf = [&](size_t budget) {
+        SkPDF::Metadata metadata;
+        metadata.fStreamingMemoryBudget = budget;
+        SkDynamicMemoryWStream stream;
+        auto doc = SkPDF::MakeDocument(&stream, metadata);
+        for (int i = 0; i < 20; ++i) {
+            SkCanvas* canvas = doc->beginPage(612, 792);
+            canvas->drawImage(image, 10, 10);
+            canvas->drawString("Hello, PDF", 20, 400,
+                               SkFont(ToolUtils::create_portable_typeface(), 24), SkPaint());
+            doc->endPage();
+        }
+        doc->close();
+        return stream.detachAsData();
+    };
+
+    sk_sp<SkData> retained = make_pdf(0);
+    sk_sp<SkData> unbounded = make_pdf(SIZE_MAX);
+    sk_sp<SkData> flushEveryPage = make_pdf(1);
+    for (const sk_sp<SkData>& pdf : {retained, unbounded, flushEveryPage}) {
+        REPORTER_ASSERT(r, count(*pdf, "/Type /Page\n") == 20);
+        REPORTER_ASSERT(r, count(*pdf, "/Count 20") == 1);
+        REPORTER_ASSERT(r, count(*pdf, "%%EOF") == 1);
+    }
+    // Without a flush, streaming shares fonts and images exactly like the default mode.
+    REPORTER_ASSERT(r, count(*unbounded, "/Type /Font\n") == count(*retained, "/Type /Font\n"));
+    REPORTER_ASSERT(r, count(*unbounded, "/Subtype /Image") == 1);
+    REPORTER_ASSERT(r, count(*flushEveryPage, "/Subtype /Image") == 20);
+    REPORTER_ASSERT(r, count(*flushEveryPage, "/Type /Font\n") >
+                       count(*retained, "/Type /Font\n"));
+}
@@ -23,8 +23,11 @@
 #include "include/core/SkScalar.h"
 #include "include/core/SkShader.h"
 #include "include/core/SkStream.h"
+#include "include/core/SkSurface.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
+#include "include/effects/SkGradientShader.h"
+#include "include/effects/SkImageFilters.h"
 #include "include/utils/SkRandom.h"
 #include "src/core/SkBigPicture.h"
 #include "src/core/SkClipOpPriv.h"
@@ -32,6 +35,7 @@
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkRectPriv.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 
 #include <memory>
 
@@ -998,3 +1002,64 @@ DEF_TEST(Picture_nested_op_count, r) {
     check(make_pic(10, leaf1),  10,  10);
     check(make_pic(10, leaf10), 10, 100);
 }
+
+DEF_TEST(Picture_parallelPlayback, r) {
+    const SkRect cull = {0, 0, 1000, 700};
+
+    SkRTreeFactory factory;
+    SkPictureRecorder rec;
+    SkCanvas* c = rec.beginRecording(cull, &factory);
+
+    SkRandom rand;
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    for (int i = 0; i < 200; i++) {
+        paint.setColor(rand.nextU() | 0x80000000);
+        SkRect rect = SkRect::MakeXYWH(rand.nextRangeF(-50, 950), rand.nextRangeF(-50, 650),
+                                       rand.nextRangeF(5, 300), rand.nextRangeF(5, 300));
+        if (i % 2) {
+            c->drawOval(rect, paint);
+        } else {
+            c->drawRect(rect, paint);
+        }
+    }
+
+    // Dithering depends on device coordinates, so this catches tiles drawn at the wrong origin.
+    const SkPoint pts[] = {{0, 0}, {1000, 700}};
+    const SkColor colors[] = {SK_ColorRED, SK_ColorBLUE};
+    SkPaint gradient;
+    gradient.setDither(true);
+    gradient.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, 2,
+                                                    SkTileMode::kClamp));
+    c->save();
+    c->rotate(10);
+    c->drawRect({100, 100, 900, 300}, gradient);
+    c->restore();
+
+    // Image filters need input from outside a tile's bounds.
+    SkPaint layerPaint;
+    layerPaint.setImageFilter(SkImageFilters::Blur(8, 8, nullptr));
+    c->saveLayer(nullptr, &layerPaint);
+    paint.setColor(SK_ColorGREEN);
+    c->drawCircle(256, 256, 60, paint);
+    c->restore();
+
+    sk_sp<SkPicture> pic = rec.finishRecordingAsPicture();
+
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(1000, 700);
+    const SkSurfaceProps parallel(SkSurfaceProps::kParallelPicturePlayback_Flag,
+                                  kUnknown_SkPixelGeometry);
+    auto serialSurface   = SkSurface::MakeRaster(info),
+         parallelSurface = SkSurface::MakeRaster(info, &parallel);
+
+    for (auto surface : {serialSurface, parallelSurface}) {
+        surface->getCanvas()->clear(SK_ColorWHITE);
+        surface->getCanvas()->clipRect({10, 20, 990, 690});
+        surface->getCanvas()->drawPicture(pic);
+    }
+
+    SkPixmap serialPixels, parallelPixels;
+    REPORTER_ASSERT(r, serialSurface->peekPixels(&serialPixels));
+    REPORTER_ASSERT(r, parallelSurface->peekPixels(&parallelPixels));
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(serialPixels, parallelPixels));
+}
@@ -16,7 +16,9 @@
 #include "tools/Resources.h"
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <vector>
 
 namespace {
 struct RunHandler final : public SkShaper::RunHandler {
@@ -91,8 +93,53 @@ void cluster_test(skiatest::Reporter* reporter, const char* resource) {
     shaper_test(reporter, resource, data.get());
 }
 
+// Everything the shaper produced, in order.
+struct RecordingRunHandler final : public SkShaper::RunHandler {
+    std::vector<SkGlyphID> fGlyphs;
+    std::vector<SkPoint> fPositions;
+    std::vector<uint32_t> fClusters;
+    std::vector<size_t> fRangeBegins;
+    size_t fRunStart = 0;
+
+    void beginLine() override {}
+    void runInfo(const RunInfo&) override {}
+    void commitRunInfo() override {}
+    Buffer runBuffer(const RunInfo& info) override {
+        fRunStart = fGlyphs.size();
+        fGlyphs.resize(fRunStart + info.glyphCount);
+        fPositions.resize(fRunStart + info.glyphCount);
+        fClusters.resize(fRunStart + info.glyphCount);
+        fRangeBegins.push_back(info.utf8Range.begin());
+        return {fGlyphs.data() + fRunStart, fPositions.data() + fRunStart, nullptr,
+                fClusters.data() + fRunStart, {0, 0}};
+    }
+    void commitRunBuffer(const RunInfo&) override {}
+    void commitLine() override {}
+};
+
 }  // namespace
 
+DEF_TEST(Shaper_run_cache, reporter) {
+    auto shaper = SkShaper::Make();
+    if (!shaper) {
+        ERRORF(reporter, "Could not create shaper.");
+        return;
+    }
+    SkFont font(SkTypeface::MakeDefault());
+    // Short runs are shaped once and then found in the cache; the results must not change.
+    for (const char* text : { "OK", "Cancel", "1,234", "abc \u05e9\u05dc\u05d5\u05dd abc",
+                              "\u0645\u0631\u062d\u0628\u0627" }) {
+        SkShaper::PurgeCaches();
+        RecordingRunHandler shaped, cached;
+        shaper->shape(text, strlen(text), font, true, 400, &shaped);
+        shaper->shape(text, strlen(text), font, true, 400, &cached);
+        REPORTER_ASSERT(reporter, shaped.fGlyphs == cached.fGlyphs, "%s", text);
+        REPORTER_ASSERT(reporter, shaped.fPositions == cached.fPositions, "%s", text);
+        REPORTER_ASSERT(reporter, shaped.fClusters == cached.fClusters, "%s", text);
+        REPORTER_ASSERT(reporter, shaped.fRangeBegins == cached.fRangeBegins, "%s", text);
+    }
+}
+
 DEF_TEST(Shaper_cluster_empty, r) { shaper_test(r, "empty", SkData::MakeEmpty().get()); }
 
 #define SHAPER_TEST(X) DEF_TEST(Shaper_cluster_ ## X, r) { cluster_test(r, "text/" #X ".txt"); }
@@ -566,3 +566,122 @@ DEF_TEST(SkRasterPipeline_lowp_clamp01, r) {
     p.append(SkRasterPipeline::store_8888, &ptr);
     p.run(0,0,1,1);
 }
+
+DEF_TEST(SkRasterPipeline_lowp_sampling, r) {
+    // Lowp image sampling should closely match highp for each of the stages SkImageShader uses
+    // for 8888 images, under a scale+rotate.  Lowp bilinear filtering is within 1 of exact,
+    // and highp can round the other way, so we allow 2.  Nearest sampling should match exactly.
+
+    constexpr int kW = 7, kH = 5;
+    uint32_t src[kW*kH];
+    for (int i = 0; i < kW*kH; i++) {
+        src[i] = 0x9e3779b9 * (i+1);
+    }
+
+    SkRasterPipeline_GatherCtx gather;
+    gather.pixels = src;
+    gather.stride = kW;
+    gather.width  = kW;
+    gather.height = kH;
+
+    SkRasterPipeline_TileCtx limit_x = { kW, 1.0f/kW },
+                             limit_y = { kH, 1.0f/kH };
+
+    const float m[] = { 0.35f, 0.2f, -0.2f, 0.35f, -1.3f, -0.7f };
+
+    constexpr int kDstW = 24, kDstH = 6;
+    uint32_t dst[kDstW*kDstH];
+    SkRasterPipeline_MemoryCtx dst_ctx = { dst, kDstW };
+
+    auto compare = [&](const char* name, auto append_sampler, int tolerance) {
+        SkRasterPipeline_<256> p;
+        p.append(SkRasterPipeline::seed_shader);
+        p.append(SkRasterPipeline::matrix_2x3, const_cast<float*>(m));
+        append_sampler(&p);
+        p.append(SkRasterPipeline::store_8888, &dst_ctx);
+
+        uint32_t lowp[kDstW*kDstH];
+        p.run(0,0,kDstW,kDstH);
+        memcpy(lowp, dst, sizeof(dst));
+
+        p.forceHighp();
+        p.run(0,0,kDstW,kDstH);
+
+        for (int i = 0; i < kDstW*kDstH; i++) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                int lo = (lowp[i] >> shift) & 0xff,
+                    hi = (dst [i] >> shift) & 0xff;
+                if (abs(lo - hi) > tolerance) {
+                    ERRORF(r, "%s: pixel %d, lowp %08x vs highp %08x", name, i, lowp[i], dst[i]);
+                    return;
+                }
+            }
+        }
+    };
+
+    compare("bilerp_clamp_8888", [&](SkRasterPipeline* p) {
+        p->append(SkRasterPipeline::bilerp_clamp_8888, &gather);
+    }, 2);
+
+    for (SkTileMode tile : {SkTileMode::kClamp, SkTileMode::kRepeat, SkTileMode::kMirror}) {
+        for (SkColorType ct : {kRGBA_8888_SkColorType, kBGRA_8888_SkColorType}) {
+            SkRasterPipeline_SamplerCtx2 ctx;
+            *(SkRasterPipeline_GatherCtx*)(&ctx) = gather;
+            ctx.ct        = ct;
+            ctx.tileX     = tile;
+            ctx.tileY     = tile;
+            ctx.invWidth  = 1.0f / kW;
+            ctx.invHeight = 1.0f / kH;
+            compare("bilinear", [&](SkRasterPipeline* p) {
+                p->append(SkRasterPipeline::bilinear, &ctx);
+            }, 2);
+        }
+    }
+
+    compare("repeat_x/mirror_y + gather_8888", [&](SkRasterPipeline* p) {
+        p->append(SkRasterPipeline::repeat_x, &limit_x);
+        p->append(SkRasterPipeline::mirror_y, &limit_y);
+        p->append(SkRasterPipeline::gather_8888, &gather);
+    }, 0);
+    compare("mirror_x/repeat_y + gather_8888", [&](SkRasterPipeline* p) {
+        p->append(SkRasterPipeline::mirror_x, &limit_x);
+        p->append(SkRasterPipeline::repeat_y, &limit_y);
+        p->append(SkRasterPipeline::gather_8888, &gather);
+    }, 0);
+}
+
+DEF_TEST(SkRasterPipeline_bilinear_non8888, r) {
+    // Lowp bilinear only samples 8888 images, so other color types must build a highp pipeline,
+    // drawing exactly what a pipeline forced to highp draws.
+    uint16_t src[4] = { 0xffff, 0x1234, 0xf00f, 0x0ff0 };
+    SkRasterPipeline_SamplerCtx2 ctx;
+    ctx.pixels    = src;
+    ctx.stride    = 2;
+    ctx.width     = 2;
+    ctx.height    = 2;
+    ctx.ct        = kRGB_565_SkColorType;
+    ctx.tileX     = SkTileMode::kRepeat;
+    ctx.tileY     = SkTileMode::kRepeat;
+    ctx.invWidth  = 0.5f;
+    ctx.invHeight = 0.5f;
+
+    uint32_t dst[4];
+    SkRasterPipeline_MemoryCtx dst_ctx = { dst, 4 };
+
+    auto run = [&](bool forceHighp) {
+        SkRasterPipeline_<256> p;
+        p.append(SkRasterPipeline::seed_shader);
+        p.append(SkRasterPipeline::bilinear, &ctx);
+        p.append(SkRasterPipeline::store_8888, &dst_ctx);
+        if (forceHighp) {
+            p.forceHighp();
+        }
+        p.run(0,0,4,1);
+    };
+
+    uint32_t highp[4];
+    run(true);
+    memcpy(highp, dst, sizeof(dst));
+    run(false);
+    REPORTER_ASSERT(r, 0 == memcmp(highp, dst, sizeof(dst)));
+}
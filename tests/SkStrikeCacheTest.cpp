@@ -7,9 +7,18 @@
 
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeSpec.h"
+#include "src/core/SkStrikeStore.h"
+#include "src/core/SkTaskGroup.h"
+#include "src/utils/SkOSPath.h"
 #include "tests/Test.h"
+#include "tools/Resources.h"
 #include "tools/ToolUtils.h"
 
+#include "include/core/SkExecutor.h"
+
+#include <thread>
+#include <vector>
+
 DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
     SkStrikeCache cache;
 
@@ -51,3 +60,224 @@ DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
 
 
 }
+
+DEF_TEST(SkStrikeCache_Threaded, Reporter) {
+    SkStrikeCache cache;
+
+    sk_sp<SkTypeface> typeface =
+            ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic());
+
+    // Many threads finding, creating, and growing strikes across all the shards at once,
+    // with a budget small enough that they're purging each other's strikes too.
+    cache.setCacheCountLimit(8);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&, t] {
+            SkFont font;
+            font.setEdging(SkFont::Edging::kAntiAlias);
+            font.setTypeface(typeface);
+            SkPaint defaultPaint;
+            for (int i = 0; i < 200; i++) {
+                font.setSize(8 + (i + t) % 24);
+                SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+                        font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                        SkScalerContextFlags::kNone, SkMatrix::I());
+                sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(&cache);
+
+                SkGlyphID glyphs[] = { font.unicharToGlyph('A' + i % 26) };
+                const SkGlyph* results[1];
+                strike->metrics(SkMakeSpan(glyphs), results);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Once everyone is done, the budgets hold again.
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() <= 8);
+    size_t used = cache.getTotalMemoryUsed();
+    cache.setCacheSizeLimit(used / 2);
+    REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() <= used / 2);
+
+    cache.purgeAll();
+    REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() == 0);
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == 0);
+}
+
+DEF_TEST(SkStrikeCache_Prewarm, Reporter) {
+    SkStrikeCache cache;
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    SkFont font;
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSubpixel(true);
+    font.setTypeface(ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic()));
+
+    SkGlyphID glyphs[26];
+    for (int i = 0; i < 26; i++) {
+        glyphs[i] = font.unicharToGlyph('a' + i);
+    }
+
+    SkPaint defaultPaint;
+    std::vector<SkStrikeSpec> specs;
+    {
+        SkTaskGroup group(*executor);
+        for (int size = 10; size < 18; size++) {
+            font.setSize(size);
+            specs.push_back(SkStrikeSpec::MakeMask(
+                    font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                    SkScalerContextFlags::kNone, SkMatrix::I()));
+            cache.prewarm(specs.back(), SkMakeSpan(glyphs), &group);
+        }
+        group.wait();
+    }
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == (int)specs.size());
+
+    // Everything drawing would ask for is already there, so nothing more is made.
+    const size_t warmed = cache.getTotalMemoryUsed();
+    for (const SkStrikeSpec& spec : specs) {
+        sk_sp<SkStrike> strike = spec.findOrCreateStrike(&cache);
+        const SkGlyph* results[26];
+        strike->metrics(SkMakeSpan(glyphs), results);
+        strike->preparePaths(SkMakeSpan(glyphs), results);
+
+        SkPackedGlyphID packed[26];
+        for (int i = 0; i < 26; i++) {
+            packed[i] = SkPackedGlyphID{glyphs[i], SkPoint{0.25f * (i % 4), 0},
+                                        SkPackedGlyphID::kXYFieldMask};
+        }
+        strike->prepareImages(SkMakeSpan(packed), results);
+    }
+    REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() == warmed);
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == (int)specs.size());
+
+    // Without sub-pixel positions, only the one image per glyph that drawing uses is made.
+    font.setSubpixel(false);
+    SkStrikeSpec spec = SkStrikeSpec::MakeMask(
+            font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+    SkStrikeCache warmedCache, drawnCache;
+    {
+        SkTaskGroup group(*executor);
+        warmedCache.prewarm(spec, SkMakeSpan(glyphs), &group);
+        group.wait();
+    }
+    {
+        sk_sp<SkStrike> strike = spec.findOrCreateStrike(&drawnCache);
+        const SkGlyph* results[26];
+        strike->preparePaths(SkMakeSpan(glyphs), results);
+        SkPackedGlyphID packed[26];
+        for (int i = 0; i < 26; i++) {
+            packed[i] = SkPackedGlyphID{glyphs[i]};
+        }
+        strike->prepareImages(SkMakeSpan(packed), results);
+    }
+    REPORTER_ASSERT(Reporter,
+                    warmedCache.getTotalMemoryUsed() == drawnCache.getTotalMemoryUsed());
+}
+
+DEF_TEST(SkStrikeCache_Store, Reporter) {
+    // Two typefaces made from the same font, as two processes would each have.
+    sk_sp<SkTypeface> writerTypeface = MakeResourceAsTypeface("fonts/Em.ttf"),
+                      readerTypeface = MakeResourceAsTypeface("fonts/Em.ttf");
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (!writerTypeface || !readerTypeface || tmpDir.isEmpty()) {
+        return;
+    }
+    SkString path = SkOSPath::Join(tmpDir.c_str(), "strike_store");
+
+    auto spec_for = [](sk_sp<SkTypeface> typeface) {
+        SkFont font(std::move(typeface), 24);
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        SkPaint defaultPaint;
+        return SkStrikeSpec::MakeMask(
+                font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                SkScalerContextFlags::kNone, SkMatrix::I());
+    };
+
+    SkGlyphID glyphs[] = { 0, 1, 2, 3, 4 };
+    SkPackedGlyphID packed[SK_ARRAY_COUNT(glyphs)];
+    for (size_t i = 0; i < SK_ARRAY_COUNT(glyphs); i++) {
+        packed[i] = SkPackedGlyphID{glyphs[i]};
+    }
+    const SkGlyph* written[SK_ARRAY_COUNT(glyphs)];
+    SkStrikeCache writer;
+    sk_sp<SkStrike> writerStrike = spec_for(writerTypeface).findOrCreateStrike(&writer);
+    writerStrike->preparePaths(SkMakeSpan(glyphs), written);
+    writerStrike->prepareImages(SkMakeSpan(packed), written);
+    REPORTER_ASSERT(Reporter, SkStrikeStore::Write(writer, path.c_str()));
+
+    sk_sp<SkStrikeStore> store = SkStrikeStore::Make(path.c_str());
+    REPORTER_ASSERT(Reporter, store && store->count() == 1);
+    if (!store) {
+        return;
+    }
+
+    // The reader's strike starts out with every glyph the writer had, so looking them up
+    // doesn't make anything new.
+    SkStrikeCache reader;
+    reader.setStrikeStore(store);
+    sk_sp<SkStrike> readerStrike = spec_for(readerTypeface).findOrCreateStrike(&reader);
+    REPORTER_ASSERT(Reporter, readerStrike->fScalerCache.countCachedGlyphs() ==
+                              writerStrike->fScalerCache.countCachedGlyphs());
+    const size_t loaded = reader.getTotalMemoryUsed();
+    const SkGlyph* read[SK_ARRAY_COUNT(glyphs)];
+    readerStrike->preparePaths(SkMakeSpan(glyphs), read);
+    readerStrike->prepareImages(SkMakeSpan(packed), read);
+    REPORTER_ASSERT(Reporter, reader.getTotalMemoryUsed() == loaded);
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(glyphs); i++) {
+        REPORTER_ASSERT(Reporter, read[i]->iRect() == written[i]->iRect());
+        REPORTER_ASSERT(Reporter, read[i]->advanceX() == written[i]->advanceX());
+        REPORTER_ASSERT(Reporter, (read[i]->path() == nullptr) == (written[i]->path() == nullptr));
+        if (read[i]->path()) {
+            REPORTER_ASSERT(Reporter, *read[i]->path() == *written[i]->path());
+        }
+        if (!written[i]->isEmpty()) {
+            REPORTER_ASSERT(Reporter, 0 == memcmp(read[i]->image(), written[i]->image(),
+                                                  written[i]->imageSize()));
+        }
+    }
+
+    sk_sp<SkData> file = SkData::MakeFromFileName(path.c_str());
+    REPORTER_ASSERT(Reporter, file && file->size() > 64);
+    if (!file) {
+        return;
+    }
+
+    // A strike whose data doesn't match its checksum is ignored, and made from scratch.
+    {
+        sk_sp<SkData> corrupt = SkData::MakeWithCopy(file->data(), file->size());
+        static_cast<uint8_t*>(corrupt->writable_data())[corrupt->size() - 1] ^= 0xff;
+        SkStrikeCache cache;
+        cache.setStrikeStore(SkStrikeStore::Make(corrupt));
+        sk_sp<SkStrike> strike = spec_for(readerTypeface).findOrCreateStrike(&cache);
+        REPORTER_ASSERT(Reporter, strike->fScalerCache.countCachedGlyphs() == 0);
+
+        // The failed check is remembered, and still ignores the strike once it's been purged.
+        strike.reset();
+        cache.purgeAll();
+        strike = spec_for(readerTypeface).findOrCreateStrike(&cache);
+        REPORTER_ASSERT(Reporter, strike->fScalerCache.countCachedGlyphs() == 0);
+    }
+
+    // Files from another version or milestone, or that aren't strike stores at all, are
+    // rejected outright.
+    for (int word : {1, 2}) {
+        sk_sp<SkData> otherVersion = SkData::MakeWithCopy(file->data(), file->size());
+        static_cast<uint32_t*>(otherVersion->writable_data())[word] += 1;
+        REPORTER_ASSERT(Reporter, !SkStrikeStore::Make(otherVersion));
+    }
+    sk_sp<SkData> garbage = SkData::MakeWithCString(
+            "not a strike store, but long enough to have a header");
+    REPORTER_ASSERT(Reporter, !SkStrikeStore::Make(garbage));
+
+    // Saving over the file leaves stores already made from it working.
+    REPORTER_ASSERT(Reporter, SkStrikeStore::Write(writer, path.c_str()));
+    SkStrikeCache another;
+    another.setStrikeStore(store);
+    sk_sp<SkStrike> again = spec_for(readerTypeface).findOrCreateStrike(&another);
+    REPORTER_ASSERT(Reporter, again->fScalerCache.countCachedGlyphs() ==
+                              writerStrike->fScalerCache.countCachedGlyphs());
+}
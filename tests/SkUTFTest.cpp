@@ -1,9 +1,15 @@
 // Copyright 2018 Google LLC.
 // Use of this source code is governed by a BSD-style license that can be found in the LICENSE file.
 
+#include "include/utils/SkRandom.h"
+#include "src/core/SkOpts.h"
 #include "src/utils/SkUTF.h"
 #include "tests/Test.h"
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 DEF_TEST(SkUTF_UTF16, reporter) {
     // Test non-basic-multilingual-plane unicode.
     static const SkUnichar gUni[] = {
@@ -140,3 +146,56 @@ DEF_TEST(SkUTF_NextUTF8_ToUTF8, r) {
 #undef LEADING_THREE_BYTE
 #undef LEADING_FOUR_BYTE
 #undef INVALID_BYTE
+
+// SkOpts decodes whole vectors of ASCII (or surrogate-free UTF-16) at once; check it against
+// decoding one code point at a time, across vector boundaries and with invalid sequences.
+DEF_TEST(SkUTF_Opts, r) {
+    static const char* gPieces[] = {
+        "a", "hello, ", "0123456789abcdef0123456789abcdef", "\xC3\xA9", "\xE4\xB8\xAD",
+        "\xF0\x9F\x98\x80", "\xA1", "\xFC", "\xE4\xB8",
+    };
+    constexpr int kValidPieces = 6;
+
+    SkRandom rand;
+    for (int trial = 0; trial < 2000; ++trial) {
+        // Mostly valid text, with an invalid piece now and then.
+        std::string utf8;
+        for (int n = rand.nextULessThan(40); n > 0; --n) {
+            int piece = rand.nextULessThan(rand.nextULessThan(8) ? kValidPieces
+                                                                 : SK_ARRAY_COUNT(gPieces));
+            utf8 += gPieces[piece];
+        }
+
+        std::vector<SkUnichar> expected;
+        const char* ptr = utf8.data();
+        const char* end = ptr + utf8.size();
+        while (ptr < end) {
+            expected.push_back(SkUTF::NextUTF8(&ptr, end));
+        }
+        REPORTER_ASSERT(r, SkOpts::count_utf8(utf8.data(), utf8.size()) ==
+                           SkUTF::CountUTF8(utf8.data(), utf8.size()));
+        std::vector<SkUnichar> actual(utf8.size());
+        int count = SkOpts::utf8_to_utf32(utf8.data(), utf8.size(), actual.data());
+        REPORTER_ASSERT(r, count == (int)expected.size());
+        REPORTER_ASSERT(r, std::equal(expected.begin(), expected.end(), actual.begin()));
+
+        // UTF-16 with an occasional (possibly unpaired) surrogate.
+        std::vector<uint16_t> utf16(rand.nextULessThan(40));
+        for (uint16_t& unit : utf16) {
+            unit = rand.nextULessThan(6) ? rand.nextULessThan(0xD000)
+                                         : 0xD800 + rand.nextULessThan(0x800);
+        }
+        const size_t byteLength = utf16.size() * sizeof(uint16_t);
+        std::vector<SkUnichar> expected16;
+        const uint16_t* ptr16 = utf16.data();
+        const uint16_t* end16 = ptr16 + utf16.size();
+        while (ptr16 < end16) {
+            expected16.push_back(SkUTF::NextUTF16(&ptr16, end16));
+        }
+        std::vector<SkUnichar> actual16(utf16.size());
+        count = SkOpts::utf16_to_utf32(utf16.data(), byteLength, actual16.data());
+        REPORTER_ASSERT(r, count == (int)expected16.size());
+        REPORTER_ASSERT(r, std::equal(expected16.begin(), expected16.end(), actual16.begin()));
+    }
+    REPORTER_ASSERT(r, SkOpts::count_utf8(nullptr, 0) == -1);
+}
@@ -6,12 +6,17 @@
  */
 
 #include "include/core/SkColorPriv.h"
+#include "include/core/SkData.h"
+#include "include/core/SkStream.h"
 #include "include/private/SkColorData.h"
 #include "src/core/SkCpu.h"
 #include "src/core/SkMSAN.h"
 #include "src/core/SkVM.h"
+#include "src/utils/SkOSPath.h"
 #include "tests/Test.h"
 
+extern bool gSkVMAllowAVX512;
+
 template <typename Fn>
 static void test_jit_and_interpreter(const skvm::Builder& b, Fn&& test) {
     skvm::Program p = b.done();
@@ -107,6 +112,66 @@ DEF_TEST(SkVM_allow_jit, r) {
     }
 }
 
+DEF_TEST(SkVM_jit_cache, r) {
+    skvm::Builder b;
+    {
+        auto src = b.varying<int>(),
+             dst = b.varying<int>();
+        b.store32(dst, b.add(b.load32(src), b.splat(0x5c3e)));
+    }
+    if (!b.done().hasJIT()) {
+        return;
+    }
+
+    auto check = [&](const skvm::Program& p) {
+        int src[] = {1,2,3,4,5,6,7,8,9},
+            dst[] = {0,0,0,0,0,0,0,0,0};
+        p.eval(SK_ARRAY_COUNT(src), src, dst);
+        for (size_t i = 0; i < SK_ARRAY_COUNT(src); i++) {
+            REPORTER_ASSERT(r, dst[i] == src[i] + 0x5c3e);
+        }
+    };
+
+    // The same program again should come out of the cache.
+    const int hits = skvm::jit_cache_stats().hits;
+    skvm::Program cached = b.done();
+    REPORTER_ASSERT(r, cached.hasJIT());
+    REPORTER_ASSERT(r, skvm::jit_cache_stats().hits > hits);
+    check(cached);
+
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString path = SkOSPath::Join(tmpDir.c_str(), "skvm_jit_cache");
+    REPORTER_ASSERT(r, skvm::save_jit_cache(path.c_str()));
+    REPORTER_ASSERT(r, skvm::load_jit_cache(path.c_str()));
+    // Saving over a loaded (mapped) file must not disturb the code loaded from it.
+    REPORTER_ASSERT(r, skvm::save_jit_cache(path.c_str()));
+    check(b.done());
+
+    // A file saved by a build whose JIT emits different code is rejected.  The fingerprint
+    // follows the magic, version and CPU features in the header.
+    REPORTER_ASSERT(r, skvm::Program::JITFingerprint() != 0);
+    {
+        sk_sp<SkData> saved = SkData::MakeFromFileName(path.c_str());
+        REPORTER_ASSERT(r, saved && saved->size() > 24);
+        sk_sp<SkData> other = SkData::MakeWithCopy(saved->data(), saved->size());
+        static_cast<uint8_t*>(other->writable_data())[16] ^= 1;
+        saved.reset();
+        SkFILEWStream file(path.c_str());
+        file.write(other->data(), other->size());
+    }
+    REPORTER_ASSERT(r, !skvm::load_jit_cache(path.c_str()));
+
+    // Anything that isn't a cache file saved by this build is rejected.
+    {
+        SkFILEWStream file(path.c_str());
+        file.writeText("not a JIT cache, but long enough to have a header");
+    }
+    REPORTER_ASSERT(r, !skvm::load_jit_cache(path.c_str()));
+}
+
 DEF_TEST(SkVM_LoopCounts, r) {
     // Make sure we cover all the exact N we want.
 
@@ -1505,6 +1570,99 @@ DEF_TEST(SkVM_Assembler, r) {
         0x48, 0x89, 0xc8,
     });
 
+    // AVX-512 instructions are EVEX encoded.  Note the scaled 8-bit displacements.
+    test_asm(r, [&](A& a) {
+        a.vpaddd(A::zmm1 , A::zmm2 , A::zmm3 );                 // vpaddd %zmm3, %zmm2, %zmm1
+        a.vpaddd(A::zmm9 , A::zmm12, A::zmm15);
+        a.vpaddd(A::zmm17, A::zmm20, A::zmm31);
+        a.vpaddd(A::zmm1 , A::zmm2 , A::Mem{A::rsp,128});       // vpaddd 128(%rsp), ...
+        a.vpaddd(A::zmm1 , A::zmm2 , A::Mem{A::rsp,  4});       // 4 isn't a multiple of 64.
+        a.vpaddd(A::zmm1 , A::zmm2 , A::Mem{A::r9});
+
+        a.vfmadd132ps(A::zmm1, A::zmm2, A::zmm3);
+        a.vpternlogd (A::zmm1, A::zmm2, A::zmm3, 0xca);
+        a.vrndscaleps(A::zmm1, A::zmm2, A::CEIL);
+        a.vpsrld     (A::zmm9, A::zmm12, 7);
+    },{
+        0x62,0xf1,0x6d,0x48, 0xfe, 0xcb,
+        0x62,0x51,0x1d,0x48, 0xfe, 0xcf,
+        0x62,0x81,0x5d,0x40, 0xfe, 0xcf,
+        0x62,0xf1,0x6d,0x48, 0xfe, 0x4c,0x24,0x02,
+        0x62,0xf1,0x6d,0x48, 0xfe, 0x8c,0x24,0x04,0x00,0x00,0x00,
+        0x62,0xd1,0x6d,0x48, 0xfe, 0x09,
+
+        0x62,0xf2,0x6d,0x48, 0x98, 0xcb,
+        0x62,0xf3,0x6d,0x48, 0x25, 0xcb, 0xca,
+        0x62,0xf3,0x7d,0x48, 0x08, 0xca, 0x02,
+        0x62,0xd1,0x35,0x48, 0x72, 0xd4, 0x07,
+    });
+
+    test_asm(r, [&](A& a) {
+        a.vpcmpgtd (A::k2, A::zmm2 , A::Mem{A::rsp,64});
+        a.vcmpneqps(A::k2, A::zmm12, A::zmm13);
+        a.vpmovm2d (A::zmm9, A::k2);
+
+        a.kmovw (A::k1, A::rax);
+        a.kmovw (A::k1, A::r11);
+        a.kmovw (A::k2, A::k1);
+        a.kxnorw(A::k2, A::k2, A::k2);
+        a.bzhi  (A::rax, A::rax, A::rdi);
+    },{
+        0x62,0xf1,0x6d,0x48, 0x66, 0x54,0x24,0x01,
+        0x62,0xd1,0x1c,0x48, 0xc2, 0xd5, 0x04,
+        0x62,0x72,0x7e,0x48, 0x38, 0xca,
+
+        0xc5,0xf8,      0x92, 0xc8,
+        0xc4,0xc1,0x78, 0x92, 0xcb,
+        0xc5,0xf8,      0x90, 0xd1,
+        0xc5,0xec,      0x46, 0xd2,
+        0xc4,0xe2,0xc0, 0xf5, 0xc0,
+    });
+
+    test_asm(r, [&](A& a) {
+        a.vmovups(A::zmm1, A::Mem{A::rsi});
+        a.vmovups(A::zmm1, A::Mem{A::rsi}, A::k1);              // vmovups (%rsi), %zmm1 {%k1} {z}
+        a.vmovups(A::Mem{A::rsp,192}, A::zmm11);
+        a.vmovups(A::Mem{A::rsi}, A::zmm1, A::k1);              // vmovups %zmm1, (%rsi) {%k1}
+
+        a.vmovdqu8 (A::xmm1, A::Mem{A::rsi}, A::k1);
+        a.vmovdqu8 (A::Mem{A::r8}, A::xmm9, A::k1);
+        a.vmovdqu16(A::ymm1, A::Mem{A::rsi}, A::k1);
+        a.vmovdqu16(A::Mem{A::rsi}, A::ymm1, A::k1);
+
+        a.vpmovzxbd(A::zmm1, A::Mem{A::rsi});
+        a.vpmovzxbd(A::zmm1, A::xmm2);
+        a.vpmovdb  (A::Mem{A::rsi}, A::zmm1);
+        a.vpmovdb  (A::xmm9, A::zmm1);
+
+        a.vbroadcastss(A::zmm1, A::Mem{A::rsi,8});              // Scaled by 4, not 64.
+        a.vpbroadcastd(A::zmm9, A::r9);
+
+        a.vgatherdps(A::zmm1, A::FOUR, A::zmm2 , A::rax, A::k2);
+        a.vgatherdps(A::zmm9, A::FOUR, A::zmm12, A::r11, A::k2);
+    },{
+        0x62,0xf1,0x7c,0x48, 0x10, 0x0e,
+        0x62,0xf1,0x7c,0xc9, 0x10, 0x0e,
+        0x62,0x71,0x7c,0x48, 0x11, 0x5c,0x24,0x03,
+        0x62,0xf1,0x7c,0x49, 0x11, 0x0e,
+
+        0x62,0xf1,0x7f,0x89, 0x6f, 0x0e,
+        0x62,0x51,0x7f,0x09, 0x7f, 0x08,
+        0x62,0xf1,0xff,0xa9, 0x6f, 0x0e,
+        0x62,0xf1,0xff,0x29, 0x7f, 0x0e,
+
+        0x62,0xf2,0x7d,0x48, 0x31, 0x0e,
+        0x62,0xf2,0x7d,0x48, 0x31, 0xca,
+        0x62,0xf2,0x7e,0x48, 0x31, 0x0e,
+        0x62,0xd2,0x7e,0x48, 0x31, 0xc9,
+
+        0x62,0xf2,0x7d,0x48, 0x18, 0x4e,0x02,
+        0x62,0x52,0x7d,0x48, 0x7c, 0xc9,
+
+        0x62,0xf2,0x7d,0x4a, 0x92, 0x0c,0x90,
+        0x62,0x12,0x7d,0x4a, 0x92, 0x0c,0xa3,
+    });
+
     // echo "fmul v4.4s, v3.4s, v1.4s" | llvm-mc -show-encoding -arch arm64
 
     test_asm(r, [&](A& a) {
@@ -2418,6 +2576,93 @@ DEF_TEST(SkVM_features, r) {
     }
 }
 
+DEF_TEST(SkVM_avx512, r) {
+    // On machines with AVX-512 most programs JIT to 16-lane code that finishes each span
+    // with a single masked trip through the loop.  Run nearly every op over spans of every
+    // length around that to check that it agrees exactly with both AVX2 and the interpreter,
+    // including leaving everything past the end of the span untouched.
+    skvm::Features features;
+    features.fma  = true;
+    features.fp16 = true;
+    skvm::Builder b(features);
+    {
+        skvm::Ptr uniforms = b.uniform(),
+                  buf8     = b.varying<uint8_t>(),
+                  buf16    = b.varying<uint16_t>(),
+                  buf32    = b.varying<int>(),
+                  out      = b.varying<int>();
+
+        skvm::I32 x8  = b.load8 (buf8),
+                  x16 = b.load16(buf16),
+                  x32 = b.load32(buf32),
+                  g   = b.gather32(uniforms,0, b.bit_and(x8, b.splat(7))),
+                  u   = b.uniform32(uniforms,8);
+
+        skvm::F32 f = b.to_F32(b.sub(x32, b.index())),
+                  h = b.mul(b.to_F32(b.add(x16, u)), b.splat(0.25f));
+
+        skvm::F32 fma  = b.add(b.mul(f,h), f),
+                  fms  = b.sub(b.mul(f,h), h),
+                  fnma = b.sub(h, b.mul(f,h)),
+                  q    = b.select(b.gt(f,h), b.div(f, b.add(h, b.splat(1000.0f))),
+                                             b.sqrt(b.abs(h))),
+                  lo   = b.min(fma, fms),
+                  hi   = b.max(fnma, q);
+
+        skvm::I32 cmp = b.bit_xor(b.bit_xor(b.gte(f,h), b.neq(f,fma)),
+                                  b.bit_or (b.eq (f,h), b.bit_and(b.eq(x32,g), b.gt(x32,u)))),
+                  res = b.add(b.add(b.trunc(b.floor(lo)), b.round(b.ceil(hi))),
+                              b.mul(b.trunc(lo), b.splat(3)));
+
+        // (Keeping to values each backend narrows identically.)
+        b.store8 (buf8 , b.bit_and(b.add(res, b.bit_clear(x32, g)), b.splat(0xff)));
+        b.store16(buf16, b.to_fp16(b.max(b.from_fp16(x16), b.to_F32(x8))));
+        b.store32(buf32, b.bit_xor(cmp, b.sra(res, 2)));
+        b.store32(out  , b.sub(b.shl(res, 3), b.shr(x32, 1)));
+    }
+
+    const bool allowed = gSkVMAllowAVX512;
+    gSkVMAllowAVX512 = false;
+    const skvm::Program avx2 = b.done();
+    gSkVMAllowAVX512 = true;
+    const skvm::Program avx512 = b.done();
+    gSkVMAllowAVX512 = allowed;
+    const skvm::Program interpreter = b.done(/*debug_name=*/nullptr, /*allow_jit=*/false);
+
+    const int table[] = {12,34,56,78, 90,98,76,54};
+    struct {
+        const int* table;
+        int        u;
+    } uniforms{table, 3};
+
+    constexpr int kMax = 50;
+    struct Bufs {
+        uint8_t  buf8 [kMax+1];
+        uint16_t buf16[kMax+1];
+        int      buf32[kMax+1];
+        int      out  [kMax+1];
+    };
+    for (int n = 0; n <= kMax; n++) {
+        auto run = [&](const skvm::Program& program) {
+            Bufs bufs;
+            memset(&bufs, 0, sizeof(bufs));
+            for (int i = 0; i <= kMax; i++) {
+                bufs.buf8 [i] = i*7;
+                bufs.buf16[i] = i*131;
+                bufs.buf32[i] = i*37 - 500;
+                bufs.out  [i] = 0x5555'5555;
+            }
+            program.eval(n, &uniforms, bufs.buf8, bufs.buf16, bufs.buf32, bufs.out);
+            return bufs;
+        };
+        const Bufs want = run(interpreter),
+                   got2 = run(avx2),
+                   got5 = run(avx512);
+        REPORTER_ASSERT(r, 0 == memcmp(&want, &got2, sizeof(Bufs)), "AVX2, n=%d", n);
+        REPORTER_ASSERT(r, 0 == memcmp(&want, &got5, sizeof(Bufs)), "AVX-512, n=%d", n);
+    }
+}
+
 DEF_TEST(SkVM_gather_can_hoist, r) {
     // A gather instruction isn't necessarily varying... it's whatever its index is.
     // First a typical gather scenario with varying index.
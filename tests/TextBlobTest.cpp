@@ -10,7 +10,9 @@
 #include "include/core/SkSerialProcs.h"
 #include "include/core/SkTypeface.h"
 #include "include/private/SkTo.h"
+#include "src/core/SkStrikeCache.h"
 #include "src/core/SkTextBlobPriv.h"
+#include "src/core/SkTextBlobRasterCache.h"
 
 #include "tests/Test.h"
 #include "tools/ToolUtils.h"
@@ -509,3 +511,70 @@ DEF_TEST(TextBlob_getIntercepts, reporter) {
     // raised 'y' should not intersect
     REPORTER_ASSERT(reporter, blobHighY->getIntercepts(bounds, nullptr) == 0);
 }
+
+static sk_sp<SkImage> render_at(const SkTextBlob* blob, SkScalar x, SkScalar y) {
+    auto surf = SkSurface::MakeRasterN32Premul(128, 64);
+    surf->getCanvas()->clear(SK_ColorWHITE);
+    surf->getCanvas()->drawTextBlob(blob, x, y, SkPaint());
+    return surf->makeImageSnapshot();
+}
+
+DEF_TEST(TextBlob_rasterCache, reporter) {
+    SkTextBlobBuilder builder;
+    add_run(&builder, "Hello", 0, 0, ToolUtils::create_portable_typeface());
+    add_run(&builder, "World", 0, 20, ToolUtils::create_portable_typeface());
+    sk_sp<SkTextBlob> blob = builder.make();
+
+    // Drawing again, and drawing moved by whole pixels, uses the glyphs cached by the first
+    // draw. The results must match drawing with nothing cached.
+    for (SkPoint offset : {SkPoint{0, 0}, SkPoint{3, 7}, SkPoint{-2, 5}, SkPoint{0.5f, 0}}) {
+        SkScalar x = 10.25f + offset.x(),
+                 y = 20     + offset.y();
+        SkTextBlobRasterCache::GlobalCache()->purgeAll();
+        render_at(blob.get(), 10.25f, 20);
+        sk_sp<SkImage> cached = render_at(blob.get(), x, y);
+        SkTextBlobRasterCache::GlobalCache()->purgeAll();
+        sk_sp<SkImage> expected = render_at(blob.get(), x, y);
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expected.get(), cached.get()),
+                        "offset %g %g", offset.x(), offset.y());
+    }
+
+    // Entries go away when the strike cache purges their strikes.
+    SkTextBlobRasterCache::GlobalCache()->purgeAll();
+    render_at(blob.get(), 10.25f, 20);
+    REPORTER_ASSERT(reporter, SkTextBlobRasterCache::GlobalCache()->getEntryCount() == 1);
+    SkStrikeCache::PurgeAll();
+    REPORTER_ASSERT(reporter, SkTextBlobRasterCache::GlobalCache()->getEntryCount() == 0);
+
+    // Without sub-pixel positions, fractional moves still use the cached glyphs.
+    {
+        SkFont font(ToolUtils::create_portable_typeface(), 16);
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        font.setSubpixel(false);
+        sk_sp<SkTextBlob> pixelBlob = SkTextBlob::MakeFromString("Hello", font);
+
+        SkTextBlobRasterCache::GlobalCache()->purgeAll();
+        render_at(pixelBlob.get(), 10.25f, 20);
+        sk_sp<SkImage> cached = render_at(pixelBlob.get(), 13.75f, 20.5f);
+        REPORTER_ASSERT(reporter,
+                        SkTextBlobRasterCache::GlobalCache()->getEntryCount() == 1);
+        SkTextBlobRasterCache::GlobalCache()->purgeAll();
+        sk_sp<SkImage> expected = render_at(pixelBlob.get(), 13.75f, 20.5f);
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expected.get(), cached.get()));
+    }
+
+    // Entries go away with their blob.
+    SkTextBlobRasterCache cache;
+    SkTextBlobRasterCache::Key key;
+    memset(&key, 0, sizeof(key));
+    key.fBlobID = blob->uniqueID();
+    auto entry = sk_make_sp<SkTextBlobRasterCache::Entry>(key);
+    entry->fGlyphCount = 10;
+    cache.add(std::move(entry), *blob);
+    REPORTER_ASSERT(reporter, cache.find(key));
+    REPORTER_ASSERT(reporter, cache.getEntryCount() == 1);
+    REPORTER_ASSERT(reporter, cache.getGlyphCount() == 10);
+    blob = nullptr;
+    REPORTER_ASSERT(reporter, cache.getEntryCount() == 0);
+    REPORTER_ASSERT(reporter, cache.getGlyphCount() == 0);
+}
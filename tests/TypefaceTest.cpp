@@ -6,7 +6,10 @@
  */
 
 #include "include/core/SkData.h"
+#include "include/core/SkFont.h"
 #include "include/core/SkFontMgr.h"
+#include "include/core/SkGraphics.h"
+#include "include/core/SkPath.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkTypeface.h"
@@ -26,6 +29,8 @@
 #include "tools/fonts/TestEmptyTypeface.h"
 
 #include <memory>
+#include <thread>
+#include <vector>
 
 static void TypefaceStyle_test(skiatest::Reporter* reporter,
                                uint16_t weight, uint16_t width, SkData* data)
@@ -601,3 +606,75 @@ DEF_TEST(LegacyMakeTypeface, reporter) {
     REPORTER_ASSERT(reporter, typeface3->isItalic());
     REPORTER_ASSERT(reporter, typeface3->isBold());
 }
+
+// Many threads loading glyphs from several typefaces at once, with more threads than typefaces
+// so that each face is also contended. Every thread must see the same outlines and advances as
+// a single thread would.
+DEF_TEST(Typeface_threaded_glyphs, reporter) {
+    constexpr int kTypefaces = 4,
+                  kThreads   = 2 * kTypefaces;
+    constexpr const char* kResources[] = {
+        "fonts/Distortable.ttf", "fonts/Em.ttf", "fonts/Roboto-Regular.ttf", "fonts/Variable.ttf",
+    };
+    static_assert(SK_ARRAY_COUNT(kResources) == kTypefaces, "");
+
+    sk_sp<SkTypeface> typefaces[kTypefaces];
+    for (int i = 0; i < kTypefaces; i++) {
+        typefaces[i] = MakeResourceAsTypeface(kResources[i]);
+        if (!typefaces[i]) {
+            return;  // This font manager can't load fonts from data.
+        }
+    }
+
+    static constexpr char kText[] = "Hamburgefonstiv";
+    constexpr int kGlyphs = sizeof(kText) - 1;
+    auto glyphs_for = [](const SkFont& font, SkGlyphID glyphs[kGlyphs]) {
+        font.textToGlyphs(kText, kGlyphs, SkTextEncoding::kUTF8, glyphs, kGlyphs);
+    };
+
+    // Reference outlines and advances, computed on this thread.
+    SkPath   refPaths [kTypefaces][kGlyphs];
+    SkScalar refWidths[kTypefaces][kGlyphs];
+    for (int i = 0; i < kTypefaces; i++) {
+        SkFont font(typefaces[i], 24);
+        SkGlyphID glyphs[kGlyphs];
+        glyphs_for(font, glyphs);
+        font.getWidths(glyphs, kGlyphs, refWidths[i]);
+        for (int g = 0; g < kGlyphs; g++) {
+            font.getPath(glyphs[g], &refPaths[i][g]);
+        }
+    }
+    SkGraphics::PurgeFontCache();
+
+    bool mismatch[kThreads] = {};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&, t] {
+            const int i = t % kTypefaces;
+            for (int iter = 0; iter < 20; iter++) {
+                // Vary the size too, so each thread keeps making new scaler contexts on the face.
+                SkFont sized(typefaces[i], 8 + (iter + t) % 16);
+                SkGlyphID glyphs[kGlyphs];
+                glyphs_for(sized, glyphs);
+                SkPath path;
+                for (int g = 0; g < kGlyphs; g++) {
+                    sized.getPath(glyphs[g], &path);
+                }
+
+                SkFont font(typefaces[i], 24);
+                SkScalar widths[kGlyphs];
+                font.getWidths(glyphs, kGlyphs, widths);
+                for (int g = 0; g < kGlyphs; g++) {
+                    font.getPath(glyphs[g], &path);
+                    mismatch[t] |= widths[g] != refWidths[i][g] || path != refPaths[i][g];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int t = 0; t < kThreads; t++) {
+        REPORTER_ASSERT(reporter, !mismatch[t], "thread %d", t);
+    }
+}